@@ -8,10 +8,290 @@
 // Standard C
 #include <string.h>
 
+#if defined( __SSE2__ )
+	#include <emmintrin.h>
+	#define CONFIG_FIND_SSE2  1
+	
+	#if defined( __x86_64__ )  &&  (defined( __clang__ )  ||  __GNUC__ >= 5)
+		#include <immintrin.h>
+		#define CONFIG_FIND_AVX2  1
+	#endif
+#elif defined( __aarch64__ )  &&  defined( __ARM_NEON )
+	#include <arm_neon.h>
+	#define CONFIG_FIND_NEON  1
+#endif
+
+#ifndef CONFIG_FIND_SSE2
+#define CONFIG_FIND_SSE2  0
+#endif
+
+#ifndef CONFIG_FIND_AVX2
+#define CONFIG_FIND_AVX2  0
+#endif
+
+#ifndef CONFIG_FIND_NEON
+#define CONFIG_FIND_NEON  0
+#endif
+
+#define CONFIG_FIND_VECTOR  (CONFIG_FIND_SSE2 || CONFIG_FIND_NEON)
+
 
 namespace gear
 {
 	
+#if CONFIG_FIND_VECTOR
+	
+	/*
+		Vector kernels for find_first_match() and find_first_nonmatch().
+		
+		A set of n chars is matched by comparing a block of input against
+		each char broadcast across a vector and OR'ing the results, so only
+		small sets are worth it.  Each kernel needs at least one block of
+		input; after the last whole block it rescans the final block-sized
+		run of input (overlapping bytes already known not to match) instead
+		of finishing with a scalar loop.
+		
+		The kernels are instantiated for sets of one, two (e.g. CR and LF),
+		and three chars, with 0 meaning any size up to max_vector_set.
+		
+		SSE2 and NEON are always present on x86-64 and AArch64, and AVX2 is
+		used when the CPU (and OS) support it.
+	*/
+	
+	const int max_vector_set = 16;
+	
+	const int vector_size = 16;
+	
+	static inline int set_size( int N, const unsigned char* chars )
+	{
+		return N ? N : chars[ 0 ];
+	}
+	
+#endif
+	
+#if CONFIG_FIND_SSE2
+	
+	template < int N >
+	static const char* find_first_sse2( const char*           p,
+	                                     const char*           end,
+	                                     const unsigned char*  chars,
+	                                     bool                  negated )
+	{
+		const int n = set_size( N, chars );
+		
+		__m128i set[ N ? N : max_vector_set ];
+		
+		for ( int i = 0;  i < n;  ++i )
+		{
+			set[ i ] = _mm_set1_epi8( chars[ 1 + i ] );
+		}
+		
+		const unsigned flip = negated ? 0xFFFF : 0;
+		
+		const char* last = end - 16;
+		
+		while ( true )
+		{
+			if ( p > last )
+			{
+				p = last;
+			}
+			
+			const __m128i v = _mm_loadu_si128( (const __m128i*) p );
+			
+			__m128i m = _mm_cmpeq_epi8( v, set[ 0 ] );
+			
+			for ( int i = 1;  i < n;  ++i )
+			{
+				m = _mm_or_si128( m, _mm_cmpeq_epi8( v, set[ i ] ) );
+			}
+			
+			if ( const unsigned bits = _mm_movemask_epi8( m ) ^ flip )
+			{
+				return p + __builtin_ctz( bits );
+			}
+			
+			if ( p == last )
+			{
+				return NULL;
+			}
+			
+			p += 16;
+		}
+	}
+	
+#endif
+	
+#if CONFIG_FIND_AVX2
+	
+	static bool cpu_has_avx2()
+	{
+		__builtin_cpu_init();
+		
+		return __builtin_cpu_supports( "avx2" );
+	}
+	
+	static const bool has_avx2 = cpu_has_avx2();
+	
+	template < int N >
+	__attribute__(( target( "avx2" ) ))
+	static const char* find_first_avx2( const char*           p,
+	                                     const char*           end,
+	                                     const unsigned char*  chars,
+	                                     bool                  negated )
+	{
+		const int n = set_size( N, chars );
+		
+		__m256i set[ N ? N : max_vector_set ];
+		
+		for ( int i = 0;  i < n;  ++i )
+		{
+			set[ i ] = _mm256_set1_epi8( chars[ 1 + i ] );
+		}
+		
+		const unsigned flip = negated ? 0xFFFFFFFF : 0;
+		
+		const char* last = end - 32;
+		
+		while ( true )
+		{
+			if ( p > last )
+			{
+				p = last;
+			}
+			
+			const __m256i v = _mm256_loadu_si256( (const __m256i*) p );
+			
+			__m256i m = _mm256_cmpeq_epi8( v, set[ 0 ] );
+			
+			for ( int i = 1;  i < n;  ++i )
+			{
+				m = _mm256_or_si256( m, _mm256_cmpeq_epi8( v, set[ i ] ) );
+			}
+			
+			if ( const unsigned bits = unsigned( _mm256_movemask_epi8( m ) ) ^ flip )
+			{
+				return p + __builtin_ctz( bits );
+			}
+			
+			if ( p == last )
+			{
+				return NULL;
+			}
+			
+			p += 32;
+		}
+	}
+	
+#endif
+	
+#if CONFIG_FIND_NEON
+	
+	template < int N >
+	static const char* find_first_neon( const char*           p,
+	                                    const char*           end,
+	                                    const unsigned char*  chars,
+	                                    bool                  negated )
+	{
+		const int n = set_size( N, chars );
+		
+		uint8x16_t set[ N ? N : max_vector_set ];
+		
+		for ( int i = 0;  i < n;  ++i )
+		{
+			set[ i ] = vdupq_n_u8( chars[ 1 + i ] );
+		}
+		
+		const char* last = end - 16;
+		
+		while ( true )
+		{
+			if ( p > last )
+			{
+				p = last;
+			}
+			
+			const uint8x16_t v = vld1q_u8( (const uint8_t*) p );
+			
+			uint8x16_t m = vceqq_u8( v, set[ 0 ] );
+			
+			for ( int i = 1;  i < n;  ++i )
+			{
+				m = vorrq_u8( m, vceqq_u8( v, set[ i ] ) );
+			}
+			
+			if ( negated )
+			{
+				m = vmvnq_u8( m );
+			}
+			
+			// Narrow each byte of the mask to a nibble.
+			
+			const uint8x8_t nibbles = vshrn_n_u16( vreinterpretq_u16_u8( m ), 4 );
+			
+			if ( const uint64_t bits = vget_lane_u64( vreinterpret_u64_u8( nibbles ), 0 ) )
+			{
+				return p + (__builtin_ctzll( bits ) >> 2);
+			}
+			
+			if ( p == last )
+			{
+				return NULL;
+			}
+			
+			p += 16;
+		}
+	}
+	
+#endif
+	
+#if CONFIG_FIND_VECTOR
+	
+	#define FIND_FIRST_BY_SET_SIZE( kernel )  \
+		switch ( chars[ 0 ] )  \
+		{  \
+			case 1:   return kernel< 1 >( p, end, chars, negated );  \
+			case 2:   return kernel< 2 >( p, end, chars, negated );  \
+			case 3:   return kernel< 3 >( p, end, chars, negated );  \
+			default:  return kernel< 0 >( p, end, chars, negated );  \
+		}
+	
+	static inline bool vector_eligible( const char*           p,
+	                                    const char*           end,
+	                                    const unsigned char*  chars )
+	{
+		return end - p >= vector_size  &&  chars[ 0 ] - 1u < max_vector_set;
+	}
+	
+	static const char* vector_find_first( const char*           p,
+	                                      const char*           end,
+	                                      const unsigned char*  chars,
+	                                      bool                  negated )
+	{
+	#if CONFIG_FIND_AVX2
+	
+		if ( has_avx2  &&  end - p >= 32 )
+		{
+			FIND_FIRST_BY_SET_SIZE( find_first_avx2 )
+		}
+	
+	#endif
+	
+	#if CONFIG_FIND_SSE2
+	
+		FIND_FIRST_BY_SET_SIZE( find_first_sse2 )
+	
+	#else
+	
+		FIND_FIRST_BY_SET_SIZE( find_first_neon )
+	
+	#endif
+	}
+	
+	#undef FIND_FIRST_BY_SET_SIZE
+	
+#endif
+	
 	static inline bool char_matches( char a, char b )
 	{
 		return a == b;
@@ -23,6 +303,19 @@ namespace gear
 	                              const char*  _default,
 	                              bool         negated )
 	{
+	#if CONFIG_FIND_VECTOR
+	
+		const unsigned char chars[] = { 1, (unsigned char) c };
+		
+		if ( vector_eligible( p, end, chars ) )
+		{
+			const char* match = vector_find_first( p, end, chars, negated );
+			
+			return match ? match : _default;
+		}
+	
+	#endif
+	
 		for ( ;  p != end;  ++p )
 		{
 			if ( char_matches( *p, c ) - negated )
@@ -75,6 +368,17 @@ namespace gear
 	                              const char*           _default,
 	                              bool                  negated )
 	{
+	#if CONFIG_FIND_VECTOR
+	
+		if ( vector_eligible( p, end, chars ) )
+		{
+			const char* match = vector_find_first( p, end, chars, negated );
+			
+			return match ? match : _default;
+		}
+	
+	#endif
+	
 		for ( ;  p != end;  ++p )
 		{
 			if ( char_matches( *p, chars ) - negated )
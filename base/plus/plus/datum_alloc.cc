@@ -5,33 +5,215 @@
 
 #include "plus/datum_alloc.hh"
 
+// Standard C++
+#include <new>
+
 // Standard C
 #include <stdlib.h>
 #include <string.h>
 
+#if defined( __unix__ )  ||  defined( __MACH__ )
+// POSIX
+#include <pthread.h>
+#endif
+
 // debug
 #include "debug/assert.hh"
 
 // plus
 #include "plus/datum_access.hh"
+#include "plus/ref_count_ops.hh"
 
 
 namespace plus
 {
-	
+
+#if (defined( __clang__ )  ||  (defined( __GNUC__ )  &&  !defined( __APPLE__ )))  \
+	&&  (defined( __unix__ )  ||  defined( __MACH__ ))
+	#define THREAD_LOCAL  __thread
+	#define CONFIG_DATUM_FREE_LISTS  1
+	#define CONFIG_DATUM_THREAD_EXIT_HOOK  1
+#elif defined( __GNUC__ )
 	/*
-		These can be changed to use malloc() and free() when we're ready to
-		take advantage of realloc().
+		Apple's GCC has no thread-local storage, and elsewhere there may
+		be no pthreads to free a thread's lists when it exits, so don't
+		keep free lists.
 	*/
+	#define THREAD_LOCAL  /**/
+	#define CONFIG_DATUM_FREE_LISTS  0
+#else
+	// Classic Mac OS threads are cooperative.
+	#define THREAD_LOCAL  /**/
+	#define CONFIG_DATUM_FREE_LISTS  1
+#endif
+
+	/*
+		Allocated strings live in blocks from malloc(), so that they can be
+		resized with realloc().  Blocks of up to max_class_size bytes are
+		rounded up to a power of two (a size class), and freed blocks are
+		kept on a per-thread free list for their class, so the common short
+		strings rarely reach malloc() at all.  Each list is capped, and a
+		pthread key's destructor returns a thread's lists to free() when
+		the thread exits.
+	*/
+	
+	const unsigned long min_class_size = 32;
+	const unsigned long max_class_size = 4096;
+	
+	const int n_size_classes = 8;  // 32, 64, ..., 4096
+	
+	const int max_free_blocks = 16;
+	
+	struct free_block
+	{
+		free_block* next;
+	};
+	
+	struct free_list
+	{
+		free_block*  head;
+		int          count;
+	};
+	
+	static THREAD_LOCAL free_list global_free_lists[ n_size_classes ];
+
+#ifndef CONFIG_DATUM_THREAD_EXIT_HOOK
+
+	static inline void hook_thread_exit()
+	{
+	}
+
+#else
+
+	static pthread_key_t   free_lists_key;
+	static pthread_once_t  free_lists_once = PTHREAD_ONCE_INIT;
+	
+	static THREAD_LOCAL bool free_lists_hooked;
+	
+	static void release_free_lists( void* lists )
+	{
+		free_list* list = (free_list*) lists;
+		
+		for ( int i = 0;  i < n_size_classes;  ++i )
+		{
+			while ( free_block* block = list[ i ].head )
+			{
+				list[ i ].head = block->next;
+				
+				free( block );
+			}
+			
+			list[ i ].count = 0;
+		}
+		
+		// Another key's destructor may free more strings; if so, hook again.
+		
+		free_lists_hooked = false;
+	}
+	
+	static void create_free_lists_key()
+	{
+		pthread_key_create( &free_lists_key, &release_free_lists );
+	}
+	
+	static void hook_thread_exit()
+	{
+		if ( ! free_lists_hooked )
+		{
+			pthread_once( &free_lists_once, &create_free_lists_key );
+			
+			pthread_setspecific( free_lists_key, global_free_lists );
+			
+			free_lists_hooked = true;
+		}
+	}
+
+#endif
+
+	static THREAD_LOCAL datum_alloc_stats global_stats;
+	
+	const datum_alloc_stats& get_datum_alloc_stats()
+	{
+		return global_stats;
+	}
 	
 	char* datum_alloc( unsigned long size )
 	{
-		return (char*) ::operator new( size );
+		++global_stats.allocations;
+		
+		void* mem = malloc( size );
+		
+		if ( mem == NULL )
+		{
+			throw std::bad_alloc();
+		}
+		
+		return (char*) mem;
 	}
 	
 	void datum_free( char* mem )
 	{
-		::operator delete( mem );
+		free( mem );
+	}
+	
+	static inline int size_class( unsigned long size )
+	{
+		ASSERT( size <= max_class_size );
+		
+		int i = 0;
+		
+		for ( unsigned long n = min_class_size;  n < size;  n <<= 1 )
+		{
+			++i;
+		}
+		
+		return i;
+	}
+	
+	static char* alloc_block( unsigned long size )
+	{
+		if ( CONFIG_DATUM_FREE_LISTS  &&  size <= max_class_size )
+		{
+			free_list& list = global_free_lists[ size_class( size ) ];
+			
+			if ( free_block* block = list.head )
+			{
+				list.head = block->next;
+				
+				--list.count;
+				
+				++global_stats.recycled;
+				
+				return (char*) block;
+			}
+		}
+		
+		return datum_alloc( size );
+	}
+	
+	static void free_block_of_size( void* mem, unsigned long size )
+	{
+		if ( CONFIG_DATUM_FREE_LISTS  &&  size <= max_class_size )
+		{
+			free_list& list = global_free_lists[ size_class( size ) ];
+			
+			if ( list.count < max_free_blocks )
+			{
+				hook_thread_exit();
+				
+				free_block* block = (free_block*) mem;
+				
+				block->next = list.head;
+				
+				list.head = block;
+				
+				++list.count;
+				
+				return;
+			}
+		}
+		
+		datum_free( (char*) mem );
 	}
 	
 	
@@ -64,7 +246,8 @@ namespace plus
 	
 	struct datum_alloc_header
 	{
-		size_t refcount;
+		ref_count_t    refcount;
+		unsigned long  size;  // of the whole block, including the header
 	};
 	
 	static inline unsigned long adjusted_capacity( unsigned long capacity )
@@ -74,6 +257,30 @@ namespace plus
 		return capacity | (1 << n_missing_bits_of_precision) - 1;
 	}
 	
+	static inline unsigned long block_size( unsigned long capacity )
+	{
+		const unsigned long size = sizeof (datum_alloc_header) + capacity + 1;
+		
+		if ( size > max_class_size )
+		{
+			return size;
+		}
+		
+		unsigned long class_size = min_class_size;
+		
+		while ( class_size < size )
+		{
+			class_size <<= 1;
+		}
+		
+		return class_size;
+	}
+	
+	static inline unsigned long block_capacity( unsigned long size )
+	{
+		return size - sizeof (datum_alloc_header) - 1;
+	}
+	
 	char* allocate( datum_storage& datum, long length, long capacity )
 	{
 		ASSERT( length   >= 0      );
@@ -83,14 +290,15 @@ namespace plus
 		
 		if ( capacity >= datum_buffer_size )
 		{
-			capacity = adjusted_capacity( capacity );
+			const unsigned long size = block_size( adjusted_capacity( capacity ) );
 			
-			const size_t buffer_length = sizeof (datum_alloc_header) + capacity + 1;
+			capacity = block_capacity( size );
 			
 			// may throw
-			datum_alloc_header* header = (datum_alloc_header*) ::operator new( buffer_length );
+			datum_alloc_header* header = (datum_alloc_header*) alloc_block( size );
 			
 			header->refcount = 1;
+			header->size     = size;
 			
 			new_pointer = reinterpret_cast< char* >( header + 1 );
 			
@@ -129,7 +337,7 @@ namespace plus
 			{
 				datum_alloc_header* header = (datum_alloc_header*) y.alloc.pointer - 1;
 				
-				++header->refcount;
+				add_ref( header->refcount );
 			}
 			
 			x = y;
@@ -162,16 +370,16 @@ namespace plus
 				
 				datum_alloc_header* header = (datum_alloc_header*) pointer - 1;
 				
-				if ( --header->refcount > 0 )
+				if ( release_ref( header->refcount ) > 0 )
 				{
 					break;
 				}
 				
-				pointer = (char*) header;
+				free_block_of_size( header, header->size );
+				
+				break;
 			}
 			
-			// fall through
-			
 			case ~delete_basic:
 				::operator delete( (void*) pointer );
 				break;
@@ -201,8 +409,94 @@ namespace plus
 		return new_pointer;
 	}
 	
+	static bool is_sole_allocation( const datum_storage& datum )
+	{
+		// Substrings have a capacity of zero or less.
+		
+		if ( datum.alloc.capacity <= 0 )
+		{
+			return false;
+		}
+		
+		switch ( margin( datum ) )
+		{
+			case ~delete_shared:
+			{
+				datum_alloc_header* header = (datum_alloc_header*) datum.alloc.pointer - 1;
+				
+				return load_ref( header->refcount ) == 1;
+			}
+			
+			case ~delete_owned:
+				return true;
+			
+			default:
+				return false;
+		}
+	}
+	
+	static char* resize_allocation( datum_storage& datum, long new_capacity )
+	{
+		datum_alloc_header* header = (datum_alloc_header*) datum.alloc.pointer - 1;
+		
+		const unsigned long old_size = header->size;
+		const unsigned long new_size = block_size( adjusted_capacity( new_capacity ) );
+		
+		if ( new_size != old_size )
+		{
+			const long n = datum.alloc.length;
+			
+			if ( old_size > max_class_size  &&  new_size > max_class_size )
+			{
+				// realloc() can often grow (or shrink) the block in place.
+				
+				void* mem = realloc( header, new_size );
+				
+				if ( mem == NULL )
+				{
+					throw std::bad_alloc();
+				}
+				
+				++global_stats.reallocations;
+				
+				header = (datum_alloc_header*) mem;
+			}
+			else
+			{
+				datum_alloc_header* old_header = header;
+				
+				header = (datum_alloc_header*) alloc_block( new_size );
+				
+				memcpy( header, old_header, sizeof (datum_alloc_header) + n );
+				
+				++global_stats.copies;
+				
+				global_stats.bytes_copied += n;
+				
+				free_block_of_size( old_header, old_size );
+			}
+			
+			header->size = new_size;
+			
+			datum.alloc.pointer = reinterpret_cast< char* >( header + 1 );
+		}
+		
+		datum.alloc.capacity = block_capacity( new_size );
+		
+		char* p = const_cast< char* >( datum.alloc.pointer );
+		
+		p[ datum.alloc.length ] = '\0';
+		
+		return p;
+	}
+	
 	char* extend_capacity( datum_storage& datum, long new_capacity )
 	{
+		if ( new_capacity >= datum_buffer_size  &&  is_sole_allocation( datum ) )
+		{
+			return resize_allocation( datum, new_capacity );
+		}
+		
 		datum_storage old = datum;
 		
 		const long n = size( old );
@@ -213,6 +507,10 @@ namespace plus
 		
 		memcpy( q, p, n );
 		
+		++global_stats.copies;
+		
+		global_stats.bytes_copied += n;
+		
 		destroy( old );
 		
 		return q;
@@ -266,9 +564,11 @@ namespace plus
 		{
 			datum_alloc_header* header = (datum_alloc_header*) datum.alloc.pointer - 1;
 			
-			ASSERT( header->refcount != 0 );
+			const ref_count_t refcount = load_ref( header->refcount );
 			
-			if ( header->refcount == 1 )
+			ASSERT( refcount != 0 );
+			
+			if ( refcount == 1 )
 			{
 				p = const_cast< char* >( datum.alloc.pointer + alloc_substr_offset( datum ) );
 				
@@ -286,9 +586,9 @@ namespace plus
 		}
 		
 		p = extend_capacity( datum, datum.alloc.length );
-		
+	
 	single:
-		
+	
 		if ( tainting )
 		{
 			datum.small[ datum_max_offset ] = ~delete_owned;
@@ -296,6 +596,6 @@ namespace plus
 		
 		return p;
 	}
-	
+
 }
 
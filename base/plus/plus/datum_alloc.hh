@@ -22,6 +22,19 @@ namespace plus
 		delete_free    // Calls free(), not operator delete()
 	};
 	
+	struct datum_alloc_stats
+	{
+		unsigned long  allocations;    // calls to malloc()
+		unsigned long  reallocations;  // calls to realloc()
+		unsigned long  recycled;       // blocks reused from a free list
+		unsigned long  copies;         // of a string's contents to a new block
+		unsigned long  bytes_copied;
+	};
+	
+	// Counts for the calling thread
+	
+	const datum_alloc_stats& get_datum_alloc_stats();
+	
 	char* datum_alloc( unsigned long size );
 	
 	void datum_free( char* mem );
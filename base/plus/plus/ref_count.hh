@@ -6,6 +6,9 @@
 #ifndef PLUS_REFCOUNT_HH
 #define PLUS_REFCOUNT_HH
 
+// plus
+#include "plus/ref_count_ops.hh"
+
 
 namespace plus
 {
@@ -27,7 +30,7 @@ namespace plus
 	class ref_count_base
 	{
 		private:
-			mutable unsigned long its_n;
+			mutable ref_count_t its_n;
 			
 			// Non-copyable
 			ref_count_base           ( const ref_count_base& );
@@ -39,21 +42,21 @@ namespace plus
 			{
 			}
 			
-			unsigned long release() const
+			ref_count_t release() const
 			{
-				return --its_n;
+				return release_ref( its_n );
 			}
 		
 		public:
-			friend unsigned long intrusive_ptr_ref_count( const ref_count_base* count )
+			friend ref_count_t intrusive_ptr_ref_count( const ref_count_base* count )
 			{
-				return count->its_n;
+				return load_ref( count->its_n );
 			}
 		
 		private:
 			friend void intrusive_ptr_add_ref( const ref_count_base* count )
 			{
-				++count->its_n;
+				add_ref( count->its_n );
 			}
 	};
 	
@@ -62,7 +65,7 @@ namespace plus
 	{
 		private:
 			// Hide the protected release() from view
-			unsigned long release() const
+			ref_count_t release() const
 			{
 				return ref_count_base::release();
 			}
@@ -0,0 +1,93 @@
+/*
+	ref_count_ops.hh
+	----------------
+*/
+
+#ifndef PLUS_REFCOUNTOPS_HH
+#define PLUS_REFCOUNTOPS_HH
+
+
+/*
+	Reference counts (of ref_count<> objects and shared string buffers)
+	are plain integers by default, so shared objects must stay on one
+	thread.  Define CONFIG_ATOMIC_REFCOUNT to 1 (in plus and everything
+	that uses it) to make them atomic instead, with relaxed increments and
+	acquire-release decrements.  This requires GCC 4.7 or later, or clang.
+	
+	Each policy is in its own namespace, so a translation unit built with
+	the other one (like t/atomic_ref_count.cc) doesn't clash with plus
+	over the definitions of these inline functions.
+*/
+
+#ifndef CONFIG_ATOMIC_REFCOUNT
+#define CONFIG_ATOMIC_REFCOUNT  0
+#endif
+
+
+namespace plus
+{
+	
+	typedef unsigned long ref_count_t;
+	
+#if CONFIG_ATOMIC_REFCOUNT
+	
+	namespace atomic_refs
+	{
+		
+		inline void add_ref( ref_count_t& n )
+		{
+			// A new reference can only be made from an existing one.
+			
+			__atomic_fetch_add( &n, 1, __ATOMIC_RELAXED );
+		}
+		
+		inline ref_count_t release_ref( ref_count_t& n )
+		{
+			/*
+				Release our writes to the object, and if we're the last
+				owner, acquire everyone else's before destroying it.
+			*/
+			
+			return __atomic_sub_fetch( &n, 1, __ATOMIC_ACQ_REL );
+		}
+		
+		inline ref_count_t load_ref( const ref_count_t& n )
+		{
+			// A count of 1 means we may write, so acquire prior releases.
+			
+			return __atomic_load_n( &n, __ATOMIC_ACQUIRE );
+		}
+		
+	}
+	
+	using namespace atomic_refs;
+	
+#else
+	
+	namespace plain_refs
+	{
+		
+		inline void add_ref( ref_count_t& n )
+		{
+			++n;
+		}
+		
+		inline ref_count_t release_ref( ref_count_t& n )
+		{
+			return --n;
+		}
+		
+		inline ref_count_t load_ref( const ref_count_t& n )
+		{
+			return n;
+		}
+		
+	}
+	
+	using namespace plain_refs;
+	
+#endif
+	
+}
+
+#endif
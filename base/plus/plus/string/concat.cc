@@ -5,9 +5,6 @@
 
 #include "plus/string/concat.hh"
 
-// Standard C
-#include <string.h>
-
 // more-libc
 #include "more/string.h"
 
@@ -28,20 +25,5 @@ namespace plus
 		return result;
 	}
 	
-	string operator+( const string& a, const string& b )
-	{
-		return concat( a.data(), a.size(), b.data(), b.size() );
-	}
-	
-	string operator+( const string& a, const char* b )
-	{
-		return concat( a.data(), a.size(), b, strlen( b ) );
-	}
-	
-	string operator+( const char* a, const string& b )
-	{
-		return concat( a, strlen( a ), b.data(), b.size() );
-	}
-	
 }
 
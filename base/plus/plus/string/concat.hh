@@ -6,6 +6,12 @@
 #ifndef PLUS_STRING_CONCAT_HH
 #define PLUS_STRING_CONCAT_HH
 
+// Standard C
+#include <string.h>
+
+// more-libc
+#include "more/string.h"
+
 // iota
 #include "iota/string_traits.hh"
 
@@ -15,7 +21,7 @@
 
 namespace plus
 {
-	
+
 	string concat( const char*  a, string::size_type  a_size,
 	               const char*  b, string::size_type  b_size );
 	
@@ -49,13 +55,144 @@ namespace plus
 		               iota::get_string_size( b ) );
 	}
 	
-	string operator+( const string& a, const string& b );
+	/*
+		operator+ doesn't concatenate anything itself.  It returns a
+		concatenation, which records its operands (by address and length)
+		and is converted to a string when it's assigned, returned, or passed
+		as a string argument.  So a chain like
+		
+			name + ": " + value + "\r\n"
+		
+		measures all four parts, allocates the result once, and copies each
+		part once, instead of allocating (and recopying) an intermediate
+		string for every +.
+		
+		Operands must outlive the conversion, which is always the case for a
+		concatenation that doesn't outlive its full-expression.
+	*/
+	
+	class concat_part
+	{
+		private:
+			const char*        its_data;
+			string::size_type  its_size;
+		
+		public:
+			concat_part( const string& s ) : its_data( s.data() ),
+			                                 its_size( s.size() )
+			{
+			}
+			
+			concat_part( const char* s ) : its_data( s ),
+			                               its_size( strlen( s ) )
+			{
+			}
+			
+			string::size_type size() const  { return its_size; }
+			
+			char* copy( char* p ) const
+			{
+				return (char*) mempcpy( p, its_data, its_size );
+			}
+	};
+	
+	template < class Left, class Right >
+	class concatenation
+	{
+		private:
+			Left   its_left;
+			Right  its_right;
+		
+		public:
+			concatenation( const Left& left, const Right& right )
+			:
+				its_left ( left  ),
+				its_right( right )
+			{
+			}
+			
+			string::size_type size() const
+			{
+				return its_left.size() + its_right.size();
+			}
+			
+			char* copy( char* p ) const
+			{
+				return its_right.copy( its_left.copy( p ) );
+			}
+			
+			string str() const
+			{
+				string result;
+				
+				copy( result.reset( size() ) );
+				
+				return result;
+			}
+			
+			operator string() const  { return str(); }
+	};
+	
+	typedef concatenation< concat_part, concat_part > concat_pair;
+	
+	inline concat_pair operator+( const string& a, const string& b )
+	{
+		return concat_pair( a, b );
+	}
+	
+	inline concat_pair operator+( const string& a, const char* b )
+	{
+		return concat_pair( a, b );
+	}
+	
+	inline concat_pair operator+( const char* a, const string& b )
+	{
+		return concat_pair( a, b );
+	}
+	
+	template < class L, class R >
+	inline concatenation< concatenation< L, R >, concat_part >
+	//
+	operator+( const concatenation< L, R >& a, const string& b )
+	{
+		return concatenation< concatenation< L, R >, concat_part >( a, b );
+	}
+	
+	template < class L, class R >
+	inline concatenation< concatenation< L, R >, concat_part >
+	//
+	operator+( const concatenation< L, R >& a, const char* b )
+	{
+		return concatenation< concatenation< L, R >, concat_part >( a, b );
+	}
 	
-	string operator+( const string& a, const char* b );
+	template < class L, class R >
+	inline concatenation< concat_part, concatenation< L, R > >
+	//
+	operator+( const string& a, const concatenation< L, R >& b )
+	{
+		return concatenation< concat_part, concatenation< L, R > >( a, b );
+	}
 	
-	string operator+( const char* a, const string& b );
+	template < class L, class R >
+	inline concatenation< concat_part, concatenation< L, R > >
+	//
+	operator+( const char* a, const concatenation< L, R >& b )
+	{
+		return concatenation< concat_part, concatenation< L, R > >( a, b );
+	}
 	
+	template < class L1, class R1, class L2, class R2 >
+	inline concatenation< concatenation< L1, R1 >, concatenation< L2, R2 > >
+	//
+	operator+( const concatenation< L1, R1 >& a, const concatenation< L2, R2 >& b )
+	{
+		typedef concatenation< L1, R1 > A;
+		typedef concatenation< L2, R2 > B;
+		
+		return concatenation< A, B >( a, b );
+	}
+
 }
 
 #endif
-
@@ -0,0 +1,174 @@
+/*
+	t/atomic_ref_count.cc
+	---------------------
+*/
+
+// Build this file with the atomic policy, whatever plus uses.
+#undef  CONFIG_ATOMIC_REFCOUNT
+#define CONFIG_ATOMIC_REFCOUNT  1
+
+// POSIX
+#include <pthread.h>
+
+// plus
+#include "plus/ref_count_ops.hh"
+
+// tap-out
+#include "tap/test.hh"
+
+
+static const unsigned n_tests = 5 + 2 + 3;
+
+
+using plus::ref_count_t;
+
+const int n_threads = 4;
+
+const int n_copies = 100 * 1000;
+
+
+static void ops()
+{
+	ref_count_t n = 0;
+	
+	plus::add_ref( n );
+	
+	EXPECT( plus::load_ref( n ) == 1 );
+	
+	plus::add_ref( n );
+	plus::add_ref( n );
+	
+	EXPECT( plus::load_ref( n ) == 3 );
+	
+	EXPECT( plus::release_ref( n ) == 2 );
+	EXPECT( plus::release_ref( n ) == 1 );
+	EXPECT( plus::release_ref( n ) == 0 );
+}
+
+struct shared_object
+{
+	ref_count_t  refs;
+	int          marks[ n_threads ];
+};
+
+static int n_destroyed;
+static int n_marks_seen;
+
+static void release( shared_object* x )
+{
+	if ( plus::release_ref( x->refs ) == 0 )
+	{
+		// The last owner sees every other owner's writes.
+		
+		for ( int i = 0;  i < n_threads;  ++i )
+		{
+			n_marks_seen += x->marks[ i ];
+		}
+		
+		delete x;
+		
+		__atomic_add_fetch( &n_destroyed, 1, __ATOMIC_RELAXED );
+	}
+}
+
+struct thread_args
+{
+	shared_object*  object;
+	int             index;
+};
+
+static void* copier( void* arg )
+{
+	shared_object* x = ((thread_args*) arg)->object;
+	
+	for ( int i = 0;  i < n_copies;  ++i )
+	{
+		plus::add_ref( x->refs );  // copy
+		
+		release( x );  // and destroy the copy
+	}
+	
+	return NULL;
+}
+
+static void* owner( void* arg )
+{
+	const thread_args& args = *(thread_args*) arg;
+	
+	args.object->marks[ args.index ] = 1;
+	
+	release( args.object );
+	
+	return NULL;
+}
+
+static void run_threads( void* (*f)( void* ), shared_object* x )
+{
+	pthread_t    threads[ n_threads ];
+	thread_args  args   [ n_threads ];
+	
+	for ( int i = 0;  i < n_threads;  ++i )
+	{
+		args[ i ].object = x;
+		args[ i ].index  = i;
+		
+		pthread_create( &threads[ i ], NULL, f, &args[ i ] );
+	}
+	
+	for ( int i = 0;  i < n_threads;  ++i )
+	{
+		pthread_join( threads[ i ], NULL );
+	}
+}
+
+static void cross_thread_copies()
+{
+	shared_object* x = new shared_object();
+	
+	plus::add_ref( x->refs );
+	
+	run_threads( &copier, x );
+	
+	EXPECT( plus::load_ref( x->refs ) == 1 );
+	
+	release( x );
+	
+	EXPECT( n_destroyed == 1 );
+}
+
+static void cross_thread_destruction()
+{
+	n_destroyed = 0;
+	
+	shared_object* x = new shared_object();
+	
+	// One reference for us, and one for each thread
+	
+	for ( int i = 0;  i <= n_threads;  ++i )
+	{
+		plus::add_ref( x->refs );
+	}
+	
+	release( x );
+	
+	EXPECT( n_destroyed == 0 );
+	
+	run_threads( &owner, x );
+	
+	EXPECT( n_destroyed == 1 );
+	
+	EXPECT( n_marks_seen == n_threads );
+}
+
+int main( int argc, const char *const *argv )
+{
+	tap::start( "atomic_ref_count", n_tests );
+	
+	ops();
+	
+	cross_thread_copies();
+	
+	cross_thread_destruction();
+	
+	return 0;
+}
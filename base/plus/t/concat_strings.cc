@@ -13,7 +13,7 @@
 #include "tap/test.hh"
 
 
-static const unsigned n_tests = 4;
+static const unsigned n_tests = 4 + 9;
 
 
 static void concat()
@@ -24,11 +24,49 @@ static void concat()
 	EXPECT( plus::concat( STR_LEN( "foo" ), STR_LEN( "bar" ) ) == "foobar" );
 }
 
+static void operators()
+{
+	const plus::string empty;
+	const plus::string foo = "foo";
+	const plus::string bar = "bar";
+	
+	plus::string s = foo + bar;
+	
+	EXPECT( s == "foobar" );
+	
+	s = foo + ": " + bar + "\r\n";
+	
+	EXPECT( s == "foo: bar\r\n" );
+	
+	s = "[" + foo + "]";
+	
+	EXPECT( s == "[foo]" );
+	
+	EXPECT( (empty + empty).size() == 0 );
+	
+	EXPECT( (foo + "/" + bar + "/" + foo).size() == 11 );
+	
+	EXPECT( foo + (bar + foo) == "foobarfoo" );
+	
+	EXPECT( "<" + (foo + bar) == "<foobar" );
+	
+	EXPECT( (foo + bar) + (bar + foo) == "foobarbarfoo" );
+	
+	// Operands may be the string being assigned
+	
+	s = "x";
+	
+	s = s + s + s;
+	
+	EXPECT( s == "xxx" );
+}
+
 int main( int argc, const char *const *argv )
 {
 	tap::start( "string_copy", n_tests );
 	
 	concat();
+	operators();
 	
 	return 0;
 }
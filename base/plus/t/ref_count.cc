@@ -0,0 +1,87 @@
+/*
+	t/ref_count.cc
+	--------------
+*/
+
+// plus
+#include "plus/ref_count.hh"
+#include "plus/string.hh"
+
+// tap-out
+#include "tap/test.hh"
+
+
+static const unsigned n_tests = 6 + 3;
+
+
+static int n_destroyed;
+
+class counted : public plus::ref_count< counted >
+{
+	public:
+		~counted()
+		{
+			++n_destroyed;
+		}
+};
+
+static void ref_count()
+{
+	const counted* x = new counted;
+	
+	intrusive_ptr_add_ref( x );
+	
+	EXPECT( intrusive_ptr_ref_count( x ) == 1 );
+	
+	intrusive_ptr_add_ref( x );
+	intrusive_ptr_add_ref( x );
+	
+	EXPECT( intrusive_ptr_ref_count( x ) == 3 );
+	
+	intrusive_ptr_release( x );
+	
+	EXPECT( intrusive_ptr_ref_count( x ) == 2 );
+	
+	intrusive_ptr_release( x );
+	
+	EXPECT( intrusive_ptr_ref_count( x ) == 1 );
+	
+	EXPECT( n_destroyed == 0 );
+	
+	intrusive_ptr_release( x );
+	
+	EXPECT( n_destroyed == 1 );
+}
+
+static void shared_string()
+{
+	const char* text = "This string is too long to be stored inline.";
+	
+	plus::string a = text;
+	
+	{
+		plus::string b = a;
+		plus::string c = b;
+		
+		EXPECT( c.data() == a.data() );  // shared, not copied
+	}
+	
+	EXPECT( a == text );
+	
+	plus::string d = a;
+	
+	a = "";
+	
+	EXPECT( d == text );  // the last reference keeps the buffer
+}
+
+int main( int argc, const char *const *argv )
+{
+	tap::start( "ref_count", n_tests );
+	
+	ref_count();
+	
+	shared_string();
+	
+	return 0;
+}
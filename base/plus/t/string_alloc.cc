@@ -13,7 +13,7 @@
 #include "tap/test.hh"
 
 
-static const unsigned n_tests = 3 + 2 + 2 + 5;
+static const unsigned n_tests = 3 + 2 + 2 + 5 + 5;
 
 
 #define LARGE_STRING  "0123456789abcdef" "ghijklmnopqrstuv"
@@ -89,6 +89,34 @@ static void static_varcopy()
 	EXPECT( c_data == c.data() );
 }
 
+static void growth()
+{
+	plus::var_string s;
+	
+	s.reserve( 5000 );
+	
+	const plus::datum_alloc_stats before = plus::get_datum_alloc_stats();
+	
+	for ( int i = 0;  i < 100000;  ++i )
+	{
+		s += char( 'a' + i % 26 );
+	}
+	
+	const plus::datum_alloc_stats& after = plus::get_datum_alloc_stats();
+	
+	EXPECT( s.size() == 100000 );
+	
+	EXPECT( s[ 26 * 1000 + 3 ] == 'd'  &&  s[ 99999 ] == 'd' );
+	
+	EXPECT( s.capacity() >= s.size() );
+	
+	// Large unshared strings grow in place (as far as we're concerned)
+	
+	EXPECT( after.copies == before.copies );
+	
+	EXPECT( after.reallocations > before.reallocations );
+}
+
 int main( int argc, const char *const *argv )
 {
 	tap::start( "string_alloc", n_tests );
@@ -101,5 +129,7 @@ int main( int argc, const char *const *argv )
 	
 	static_varcopy();
 	
+	growth();
+	
 	return 0;
 }
@@ -0,0 +1,143 @@
+/*
+	t/views.cc
+	----------
+*/
+
+// POSIX
+#include <fcntl.h>
+#include <unistd.h>
+
+// Standard C
+#include <stdlib.h>
+#include <string.h>
+
+// iota
+#include "iota/strings.hh"
+
+// text-input
+#include "text_input/feed.hh"
+#include "text_input/get_line_from_feed.hh"
+#include "text_input/mapped_input.hh"
+
+// tap-out
+#include "tap/test.hh"
+
+
+static const unsigned n_tests = 7 + 4 + 8;
+
+
+static bool equal( const text_input::line_view& line, const char* s )
+{
+	return line.size == strlen( s )  &&  memcmp( line.data, s, line.size ) == 0;
+}
+
+static void small_buffer()
+{
+	char buffer[ 8 ];
+	
+	text_input::feed feed( buffer, sizeof buffer );
+	
+	EXPECT( feed.capacity() == 8 );
+	
+	text_input::line_view line;
+	
+	feed.accept_input( STR_LEN( "foo\nbarb" ) );
+	
+	EXPECT( feed.get_line_view( line )  &&  equal( line, "foo" ) );
+	
+	EXPECT( line.data == buffer );  // not copied
+	
+	EXPECT( !feed.get_line_view( line ) );
+	
+	feed.accept_input( STR_LEN( "az\r\nqux" ) );
+	
+	EXPECT( feed.get_line_view( line )  &&  equal( line, "barbaz" ) );
+	
+	EXPECT( !feed.get_line_view( line ) );
+	
+	EXPECT( feed.get_fragment_ref() == "qux" );
+}
+
+static void external()
+{
+	const char text[] = "alpha\n" "\n" "gamma\r\n" "delta";
+	
+	text_input::feed feed;
+	
+	feed.accept_external_input( text, sizeof text - 1 );
+	
+	text_input::line_view line;
+	
+	EXPECT( feed.get_line_view( line )  &&  line.data == text + 0  &&  line.size == 5 );
+	EXPECT( feed.get_line_view( line )  &&  line.data == text + 6  &&  line.size == 0 );
+	EXPECT( feed.get_line_view( line )  &&  line.data == text + 7  &&  line.size == 5 );
+	
+	EXPECT( !feed.get_line_view( line )  &&  feed.get_fragment_ref() == "delta" );
+}
+
+struct fd_reader
+{
+	int fd;
+	
+	ssize_t operator()( char* buffer, size_t length ) const
+	{
+		return read( fd, buffer, length );
+	}
+};
+
+static void mapped()
+{
+	char path[] = "/tmp/text-input-views.XXXXXX";
+	
+	int fd = mkstemp( path );
+	
+	unlink( path );
+	
+	const char text[] = "#include <foo.h>\n" "int x;\n" "// no newline";
+	
+	write( fd, text, sizeof text - 1 );
+	
+	lseek( fd, 0, SEEK_SET );
+	
+	text_input::feed feed;
+	
+	text_input::mapped_input mapping( feed, fd );
+	
+	EXPECT( mapping.mapped() );
+	
+	// Mapping the file doesn't move the offset; consuming it does.
+	
+	EXPECT( lseek( fd, 0, SEEK_CUR ) == 0 );
+	
+	const fd_reader reader = { fd };
+	
+	text_input::line_view line;
+	
+	EXPECT( get_line_view_from_feed( feed, mapping.reader( reader ), line )  &&  equal( line, "#include <foo.h>" ) );
+	
+	mapping.sync();
+	
+	EXPECT( lseek( fd, 0, SEEK_CUR ) == STRLEN( "#include <foo.h>\n" ) );
+	
+	EXPECT( get_line_view_from_feed( feed, mapping.reader( reader ), line )  &&  equal( line, "int x;" ) );
+	EXPECT( get_line_view_from_feed( feed, mapping.reader( reader ), line )  &&  equal( line, "// no newline" ) );
+	
+	EXPECT( !get_line_view_from_feed( feed, mapping.reader( reader ), line ) );
+	
+	EXPECT( lseek( fd, 0, SEEK_CUR ) == sizeof text - 1 );
+	
+	close( fd );
+}
+
+int main( int argc, const char *const *argv )
+{
+	tap::start( "views", n_tests );
+	
+	small_buffer();
+	
+	external();
+	
+	mapped();
+	
+	return 0;
+}
@@ -20,7 +20,7 @@ namespace text_input
 	
 	void feed::advance_CRLF()
 	{
-		if ( its_last_end_was_CR  &&  its_mark < its_data_length  &&  its_buffer[ its_mark ] == '\n' )
+		if ( its_last_end_was_CR  &&  its_mark < its_data_length  &&  input()[ its_mark ] == '\n' )
 		{
 			++its_mark;
 			
@@ -28,10 +28,10 @@ namespace text_input
 		}
 	}
 	
-	const plus::string* feed::get_line_bare()
+	bool feed::get_line_view( line_view& line )
 	{
-		const char* begin = &its_buffer[ its_mark        ];
-		const char* end   = &its_buffer[ its_data_length ];
+		const char* begin = &input()[ its_mark        ];
+		const char* end   = &input()[ its_data_length ];
 		
 		ASSERT( begin <= end );
 		
@@ -39,33 +39,56 @@ namespace text_input
 		
 		const char* eol = gear::find_first_match( begin, end, newlines );
 		
-		if ( eol != NULL )
+		if ( eol == NULL )
 		{
-			its_last_line.assign( begin, eol );
+			its_next_line.append( begin, end );
 			
-			its_last_end_was_CR = *eol++ == '\r';
+			its_mark = its_data_length;
 			
-			its_mark += eol - begin;
+			return false;
+		}
+		
+		line.data = begin;
+		line.size = eol - begin;
+		
+		its_last_end_was_CR = *eol++ == '\r';
+		
+		its_mark += eol - begin;
+		
+		advance_CRLF();
+		
+		if ( !its_next_line.empty() )
+		{
+			// The line straddles a refill, so we have to put it together.
 			
-			advance_CRLF();
+			its_next_line.append( line.data, line.size );
 			
-			if ( !its_next_line.empty() )
-			{
-				its_next_line += its_last_line;
-				
-				its_last_line = its_next_line.move();
-				
-				its_next_line.clear();
-			}
+			its_last_line = its_next_line.move();
 			
-			return &its_last_line;
+			its_next_line.clear();
+			
+			line.data = its_last_line.data();
+			line.size = its_last_line.size();
 		}
 		
-		its_next_line.append( begin, end );
+		return true;
+	}
+	
+	const plus::string* feed::get_line_bare()
+	{
+		line_view line;
 		
-		its_mark = its_data_length;
+		if ( !get_line_view( line ) )
+		{
+			return NULL;
+		}
 		
-		return NULL;
+		if ( line.data != its_last_line.data() )
+		{
+			its_last_line.assign( line.data, line.size );
+		}
+		
+		return &its_last_line;
 	}
 	
 	const plus::string* feed::get_line()
@@ -86,8 +109,8 @@ namespace text_input
 	
 	const plus::string& feed::get_fragment_ref()
 	{
-		const char* begin = &its_buffer[ its_mark        ];
-		const char* end   = &its_buffer[ its_data_length ];
+		const char* begin = &input()[ its_mark        ];
+		const char* end   = &input()[ its_data_length ];
 		
 		its_next_line.append( begin, end );
 		
@@ -116,15 +139,17 @@ namespace text_input
 			throw buffer_occupied();
 		}
 		
-		return its_buffer;
+		return its_buffer ? its_buffer : its_storage;
 	}
 	
 	void feed::accept_input( size_type length )
 	{
-		ASSERT( length <= buffer_length );
+		ASSERT( length <= its_capacity );
 		
 		ASSERT( its_mark == its_data_length );
 		
+		its_external = NULL;
+		
 		its_data_length = length;
 		its_mark        = 0;
 		
@@ -133,7 +158,7 @@ namespace text_input
 	
 	void feed::accept_input( const char* buffer, size_type length )
 	{
-		if ( length > buffer_length )
+		if ( length > its_capacity )
 		{
 			throw buffer_overrun();
 		}
@@ -143,5 +168,17 @@ namespace text_input
 		accept_input( length );
 	}
 	
+	void feed::accept_external_input( const char* data, size_type length )
+	{
+		(void) buffer();  // throws if the current input isn't consumed
+		
+		its_external = data;
+		
+		its_data_length = length;
+		its_mark        = 0;
+		
+		advance_CRLF();
+	}
+	
 }
 
@@ -13,6 +13,18 @@
 namespace text_input
 {
 	
+	/*
+		A line without its terminator.  It points either into the feed's
+		input or into a string of the feed's, so it's valid until the next
+		call that changes the feed.
+	*/
+	
+	struct line_view
+	{
+		const char*              data;
+		plus::string::size_type  size;
+	};
+	
 	class feed
 	{
 		public:
@@ -24,7 +36,11 @@ namespace text_input
 			class buffer_overrun  {};
 		
 		private:
-			char its_buffer[ buffer_length ];
+			char its_storage[ buffer_length ];
+			
+			char*        its_buffer;    // the caller's buffer, or NULL
+			size_type    its_capacity;
+			const char*  its_external;  // input accepted in place, or NULL
 			
 			size_type its_data_length;
 			size_type its_mark;
@@ -36,17 +52,50 @@ namespace text_input
 			bool its_last_end_was_CR;
 		
 		private:
+			const char* input() const
+			{
+				return its_external ? its_external
+				     : its_buffer   ? its_buffer
+				     :                its_storage;
+			}
+			
 			void advance_CRLF();
 		
 		public:
 			feed()
 			:
+				its_buffer(),
+				its_capacity( buffer_length ),
+				its_external(),
 				its_data_length(),
 				its_mark(),
 				its_last_end_was_CR()
 			{
 			}
 			
+			// Read into the caller's buffer, which must outlive the feed.
+			
+			feed( char* buffer, size_type length )
+			:
+				its_buffer( buffer ),
+				its_capacity( length ),
+				its_external(),
+				its_data_length(),
+				its_mark(),
+				its_last_end_was_CR()
+			{
+			}
+			
+			size_type capacity() const  { return its_capacity; }
+			
+			// The current external input, or NULL, and how much is consumed
+			
+			const char* external_input() const  { return its_external; }
+			
+			size_type consumed() const  { return its_mark; }
+			
+			bool get_line_view( line_view& line );
+			
 			const plus::string* get_line_bare();
 			
 			const plus::string* get_line();
@@ -59,6 +108,14 @@ namespace text_input
 			void accept_input( size_type length );
 			
 			void accept_input( const char* buffer, size_type length );
+			
+			/*
+				Scan input where it lies (e.g. in a mapped file) instead of
+				copying it into the buffer.  It must stay put until it's been
+				consumed (i.e. until the next call to buffer()).
+			*/
+			
+			void accept_external_input( const char* data, size_type length );
 	};
 	
 }
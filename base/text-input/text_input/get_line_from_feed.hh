@@ -26,7 +26,7 @@ namespace text_input
 				return result;
 			}
 			
-			const size_type length = feed.buffer_length;
+			const size_type length = feed.capacity();
 			
 			const size_type n_read = read( feed.buffer(), length );
 			
@@ -40,6 +40,39 @@ namespace text_input
 		}
 	}
 	
+	template < class Reader >
+	bool get_line_view_from_feed( text_input::feed&       feed,
+	                              Reader                  read,
+	                              text_input::line_view&  line )
+	{
+		typedef plus::string::size_type size_type;
+		
+		while ( true )
+		{
+			if ( feed.get_line_view( line ) )
+			{
+				return true;
+			}
+			
+			const size_type length = feed.capacity();
+			
+			const size_type n_read = read( feed.buffer(), length );
+			
+			if ( n_read == 0 )
+			{
+				// end of file
+				const plus::string& fragment = feed.get_fragment_ref();
+				
+				line.data = fragment.data();
+				line.size = fragment.size();
+				
+				return !fragment.empty();
+			}
+			
+			feed.accept_input( n_read );
+		}
+	}
+	
 }
 
 #endif
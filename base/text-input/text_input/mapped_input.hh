@@ -0,0 +1,164 @@
+/*
+	text_input/mapped_input.hh
+	--------------------------
+*/
+
+#ifndef TEXTINPUT_MAPPEDINPUT_HH
+#define TEXTINPUT_MAPPEDINPUT_HH
+
+// POSIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// text-input
+#include "text_input/feed.hh"
+
+
+namespace text_input
+{
+	
+	/*
+		If fd is a regular file, map the rest of it into memory and hand it
+		to the feed as external input, so that lines read from the feed are
+		views of the mapping and nothing is copied.  If fd isn't a regular
+		file (or can't be mapped), nothing happens and the feed's reader
+		reads fd as usual.
+		
+		The file offset isn't moved by mapping the file, only by consuming
+		it:  sync() moves it just past what the feed has consumed from the
+		mapping, so that another user of the fd (e.g. a child process that
+		inherits it) starts where the feed left off.  Pass the feed's reader
+		through reader(), which syncs before reading, so that reading
+		resumes after the mapping once it's used up.  The destructor syncs
+		as well.
+		
+		This is POSIX only, so it's a header rather than part of the library.
+		The mapped_input must outlive the lines read from the mapping, and
+		the file mustn't be truncated while it's mapped.
+	*/
+	
+	class mapped_input;
+	
+	template < class Reader >
+	class mapped_reader
+	{
+		private:
+			mapped_input*  its_input;
+			Reader         its_reader;
+		
+		public:
+			mapped_reader( mapped_input& input, const Reader& reader )
+			:
+				its_input( &input ),
+				its_reader( reader )
+			{
+			}
+			
+			size_t operator()( char* buffer, size_t length );
+	};
+	
+	class mapped_input
+	{
+		private:
+			const feed&  its_feed;
+			int          its_fd;
+			void*        its_addr;
+			size_t       its_length;
+			off_t        its_offset;
+			
+			// non-copyable
+			mapped_input           ( const mapped_input& );
+			mapped_input& operator=( const mapped_input& );
+		
+		public:
+			mapped_input( feed& feed, int fd )
+			:
+				its_feed( feed ),
+				its_fd( fd ),
+				its_addr(),
+				its_length(),
+				its_offset()
+			{
+				struct stat st;
+				
+				if ( fstat( fd, &st ) < 0  ||  !S_ISREG( st.st_mode ) )
+				{
+					return;
+				}
+				
+				const off_t offset = lseek( fd, 0, SEEK_CUR );
+				
+				if ( offset < 0  ||  offset >= st.st_size )
+				{
+					return;
+				}
+				
+				const size_t length = st.st_size;
+				
+				void* addr = mmap( NULL, length, PROT_READ, MAP_PRIVATE, fd, 0 );
+				
+				if ( addr == MAP_FAILED )
+				{
+					return;
+				}
+				
+				try
+				{
+					feed.accept_external_input( (const char*) addr + offset,
+					                            length - offset );
+				}
+				catch ( ... )
+				{
+					munmap( addr, length );
+					
+					throw;
+				}
+				
+				its_addr   = addr;
+				its_length = length;
+				its_offset = offset;
+			}
+			
+			~mapped_input()
+			{
+				if ( its_addr )
+				{
+					sync();
+					
+					munmap( its_addr, its_length );
+				}
+			}
+			
+			bool mapped() const  { return its_addr != NULL; }
+			
+			void sync()
+			{
+				// Once the feed has moved on, fd is past the mapping already.
+				
+				const char* input = (const char*) its_addr + its_offset;
+				
+				if ( its_addr  &&  its_feed.external_input() == input )
+				{
+					lseek( its_fd, its_offset + its_feed.consumed(), SEEK_SET );
+				}
+			}
+			
+			template < class Reader >
+			mapped_reader< Reader > reader( const Reader& reader )
+			{
+				return mapped_reader< Reader >( *this, reader );
+			}
+	};
+	
+	template < class Reader >
+	inline size_t mapped_reader< Reader >::operator()( char* buffer, size_t length )
+	{
+		its_input->sync();
+		
+		return its_reader( buffer, length );
+	}
+	
+}
+
+#endif
@@ -0,0 +1,321 @@
+/*
+	find-timing.cc
+	--------------
+*/
+
+// Standard C
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+// gear
+#include "gear/find.hh"
+
+
+/*
+	Checks gear::find_first_match() and find_first_nonmatch() against a
+	plain byte-at-a-time search (over every offset and length in a range
+	of random buffers), and then times both on these workloads:
+	
+		lines:    scanning text with lines of 0-79 chars for each LF
+		crlf:     the same, for the first CR or LF (as text_input::feed does)
+		long:     searching 64K buffers for a char that isn't there
+		nonspace: skipping a run of spaces and tabs, 0-63 chars long
+	
+	Columns are the workload, the number of calls and bytes scanned, and
+	the best time of n_trials in microseconds for the byte loop and gear.
+	
+	The exit status is nonzero if any result differs.
+*/
+
+
+static uint64_t microclock()
+{
+	timeval tv;
+	
+	gettimeofday( &tv, NULL );
+	
+	return uint64_t( tv.tv_sec ) * 1000000 + tv.tv_usec;
+}
+
+const int n_trials = 7;
+
+const size_t text_size = 1024 * 1024;
+
+static char text[ text_size ];
+
+static unsigned long the_checksum;
+
+
+// gear's loops before it had vector kernels
+
+static bool char_matches( char c, const unsigned char* chars )
+{
+	for ( int n = *chars++;  n != 0;  --n )
+	{
+		if ( c == char( *chars++ ) )
+		{
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+static const char* bytewise( const char*           p,
+                             const char*           end,
+                             const unsigned char*  chars,
+                             bool                  negated )
+{
+	if ( chars[ 0 ] == 1 )
+	{
+		const char c = chars[ 1 ];
+		
+		for ( ;  p != end;  ++p )
+		{
+			if ( (*p == c) - negated )
+			{
+				return p;
+			}
+		}
+		
+		return NULL;
+	}
+	
+	for ( ;  p != end;  ++p )
+	{
+		if ( char_matches( *p, chars ) - negated )
+		{
+			return p;
+		}
+	}
+	
+	return NULL;
+}
+
+static const char* gear_find( const char*           p,
+                              const char*           end,
+                              const unsigned char*  chars,
+                              bool                  negated )
+{
+	if ( chars[ 0 ] == 1 )
+	{
+		return gear::find_first_match( p, end, chars[ 1 ], NULL, negated );
+	}
+	
+	return gear::find_first_match( p, end, chars, NULL, negated );
+}
+
+typedef const char* (*finder)( const char*, const char*, const unsigned char*, bool );
+
+
+static unsigned long random_number()
+{
+	static unsigned long x = 1;
+	
+	x = x * 1103515245 + 12345;
+	
+	return x >> 16;
+}
+
+static bool check()
+{
+	static const unsigned char sets[][ 20 ] =
+	{
+		{ 1, '\n' },
+		{ 1, '\0' },
+		{ 1, 0xFF },
+		{ 2, '\r', '\n' },
+		{ 3, ' ', '\t', '\n' },
+		{ 5, 'a', 'b', 'c', 'd', 'e' },
+		{ 16, '0', '1', '2', '3', '4', '5', '6', '7',
+		      '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' },
+		{ 17, '0', '1', '2', '3', '4', '5', '6', '7',
+		      '8', '9', 'a', 'b', 'c', 'd', 'e', 'f', 'g' },
+		{ 0 },
+	};
+	
+	const int n_sets = sizeof sets / sizeof sets[ 0 ];
+	
+	const int buffer_size = 100;
+	
+	char buffer[ buffer_size ];
+	
+	int n_failures = 0;
+	
+	for ( int round = 0;  round < 200;  ++round )
+	{
+		const unsigned char* chars = sets[ round % n_sets ];
+		
+		// Draw from a few bytes of the set and a few others, in runs
+		
+		const int n = chars[ 0 ];
+		
+		for ( int i = 0;  i < buffer_size;  ++i )
+		{
+			const unsigned long x = random_number();
+			
+			buffer[ i ] = n  &&  x % 4 < round % 5 ? chars[ 1 + x / 4 % n ]
+			                                         : "x0f\n\xFF"[ x / 4 % 5 ];
+		}
+		
+		for ( int begin = 0;  begin < buffer_size;  ++begin )
+		{
+			for ( int end = begin;  end <= buffer_size;  ++end )
+			{
+				const char* p = buffer + begin;
+				const char* q = buffer + end;
+				
+				for ( int negated = 0;  negated <= 1;  ++negated )
+				{
+					if ( gear_find( p, q, chars, negated ) != bytewise( p, q, chars, negated ) )
+					{
+						if ( ++n_failures <= 10 )
+						{
+							fprintf( stderr, "find-timing: mismatch: set size %d, "
+							                 "offset %d, length %d%s\n",
+							                 n,
+							                 begin,
+							                 end - begin,
+							                 negated ? ", negated" : "" );
+						}
+					}
+				}
+			}
+		}
+	}
+	
+	printf( "# check: %s\n", n_failures ? "FAILED" : "ok" );
+	
+	return n_failures == 0;
+}
+
+static void make_text( char fill, unsigned line_max )
+{
+	memset( text, fill, text_size );
+	
+	size_t i = 0;
+	
+	while ( (i += random_number() % line_max) < text_size )
+	{
+		text[ i++ ] = '\n';
+	}
+}
+
+static unsigned long scan_lines( finder find, const unsigned char* chars )
+{
+	unsigned long n_calls = 0;
+	
+	const char* p   = text;
+	const char* end = text + text_size;
+	
+	while ( const char* q = find( p, end, chars, false ) )
+	{
+		the_checksum += q - p;
+		
+		p = q + 1;
+		
+		++n_calls;
+	}
+	
+	return n_calls + 1;
+}
+
+static unsigned long scan_long( finder find, const unsigned char* chars )
+{
+	const size_t block_size = 64 * 1024;
+	
+	unsigned long n_calls = 0;
+	
+	for ( size_t i = 0;  i < text_size;  i += block_size )
+	{
+		the_checksum += find( text + i, text + i + block_size, chars, false ) != NULL;
+		
+		++n_calls;
+	}
+	
+	return n_calls;
+}
+
+static unsigned long scan_runs( finder find, const unsigned char* chars )
+{
+	unsigned long n_calls = 0;
+	
+	const char* p   = text;
+	const char* end = text + text_size;
+	
+	while ( const char* q = find( p, end, chars, true ) )
+	{
+		the_checksum += q - p;
+		
+		p = q + 1;
+		
+		++n_calls;
+	}
+	
+	return n_calls + 1;
+}
+
+typedef unsigned long (*workload)( finder find, const unsigned char* chars );
+
+static uint64_t best_time( workload run, finder find, const unsigned char* chars )
+{
+	uint64_t best = uint64_t( -1 );
+	
+	for ( int i = 0;  i < n_trials;  ++i )
+	{
+		const uint64_t start = microclock();
+		
+		run( find, chars );
+		
+		const uint64_t elapsed = microclock() - start;
+		
+		if ( elapsed < best )
+		{
+			best = elapsed;
+		}
+	}
+	
+	return best;
+}
+
+static void bench( const char* name, workload run, const unsigned char* chars )
+{
+	const unsigned long n_calls = run( &gear_find, chars );
+	
+	const uint64_t bytewise_usecs = best_time( run, &bytewise,  chars );
+	const uint64_t gear_usecs     = best_time( run, &gear_find, chars );
+	
+	printf( "%-9s %8lu %8lu %10lu %10lu\n",
+	        name,
+	        n_calls,
+	        (unsigned long) text_size,
+	        (unsigned long) bytewise_usecs,
+	        (unsigned long) gear_usecs );
+}
+
+int main( int argc, char** argv )
+{
+	const bool ok = check();
+	
+	static const unsigned char lf   [] = { 1, '\n' };
+	static const unsigned char crlf [] = { 2, '\r', '\n' };
+	static const unsigned char nul  [] = { 1, '\0' };
+	static const unsigned char blank[] = { 2, ' ', '\t' };
+	
+	printf( "# workload     calls    bytes   bytewise       gear\n" );
+	
+	make_text( 'x', 80 );
+	
+	bench( "lines", &scan_lines, lf   );
+	bench( "crlf",  &scan_lines, crlf );
+	bench( "long",  &scan_long,  nul  );
+	
+	make_text( ' ', 64 );
+	
+	bench( "nonspace", &scan_runs, blank );
+	
+	return ! ok;
+}
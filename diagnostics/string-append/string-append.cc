@@ -0,0 +1,207 @@
+/*
+	string-append.cc
+	----------------
+*/
+
+// Standard C
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+// Standard C++
+#include <vector>
+
+// plus
+#include "plus/datum_alloc.hh"
+#include "plus/string/concat.hh"
+#include "plus/var_string.hh"
+
+// text-input
+#include "text_input/feed.hh"
+
+
+/*
+	Times append-heavy workloads and reports what the string allocator did
+	for them (in the calling thread):
+	
+		append:  var_string grown 16 bytes at a time to 64K
+		feed:    text_input::feed splitting 1 MB of text into lines
+		words:   sh-style word building and brace expansion
+	
+	Columns are the best time of n_trials, in microseconds, and then the
+	allocator's counts for one run:  malloc() and realloc() calls, blocks
+	recycled from a free list, and copies (and bytes copied) of a string's
+	contents into a new block.
+*/
+
+
+static uint64_t microclock()
+{
+	timeval tv;
+	
+	gettimeofday( &tv, NULL );
+	
+	return uint64_t( tv.tv_sec ) * 1000000 + tv.tv_usec;
+}
+
+const int n_trials = 7;
+
+const size_t text_size = 1024 * 1024;
+
+static char text[ text_size ];
+
+static unsigned long result_size;
+
+
+static void make_text()
+{
+	// Lines of 0 to 199 characters, deterministically
+	
+	unsigned long x = 1;
+	
+	size_t i = 0;
+	
+	while ( i < text_size )
+	{
+		x = x * 1103515245 + 12345;
+		
+		size_t n = (x >> 16) % 200;
+		
+		while ( n-- > 0  &&  i < text_size - 1 )
+		{
+			text[ i ] = 'a' + i % 26;  ++i;
+		}
+		
+		text[ i++ ] = '\n';
+	}
+}
+
+static void append()
+{
+	const char piece[] = "0123456789abcdef";
+	
+	for ( int j = 0;  j < 16;  ++j )
+	{
+		plus::var_string s;
+		
+		for ( int k = 0;  k < 4096;  ++k )
+		{
+			s.append( piece, sizeof piece - 1 );
+		}
+		
+		result_size += s.size();
+	}
+}
+
+static void feed()
+{
+	text_input::feed feed;
+	
+	const size_t chunk = text_input::feed::buffer_length;
+	
+	for ( size_t i = 0;  i < text_size;  i += chunk )
+	{
+		feed.accept_input( text + i, chunk );
+		
+		while ( const plus::string* line = feed.get_line() )
+		{
+			result_size += line->size();
+		}
+	}
+}
+
+static void words()
+{
+	std::vector< plus::string > expansion;
+	
+	const plus::string preamble = "/usr/local/share/";
+	const plus::string postscript = ".d/defaults.conf";
+	
+	const char* subs[] = { "alpha", "bravo", "charlie", "delta" };
+	
+	const char* p = text;
+	
+	for ( int j = 0;  j < 4096;  ++j )
+	{
+		// Build a word a character at a time, as a tokenizer does.
+		
+		plus::var_string word;
+		
+		while ( *p != '\n' )
+		{
+			word += *p++;
+		}
+		
+		++p;
+		
+		expansion.clear();
+		
+		for ( int k = 0;  k < 4;  ++k )
+		{
+			plus::var_string sub = subs[ k ];
+			
+			sub += word;
+			
+			expansion.push_back( preamble + sub + postscript );
+		}
+		
+		result_size += expansion.back().size();
+	}
+}
+
+static void run( const char* name, void (*f)() )
+{
+	f();  // warm up
+	
+	const plus::datum_alloc_stats before = plus::get_datum_alloc_stats();
+	
+	f();
+	
+	const plus::datum_alloc_stats after = plus::get_datum_alloc_stats();
+	
+	uint64_t best = 0;
+	
+	for ( int trial = 0;  trial < n_trials;  ++trial )
+	{
+		const uint64_t start = microclock();
+		
+		f();
+		
+		const uint64_t result = microclock() - start;
+		
+		if ( best == 0  ||  result < best )
+		{
+			best = result;
+		}
+	}
+	
+	printf( "%-8s %8llu  %7lu %7lu %7lu %7lu %9lu\n",
+	        name,
+	        (unsigned long long) best,
+	        after.allocations   - before.allocations,
+	        after.reallocations - before.reallocations,
+	        after.recycled      - before.recycled,
+	        after.copies        - before.copies,
+	        after.bytes_copied  - before.bytes_copied );
+}
+
+int main( int argc, char **argv )
+{
+	make_text();
+	
+	printf( "%-8s %8s  %7s %7s %7s %7s %9s\n",
+	        "",
+	        "usecs",
+	        "malloc",
+	        "realloc",
+	        "reused",
+	        "copies",
+	        "bytes" );
+	
+	run( "append", &append );
+	run( "feed",   &feed   );
+	run( "words",  &words  );
+	
+	return result_size == 0;
+}
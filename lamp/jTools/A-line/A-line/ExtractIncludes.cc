@@ -14,6 +14,7 @@
 // text-input
 #include "text_input/feed.hh"
 #include "text_input/get_line_from_feed.hh"
+#include "text_input/mapped_input.hh"
 
 // poseven
 #include "poseven/extras/fd_reader.hh"
@@ -39,7 +40,7 @@ namespace tool
 		
 		if ( ~pos  &&  line[ pos ] == '#' )
 		{
-			if ( memcmp( line.data() + pos + 1, STR_LEN( "include" ) ) == 0 )
+			if ( line.size() - pos >= STRLEN( "#include" )  &&  memcmp( line.data() + pos + 1, STR_LEN( "include" ) ) == 0 )
 			{
 				try
 				{
@@ -71,7 +72,8 @@ namespace tool
 					
 					std::vector< plus::string >& v( c == '"' ? includes.user : includes.system );
 					
-					v.push_back( line.substr( pos, end - pos ) );
+					// Copy it, since line is a view of the file
+					v.push_back( plus::string( line.data() + pos, end - pos ) );
 				}
 				catch ( const BadIncludeDirective& )
 				{
@@ -90,11 +92,15 @@ namespace tool
 		
 		n::owned< p7::fd_t > fd = p7::open( pathname, p7::o_rdonly );
 		
+		text_input::mapped_input mapping( feed, fd.get() );
+		
 		p7::fd_reader reader( fd );
 		
-		while ( const plus::string* s = get_line_bare_from_feed( feed, reader ) )
+		text_input::line_view view;
+		
+		while ( get_line_view_from_feed( feed, mapping.reader( reader ), view ) )
 		{
-			plus::string line( *s );
+			const plus::string line( view.data, view.size, plus::delete_never );
 			
 			ExtractInclude( line, result );
 		}
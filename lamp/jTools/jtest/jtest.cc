@@ -38,6 +38,7 @@
 // text-input
 #include "text_input/feed.hh"
 #include "text_input/get_line_from_feed.hh"
+#include "text_input/mapped_input.hh"
 
 // poseven
 #include "poseven/extras/fd_reader.hh"
@@ -125,9 +126,11 @@ namespace tool
 	};
 	
 	
+	typedef text_input::mapped_reader< p7::fd_reader > test_file_reader;
+	
 	static Redirection GetRedirectionFromLine( const plus::string&  line,
 	                                           text_input::feed&    feed,
-	                                           p7::fd_reader        reader )
+	                                           test_file_reader     reader )
 	{
 		std::size_t end_of_fd = line.find_first_not_of( "0123456789" );
 		
@@ -183,18 +186,18 @@ namespace tool
 				
 				bool found_terminator = false;
 				
-				while ( const plus::string* s = get_line_bare_from_feed( feed, reader ) )
+				text_input::line_view next_line;
+				
+				while ( get_line_view_from_feed( feed, reader, next_line ) )
 				{
-					plus::string nextLine( *s );
-					
-					if ( nextLine == param )
+					if ( next_line.size == param.size()  &&  memcmp( next_line.data, param.data(), param.size() ) == 0 )
 					{
 						found_terminator = true;
 						
 						break;
 					}
 					
-					hereDoc += nextLine;
+					hereDoc.append( next_line.data, next_line.size );
 					hereDoc += "\n";
 				}
 				
@@ -515,20 +518,24 @@ namespace tool
 		
 		text_input::feed feed;
 		
+		text_input::mapped_input mapping( feed, fd );
+		
 		p7::fd_reader reader = p7::fd_t( fd );
 		
-		while ( const plus::string* s = get_line_bare_from_feed( feed, reader ) )
+		text_input::line_view view;
+		
+		while ( get_line_view_from_feed( feed, mapping.reader( reader ), view ) )
 		{
-			plus::string line( *s );
-			
-			if ( line.empty() )  continue;
+			if ( view.size == 0 )  continue;
 			
-			if ( line[0] == '#' )
+			if ( view.data[0] == '#' )
 			{
 				// comment
 				continue;
 			}
 			
+			const plus::string line( view.data, view.size );
+			
 			if ( line[0] == '$' )
 			{
 				plus::string command = line.substr( line.find_first_not_of( " \t", 1 ) );
@@ -548,7 +555,7 @@ namespace tool
 			
 			if ( std::isdigit( line[0] ) )
 			{
-				test.AddRedirection( GetRedirectionFromLine( line, feed, reader ) );
+				test.AddRedirection( GetRedirectionFromLine( line, feed, mapping.reader( reader ) ) );
 				
 				continue;
 			}
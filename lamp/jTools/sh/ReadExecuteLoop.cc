@@ -20,6 +20,7 @@
 // text-input
 #include "text_input/feed.hh"
 #include "text_input/get_line_from_feed.hh"
+#include "text_input/mapped_input.hh"
 
 // poseven
 #include "poseven/extras/fd_reader.hh"
@@ -105,16 +106,24 @@ namespace tool
 		
 		text_input::feed feed;
 		
+		text_input::mapped_input mapping( feed, fd );
+		
 		p7::fd_reader reader( fd );
 		
 		const unsigned char whitespace[] = { 2, ' ', '\t' };
 		
-		while ( const plus::string* s = get_line_bare_from_feed( feed, reader ) )
+		text_input::line_view line;
+		
+		while ( get_line_view_from_feed( feed, mapping.reader( reader ), line ) )
 		{
 			// Only process non-blank lines
-			if ( gear::find_first_nonmatch( s->data(), s->size(), whitespace ) )
+			if ( gear::find_first_nonmatch( line.data, line.size, whitespace ) )
 			{
-				plus::string command( *s );
+				plus::string command( line.data, line.size );
+				
+				// Commands that read the script's fd start after this line.
+				
+				mapping.sync();
 				
 				{
 					SetRowsAndColumns();
@@ -341,18 +341,6 @@ namespace tool
 		}
 	}
 	
-	static void DoLine( const plus::string& line )
-	{
-		if ( dataMode )
-		{
-			DoData( line );
-		}
-		else
-		{
-			DoCommand( line );
-		}
-	}
-	
 	int Main( int argc, char** argv )
 	{
 		sockaddr_in peer;
@@ -391,11 +379,20 @@ namespace tool
 		
 		p7::fd_reader reader( p7::stdin_fileno );
 		
-		while ( const plus::string* s = get_line_bare_from_feed( feed, reader ) )
+		text_input::line_view view;
+		
+		while ( get_line_view_from_feed( feed, reader, view ) )
 		{
-			plus::string line( *s );
-			
-			DoLine( line );
+			if ( dataMode )
+			{
+				// Message lines aren't kept, so they needn't be copied.
+				
+				DoData( plus::string( view.data, view.size, plus::delete_never ) );
+			}
+			else
+			{
+				DoCommand( plus::string( view.data, view.size ) );
+			}
 		}
 		
 		return 0;
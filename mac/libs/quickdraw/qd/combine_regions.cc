@@ -0,0 +1,198 @@
+/*
+	combine_regions.cc
+	------------------
+*/
+
+#include "qd/combine_regions.hh"
+
+// quickdraw
+#include "qd/region_detail.hh"
+
+
+#ifndef NULL
+#define NULL  0
+#endif
+
+
+namespace quickdraw
+{
+	
+	/*
+		An extent lists, for each v coordinate, the h coordinates at which
+		coverage inverts relative to the scanline above.  The coverage of a
+		scanline is thus the accumulation (by XOR) of every inversion line
+		so far -- a sorted list of edges, where coverage begins or ends.
+		
+		To combine two regions, sweep down both extents, maintaining the
+		coverage edges of each.  At each v coordinate where either region's
+		coverage changes, the result's inversion points are the h values at
+		which op( a, b ) above the line differs from op( a, b ) below it --
+		found by a single merge of the four edge lists.
+		
+		Edge lists are terminated by Region_end, which sorts after every
+		coordinate.  No edge list can be longer than the total number of
+		h coordinates in its region, which geometry bounds from above.
+	*/
+	
+	static inline size_t max_edges( region_geometry_t g )
+	{
+		return size_t( g.n_v_coords ) * g.n_h_coords;
+	}
+	
+	size_t region_op_scratch_size( region_geometry_t a, region_geometry_t b )
+	{
+		const size_t n_a = max_edges( a );
+		const size_t n_b = max_edges( b );
+		
+		// Two edge lists per region, plus a line for measuring the output
+		
+		return 2 * (n_a + 1) + 2 * (n_b + 1) + 2 * (n_a + n_b) + 2;
+	}
+	
+	static inline short min( short a, short b )
+	{
+		return a < b ? a : b;
+	}
+	
+	static short* changed_coverage( unsigned      truth_table,
+	                                const short*  a0,
+	                                const short*  a1,
+	                                const short*  b0,
+	                                const short*  b1,
+	                                short*        r )
+	{
+		/*
+			a0 and b0 are the edges above the line, a1 and b1 below it.
+			The truth table is indexed by a | b << 1.
+		*/
+		
+		unsigned in_a0 = 0;
+		unsigned in_a1 = 0;
+		unsigned in_b0 = 0;
+		unsigned in_b1 = 0;
+		
+		unsigned inverted = 0;
+		
+		while ( true )
+		{
+			const short h = min( min( *a0, *a1 ), min( *b0, *b1 ) );
+			
+			if ( h == Region_end )
+			{
+				return r;
+			}
+			
+			const unsigned step_a0 = *a0 == h;
+			const unsigned step_a1 = *a1 == h;
+			const unsigned step_b0 = *b0 == h;
+			const unsigned step_b1 = *b1 == h;
+			
+			a0 += step_a0;  in_a0 ^= step_a0;
+			a1 += step_a1;  in_a1 ^= step_a1;
+			b0 += step_b0;  in_b0 ^= step_b0;
+			b1 += step_b1;  in_b1 ^= step_b1;
+			
+			const unsigned above = truth_table >> (in_a0 | in_b0 << 1);
+			const unsigned below = truth_table >> (in_a1 | in_b1 << 1);
+			
+			const unsigned now_inverted = (above ^ below) & 1;
+			
+			if ( now_inverted != inverted )
+			{
+				*r++ = h;
+				
+				inverted = now_inverted;
+			}
+		}
+	}
+	
+	static const unsigned char truth_tables[] =
+	{
+		0xE,  // union:         in a, in b, or both
+		0x8,  // intersection:  in both
+		0x2,  // difference:    in a only
+		0x6,  // exclusive or:  in a only or b only
+	};
+	
+	size_t combine_regions( region_op     op,
+	                        const short*  a,
+	                        const short*  b,
+	                        short*        r,
+	                        short*        scratch )
+	{
+		const unsigned truth_table = truth_tables[ op ];
+		
+		const region_geometry_t g_a = region_geometry( a );
+		const region_geometry_t g_b = region_geometry( b );
+		
+		const size_t n_a = max_edges( g_a ) + 1;
+		const size_t n_b = max_edges( g_b ) + 1;
+		
+		short* a_edges[ 2 ] = { scratch,           scratch + n_a           };
+		short* b_edges[ 2 ] = { scratch + 2 * n_a, scratch + 2 * n_a + n_b };
+		
+		short* measure = scratch + 2 * (n_a + n_b);
+		
+		*a_edges[ 0 ] = Region_end;
+		*b_edges[ 0 ] = Region_end;
+		
+		short* a0 = a_edges[ 0 ];
+		short* b0 = b_edges[ 0 ];
+		
+		size_t length = 0;
+		
+		while ( true )
+		{
+			const short v = min( *a, *b );
+			
+			if ( v == Region_end )
+			{
+				break;
+			}
+			
+			short* a1 = a0;
+			short* b1 = b0;
+			
+			if ( *a == v )
+			{
+				++a;
+				
+				a1 = a_edges[ a0 == a_edges[ 0 ] ];
+				
+				invert_edges( a0, a, a1 );
+			}
+			
+			if ( *b == v )
+			{
+				++b;
+				
+				b1 = b_edges[ b0 == b_edges[ 0 ] ];
+				
+				invert_edges( b0, b, b1 );
+			}
+			
+			short* line = r != NULL ? r + length : measure;
+			
+			short* end = changed_coverage( truth_table, a0, a1, b0, b1, line + 1 );
+			
+			if ( end != line + 1 )
+			{
+				*line = v;
+				*end++ = Region_end;
+				
+				length += end - line;
+			}
+			
+			a0 = a1;
+			b0 = b1;
+		}
+		
+		if ( r != NULL )
+		{
+			r[ length ] = Region_end;
+		}
+		
+		return length + 1;
+	}
+	
+}
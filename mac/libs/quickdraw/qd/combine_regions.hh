@@ -0,0 +1,49 @@
+/*
+	combine_regions.hh
+	------------------
+*/
+
+#ifndef QUICKDRAW_COMBINEREGIONS_HH
+#define QUICKDRAW_COMBINEREGIONS_HH
+
+// Standard C
+#include <stddef.h>
+
+// quickdraw
+#include "qd/regions.hh"
+
+
+namespace quickdraw
+{
+	
+	enum region_op
+	{
+		region_op_union,
+		region_op_sect,
+		region_op_diff,  // a - b
+		region_op_xor
+	};
+	
+	/*
+		The number of shorts of scratch space that combine_regions() needs
+		for regions of the given geometry.
+	*/
+	
+	size_t region_op_scratch_size( region_geometry_t a, region_geometry_t b );
+	
+	/*
+		Combine the extents a and b, writing the result to r.  Returns the
+		length of the result in shorts, including the terminator.  If r is
+		NULL, nothing is written, so a caller can size the output exactly
+		before allocating it.
+	*/
+	
+	size_t combine_regions( region_op     op,
+	                        const short*  a,
+	                        const short*  b,
+	                        short*        r,
+	                        short*        scratch );
+	
+}
+
+#endif
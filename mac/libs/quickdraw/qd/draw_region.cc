@@ -0,0 +1,276 @@
+/*
+	draw_region.cc
+	--------------
+*/
+
+#include "qd/draw_region.hh"
+
+// Standard C
+#include <stdint.h>
+
+// iota
+#include "iota/endian.hh"
+
+// quickdraw
+#include "qd/region_detail.hh"
+
+
+#ifndef NULL
+#define NULL  0
+#endif
+
+
+namespace quickdraw
+{
+	
+	/*
+		Walk down the extent, maintaining the coverage edges of the current
+		scanline (as in combine_regions()), and draw each band of rows that
+		share the same edges one span at a time.
+		
+		Spans are drawn a machine word at a time:  The first and last words
+		are merged under edge masks and the words between are stored whole.
+		Words are aligned in memory rather than relative to the bitmap, so
+		masks are built in pixel (i.e. big-endian) order and then byte-swapped
+		as needed.  An edge word may extend past either end of the bitmap,
+		in which case the span is drawn a byte at a time instead, as is a
+		copy from a source that's misaligned with respect to the destination.
+	*/
+	
+#ifdef __LP64__
+	
+	typedef uint64_t word_t;
+	
+#else
+	
+	typedef uint32_t word_t;
+	
+#endif
+	
+	static inline uint8_t  big( uint8_t  x )  { return x; }
+	static inline uint32_t big( uint32_t x )  { return iota::big_u32( x ); }
+	static inline uint64_t big( uint64_t x )  { return iota::big_u64( x ); }
+	
+	static inline short min( short a, short b )
+	{
+		return a < b ? a : b;
+	}
+	
+	static inline short max( short a, short b )
+	{
+		return a > b ? a : b;
+	}
+	
+	struct paint_op
+	{
+		template < class Int >
+		static void apply( Int* p, const Int* s, Int mask )  { *p |= mask; }
+	};
+	
+	struct erase_op
+	{
+		template < class Int >
+		static void apply( Int* p, const Int* s, Int mask )  { *p &= ~mask; }
+	};
+	
+	struct invert_op
+	{
+		template < class Int >
+		static void apply( Int* p, const Int* s, Int mask )  { *p ^= mask; }
+	};
+	
+	struct copy_op
+	{
+		template < class Int >
+		static void apply( Int* p, const Int* s, Int mask )
+		{
+			*p = (*p & ~mask) | (*s & mask);
+		}
+	};
+	
+	/*
+		Draw the bits [l, r) counting from the most significant bit of *p,
+		where 0 <= l < r.  Units of Int are aligned in memory, with p
+		pointing at the one containing bit l.
+	*/
+	
+	template < class Op, class Int >
+	static inline
+	void draw_units( Int* p, const Int* s, unsigned l, unsigned r )
+	{
+		const unsigned n_bits = sizeof (Int) * 8;
+		
+		const Int ones = Int( -1 );
+		
+		Int* last = p + (r - 1) / n_bits;
+		
+		const Int first_mask = big( Int( ones >> l ) );
+		const Int last_mask  = big( Int( ones << (n_bits - 1 - (r - 1) % n_bits) ) );
+		
+		if ( p == last )
+		{
+			Op::apply( p, s, Int( first_mask & last_mask ) );
+			return;
+		}
+		
+		Op::apply( p++, s++, first_mask );
+		
+		while ( p < last )
+		{
+			Op::apply( p++, s++, ones );
+		}
+		
+		Op::apply( p, s, last_mask );
+	}
+	
+	struct raster_rows
+	{
+		uint8_t*        base;
+		const uint8_t*  src;   // base of source, or NULL
+		const uint8_t*  end;   // end of the bitmap
+		long            stride;
+		const short*    bounds;
+	};
+	
+	template < class Op >
+	static
+	void draw_span( const raster_rows& rows, long offset, unsigned l, unsigned r )
+	{
+		// bits [l, r) of the row at offset, where l < r
+		
+		uint8_t* row = rows.base + offset;
+		
+		const uint8_t* src_row = rows.src ? rows.src + offset : row;
+		
+		const uintptr_t word_mask = sizeof (word_t) - 1;
+		
+		uint8_t* first = row + l / 8;
+		uint8_t* last  = row + (r - 1) / 8;
+		
+		uint8_t* w0 = (uint8_t*) ((uintptr_t) first & ~word_mask);
+		uint8_t* w1 = (uint8_t*) ((uintptr_t) last  & ~word_mask);
+		
+		const bool aligned = (((uintptr_t) row ^ (uintptr_t) src_row) & word_mask) == 0;
+		
+		if ( aligned  &&  w0 >= rows.base  &&  w1 + sizeof (word_t) <= rows.end )
+		{
+			const unsigned skip = (first - w0) * 8 + l % 8;
+			
+			draw_units< Op >( (word_t*) w0,
+			                  (const word_t*) (src_row + (w0 - row)),
+			                  skip,
+			                  skip + r - l );
+		}
+		else
+		{
+			draw_units< Op >( first, src_row + l / 8, l % 8, l % 8 + r - l );
+		}
+	}
+	
+	template < class Op >
+	static
+	void draw_band( const raster_rows& rows, const short* edges, short top, short bottom )
+	{
+		const short left  = rows.bounds[ 1 ];
+		const short right = rows.bounds[ 3 ];
+		
+		long offset = (top - rows.bounds[ 0 ]) * rows.stride;
+		
+		for ( short v = top;  v < bottom;  ++v, offset += rows.stride )
+		{
+			for ( const short* e = edges;  *e < right;  e += 2 )
+			{
+				const short l = max( e[ 0 ], left  );
+				const short r = min( e[ 1 ], right );
+				
+				if ( l < r )
+				{
+					draw_span< Op >( rows, offset, l - left, r - left );
+				}
+			}
+		}
+	}
+	
+	template < class Op >
+	static
+	void draw( const short* extent, const raster_rows& rows, short* scratch )
+	{
+		const region_geometry_t g = region_geometry( extent );
+		
+		short* edges[ 2 ];
+		
+		edges[ 0 ] = scratch;
+		edges[ 1 ] = scratch + size_t( g.n_v_coords ) * g.n_h_coords + 1;
+		
+		short* e = edges[ 0 ];
+		
+		*e = Region_end;
+		
+		const short top    = rows.bounds[ 0 ];
+		const short bottom = rows.bounds[ 2 ];
+		
+		short v = *extent++;
+		
+		while ( v != Region_end  &&  v < bottom )
+		{
+			short* next = edges[ e == edges[ 0 ] ];
+			
+			invert_edges( e, extent, next );
+			
+			e = next;
+			
+			const short next_v = *extent++;
+			
+			if ( *e != Region_end  &&  next_v > top )
+			{
+				draw_band< Op >( rows, e, max( v, top ), min( next_v, bottom ) );
+			}
+			
+			v = next_v;
+		}
+	}
+	
+	size_t draw_region_scratch_size( region_geometry_t g )
+	{
+		// Two edge lists
+		
+		return 2 * (size_t( g.n_v_coords ) * g.n_h_coords + 1);
+	}
+	
+	void draw_region( const short*     extent,
+	                  raster_op        op,
+	                  const bitmap_t&  dst,
+	                  const void*      src,
+	                  short*           scratch )
+	{
+		const short* bounds = dst.bounds;
+		
+		if ( bounds[ 0 ] >= bounds[ 2 ]  ||  bounds[ 1 ] >= bounds[ 3 ] )
+		{
+			return;
+		}
+		
+		uint8_t* base = (uint8_t*) dst.base;
+		
+		const raster_rows rows =
+		{
+			base,
+			op == raster_copy ? (const uint8_t*) src : NULL,
+			base + (bounds[ 2 ] - bounds[ 0 ]) * dst.stride,
+			dst.stride,
+			bounds,
+		};
+		
+		switch ( op )
+		{
+			case raster_paint:   draw< paint_op  >( extent, rows, scratch );  break;
+			case raster_erase:   draw< erase_op  >( extent, rows, scratch );  break;
+			case raster_invert:  draw< invert_op >( extent, rows, scratch );  break;
+			case raster_copy:    draw< copy_op   >( extent, rows, scratch );  break;
+			
+			default:
+				break;
+		}
+	}
+	
+}
@@ -0,0 +1,62 @@
+/*
+	draw_region.hh
+	--------------
+*/
+
+#ifndef QUICKDRAW_DRAWREGION_HH
+#define QUICKDRAW_DRAWREGION_HH
+
+// Standard C
+#include <stddef.h>
+
+// quickdraw
+#include "qd/regions.hh"
+
+
+namespace quickdraw
+{
+	
+	enum raster_op
+	{
+		raster_paint,   // set
+		raster_erase,   // clear
+		raster_invert,  // toggle
+		raster_copy     // from a source bitmap with the same layout
+	};
+	
+	/*
+		A packed 1-bit bitmap, most significant bit leftmost, as in
+		QuickDraw's BitMap.  Bounds are top, left, bottom, right (like a
+		region's bbox), in the region's coordinate space.
+	*/
+	
+	struct bitmap_t
+	{
+		void*  base;
+		long   stride;  // bytes per row
+		short  bounds[ 4 ];
+	};
+	
+	/*
+		The number of shorts of scratch space that draw_region() needs
+		for a region of the given geometry.
+	*/
+	
+	size_t draw_region_scratch_size( region_geometry_t g );
+	
+	/*
+		Apply op to every pixel of dst that's inside both the extent and
+		dst's bounds.  For raster_copy, src is the base address of a bitmap
+		with the same stride and bounds as dst (e.g. a back buffer);
+		otherwise it's ignored.
+	*/
+	
+	void draw_region( const short*     extent,
+	                  raster_op        op,
+	                  const bitmap_t&  dst,
+	                  const void*      src,
+	                  short*           scratch );
+	
+}
+
+#endif
@@ -17,6 +17,13 @@ namespace quickdraw
 		return a < b;
 	}
 	
+	/*
+		Write the edge list XOR the inversion line to r, and advance line
+		past its terminator.  Returns the end of the new edge list.
+	*/
+	
+	short* invert_edges( const short* edges, const short*& line, short* r );
+	
 }
 
 #endif
@@ -116,4 +116,38 @@ namespace quickdraw
 		}
 	}
 	
+	short* invert_edges( const short* edges, const short*& line, short* r )
+	{
+		// Write edges XOR line to r, and advance line past its terminator.
+		
+		while ( true )
+		{
+			const short e = *edges;
+			const short h = *line;
+			
+			if ( precedes_in_region( e, h ) )
+			{
+				*r++ = e;
+				++edges;
+			}
+			else if ( precedes_in_region( h, e ) )
+			{
+				*r++ = h;
+				++line;
+			}
+			else if ( h == Region_end )
+			{
+				*r++ = Region_end;
+				++line;
+				
+				return r;
+			}
+			else
+			{
+				++edges;  // inverted twice, so cancelled
+				++line;
+			}
+		}
+	}
+	
 }
@@ -0,0 +1,350 @@
+/*
+	region-bench.cc
+	---------------
+*/
+
+// Standard C
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// quickdraw
+#include "qd/combine_regions.hh"
+#include "qd/draw_region.hh"
+#include "qd/region_detail.hh"
+#include "qd/regions.hh"
+#include "qd/xor_region.hh"
+
+
+#pragma exceptions off
+
+
+/*
+	Times the region operations on large regions with many scanlines:
+	
+		disks:    two overlapping disks, 8000 scanlines each
+		lattice:  a comb of 200 vertical bars and 4000 horizontal stripes,
+		          whose union has 400 inversion points per scanline
+	
+	and draws a disk and the comb (clipped) into a 512x342 1-bit bitmap,
+	the size of the xv68k screen.
+	
+	Usage:  region-bench [iterations]
+*/
+
+
+using quickdraw::Region_end;
+
+
+typedef void (*row_function)( int y, short* edges, int* n_edges );
+
+static short* make_region( int top, int bottom, row_function row )
+{
+	/*
+		Build an extent from the coverage of each row, given as a sorted
+		list of edges.  A scanline's inversion points are the edges that
+		differ from the row above.
+	*/
+	
+	const int max_edges = 1024;
+	
+	short edges[ 2 ][ max_edges + 1 ];
+	
+	int n_edges[ 2 ] = { 0, 0 };
+	
+	size_t capacity = 1024;
+	size_t length   = 0;
+	
+	short* extent = (short*) malloc( capacity * sizeof (short) );
+	
+	for ( int y = top;  y <= bottom;  ++y )
+	{
+		const int cur  = y & 1;
+		const int prev = cur ^ 1;
+		
+		n_edges[ cur ] = 0;
+		
+		if ( y < bottom )
+		{
+			row( y, edges[ cur ], &n_edges[ cur ] );
+		}
+		
+		edges[ cur  ][ n_edges[ cur  ] ] = Region_end;
+		edges[ prev ][ n_edges[ prev ] ] = Region_end;
+		
+		if ( length + n_edges[ 0 ] + n_edges[ 1 ] + 3 > capacity )
+		{
+			capacity *= 2;
+			
+			extent = (short*) realloc( extent, capacity * sizeof (short) );
+		}
+		
+		const short* p = edges[ prev ];
+		const short* q = edges[ cur  ];
+		
+		const size_t line = length;
+		
+		extent[ length++ ] = y;
+		
+		while ( *p != Region_end  ||  *q != Region_end )
+		{
+			if ( *p < *q )
+			{
+				extent[ length++ ] = *p++;
+			}
+			else if ( *q < *p )
+			{
+				extent[ length++ ] = *q++;
+			}
+			else
+			{
+				++p;
+				++q;
+			}
+		}
+		
+		if ( length == line + 1 )
+		{
+			--length;  // no change
+		}
+		else
+		{
+			extent[ length++ ] = Region_end;
+		}
+	}
+	
+	extent[ length++ ] = Region_end;
+	
+	return extent;
+}
+
+static int isqrt( int n )
+{
+	int x = 0;
+	
+	while ( (x + 1) * (x + 1) <= n )
+	{
+		++x;
+	}
+	
+	return x;
+}
+
+const int radius = 4000;
+
+static int the_disk_dh;
+
+static void disk_row( int y, short* edges, int* n )
+{
+	const int w = isqrt( radius * radius - y * y );
+	
+	if ( w > 0 )
+	{
+		edges[ (*n)++ ] = the_disk_dh - w;
+		edges[ (*n)++ ] = the_disk_dh + w;
+	}
+}
+
+static void disk_a_row( int y, short* edges, int* n )
+{
+	the_disk_dh = 0;
+	
+	disk_row( y, edges, n );
+}
+
+static void disk_b_row( int y, short* edges, int* n )
+{
+	the_disk_dh = 1500;
+	
+	disk_row( y - 1000, edges, n );
+}
+
+static void comb_row( int y, short* edges, int* n )
+{
+	for ( int i = 0;  i < 200;  ++i )
+	{
+		edges[ (*n)++ ] = i * 40;
+		edges[ (*n)++ ] = i * 40 + 20;
+	}
+}
+
+static void stripes_row( int y, short* edges, int* n )
+{
+	if ( y & 2 )
+	{
+		edges[ (*n)++ ] = 10;
+		edges[ (*n)++ ] = 7990;
+	}
+}
+
+static void screen_disk_row( int y, short* edges, int* n )
+{
+	const int r = 160;
+	const int dy = y - 171;
+	
+	const int w = isqrt( r * r - dy * dy );
+	
+	if ( w > 0 )
+	{
+		edges[ (*n)++ ] = 256 - w;
+		edges[ (*n)++ ] = 256 + w;
+	}
+}
+
+static double seconds( clock_t t )
+{
+	return double( t ) / CLOCKS_PER_SEC;
+}
+
+static void bench( const char*           name,
+                   quickdraw::region_op  op,
+                   const short*          a,
+                   const short*          b,
+                   int                   n_iterations )
+{
+	const quickdraw::region_geometry_t g_a = quickdraw::region_geometry( a );
+	const quickdraw::region_geometry_t g_b = quickdraw::region_geometry( b );
+	
+	const size_t scratch_size = quickdraw::region_op_scratch_size( g_a, g_b );
+	
+	short* scratch = (short*) malloc( scratch_size * sizeof (short) );
+	
+	const size_t size = quickdraw::combine_regions( op, a, b, NULL, scratch );
+	
+	short* r = (short*) malloc( size * sizeof (short) );
+	
+	const clock_t start = clock();
+	
+	for ( int i = 0;  i < n_iterations;  ++i )
+	{
+		quickdraw::combine_regions( op, a, b, r, scratch );
+	}
+	
+	const clock_t middle = clock();
+	
+	for ( int i = 0;  i < n_iterations;  ++i )
+	{
+		quickdraw::combine_regions( op, a, b, NULL, scratch );
+	}
+	
+	const clock_t end = clock();
+	
+	const quickdraw::region_geometry_t g_r = quickdraw::region_geometry( r );
+	
+	printf( "%-16s %6d lines, %5d max h;  %8.3f ms/op, %8.3f ms/sizing\n",
+	        name,
+	        g_r.n_v_coords,
+	        g_r.n_h_coords,
+	        seconds( middle - start ) * 1000 / n_iterations,
+	        seconds( end - middle   ) * 1000 / n_iterations );
+	
+	free( r );
+	free( scratch );
+}
+
+static void bench_xor_region( const char*   name,
+                              const short*  a,
+                              const short*  b,
+                              int           n_iterations )
+{
+	const quickdraw::region_geometry_t g_a = quickdraw::region_geometry( a );
+	const quickdraw::region_geometry_t g_b = quickdraw::region_geometry( b );
+	
+	const size_t max_size = (g_a.n_v_coords + g_b.n_v_coords)
+	                      * (g_a.n_h_coords + g_b.n_h_coords + 2) + 1;
+	
+	short* r = (short*) malloc( max_size * sizeof (short) );
+	
+	const clock_t start = clock();
+	
+	for ( int i = 0;  i < n_iterations;  ++i )
+	{
+		quickdraw::xor_region( a, b, r );
+	}
+	
+	const clock_t end = clock();
+	
+	printf( "%-16s %36s %8.3f ms/op\n",
+	        name,
+	        "",
+	        seconds( end - start ) * 1000 / n_iterations );
+	
+	free( r );
+}
+
+static void bench_draw( const char*           name,
+                        quickdraw::raster_op  op,
+                        const short*          extent,
+                        int                   n_iterations )
+{
+	const quickdraw::region_geometry_t g = quickdraw::region_geometry( extent );
+	
+	const size_t scratch_size = quickdraw::draw_region_scratch_size( g );
+	
+	short* scratch = (short*) malloc( scratch_size * sizeof (short) );
+	
+	const long stride = 512 / 8;
+	
+	void* screen = calloc( 342, stride );
+	void* buffer = calloc( 342, stride );
+	
+	const quickdraw::bitmap_t bits = { screen, stride, { 0, 0, 342, 512 } };
+	
+	n_iterations *= 100;
+	
+	const clock_t start = clock();
+	
+	for ( int i = 0;  i < n_iterations;  ++i )
+	{
+		quickdraw::draw_region( extent, op, bits, buffer, scratch );
+	}
+	
+	const clock_t end = clock();
+	
+	printf( "%-16s %36s %8.3f us/op\n",
+	        name,
+	        "",
+	        seconds( end - start ) * 1000000 / n_iterations );
+	
+	free( buffer );
+	free( screen );
+	free( scratch );
+}
+
+int main( int argc, char** argv )
+{
+	const int n = argc > 1 ? atoi( argv[ 1 ] ) : 20;
+	
+	short* disk_a  = make_region( -radius,        radius,        &disk_a_row  );
+	short* disk_b  = make_region( -radius + 1000, radius + 1000, &disk_b_row  );
+	short* comb    = make_region( 0,              8000,          &comb_row    );
+	short* stripes = make_region( 0,              8000,          &stripes_row );
+	short* screen  = make_region( 171 - 160,      171 + 160,     &screen_disk_row );
+	
+	bench( "disks union",    quickdraw::region_op_union, disk_a, disk_b, n );
+	bench( "disks sect",     quickdraw::region_op_sect,  disk_a, disk_b, n );
+	bench( "disks diff",     quickdraw::region_op_diff,  disk_a, disk_b, n );
+	bench( "disks xor",      quickdraw::region_op_xor,   disk_a, disk_b, n );
+	
+	bench_xor_region( "disks xor_region", disk_a, disk_b, n );
+	
+	bench( "lattice union",  quickdraw::region_op_union, comb, stripes, n );
+	bench( "lattice sect",   quickdraw::region_op_sect,  comb, stripes, n );
+	bench( "lattice diff",   quickdraw::region_op_diff,  comb, stripes, n );
+	bench( "lattice xor",    quickdraw::region_op_xor,   comb, stripes, n );
+	
+	bench_xor_region( "lattice xor_region", comb, stripes, n );
+	
+	bench_draw( "draw disk paint",  quickdraw::raster_paint,  screen, n );
+	bench_draw( "draw disk invert", quickdraw::raster_invert, screen, n );
+	bench_draw( "draw disk copy",   quickdraw::raster_copy,   screen, n );
+	bench_draw( "draw comb invert", quickdraw::raster_invert, comb,   n );
+	
+	free( disk_a  );
+	free( disk_b  );
+	free( comb    );
+	free( stripes );
+	free( screen  );
+	
+	return 0;
+}
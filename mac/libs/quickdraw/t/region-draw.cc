@@ -0,0 +1,298 @@
+/*
+	region-draw.cc
+	--------------
+*/
+
+// Standard C
+#include <string.h>
+
+// quickdraw
+#include "qd/draw_region.hh"
+#include "qd/region_detail.hh"
+#include "qd/regions.hh"
+
+// tap-out
+#include "tap/test.hh"
+
+
+#pragma exceptions off
+
+
+static const unsigned n_tests = 4 + 2 + 4 * 3;
+
+
+using quickdraw::raster_paint;
+using quickdraw::raster_erase;
+using quickdraw::raster_invert;
+using quickdraw::raster_copy;
+
+
+const short End = quickdraw::Region_end;
+
+
+// (2,1)-(8,16)
+
+static const short rgn_a[] =
+{
+	2,  1, 16,  End,
+	8,  1, 16,  End,
+	
+	End
+};
+
+// A ring:  (0,0)-(30,30) minus (10,10)-(20,20)
+
+static const short rgn_ring[] =
+{
+	0,   0,          30,  End,
+	10,     10, 20,       End,
+	20,     10, 20,       End,
+	30,  0,          30,  End,
+	
+	End
+};
+
+// Several spans per row, some wider than a word, some within one byte
+
+static const short rgn_bars[] =
+{
+	-5,  -40, -2,  3, 5,  9, 100,  131, 200,  End,
+	 7,                   9, 100,             End,
+	 9,  -40, -2,  3, 5,          131, 200,   End,
+	 
+	End
+};
+
+// Larger than any bitmap below
+
+static const short rgn_huge[] =
+{
+	-1000,  -1000, 1000,  End,
+	 1000,  -1000, 1000,  End,
+	 
+	End
+};
+
+const int n_rows = 12;
+const int stride = 26;  // not a multiple of the word size
+
+/*
+	Leave room on both sides for misaligning the bitmap, plus guard bytes
+	that must not be touched.
+*/
+
+const int margin = 16;
+
+struct test_bitmap
+{
+	quickdraw::bitmap_t  bits;
+	unsigned char        buffer[ margin + n_rows * stride + margin ];
+	
+	test_bitmap( int misalignment, short top, short left, unsigned char fill );
+	
+	unsigned char* base() const  { return (unsigned char*) bits.base; }
+	
+	bool get( short v, short h ) const;
+	
+	bool guards_intact( unsigned char fill ) const;
+};
+
+test_bitmap::test_bitmap( int misalignment, short top, short left, unsigned char fill )
+{
+	memset( buffer, fill, sizeof buffer );
+	
+	bits.base   = buffer + margin + misalignment;
+	bits.stride = stride;
+	
+	bits.bounds[ 0 ] = top;
+	bits.bounds[ 1 ] = left;
+	bits.bounds[ 2 ] = top  + n_rows;
+	bits.bounds[ 3 ] = left + stride * 8 - 3;  // a partial byte at the end
+}
+
+bool test_bitmap::get( short v, short h ) const
+{
+	const int y = v - bits.bounds[ 0 ];
+	const int x = h - bits.bounds[ 1 ];
+	
+	return base()[ y * stride + x / 8 ] & (0x80 >> x % 8);
+}
+
+bool test_bitmap::guards_intact( unsigned char fill ) const
+{
+	const unsigned char* end = base() + n_rows * stride;
+	
+	for ( const unsigned char* p = buffer;  p < buffer + sizeof buffer;  ++p )
+	{
+		if ( p == base() )
+		{
+			p = end;
+		}
+		
+		if ( p < buffer + sizeof buffer  &&  *p != fill )
+		{
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+static bool in_region( const short* extent, short v, short h )
+{
+	// Count the inversion points at or left of h, in lines at or above v
+	
+	bool inside = false;
+	
+	while ( *extent != End  &&  *extent <= v )
+	{
+		++extent;
+		
+		while ( *extent != End )
+		{
+			inside ^= *extent++ <= h;
+		}
+		
+		++extent;
+	}
+	
+	return inside;
+}
+
+static short* scratch_for( const short* extent )
+{
+	static short scratch[ 256 ];
+	
+	const quickdraw::region_geometry_t g = quickdraw::region_geometry( extent );
+	
+	return quickdraw::draw_region_scratch_size( g ) <= 256 ? scratch : NULL;
+}
+
+static bool draws_correctly( quickdraw::raster_op  op,
+                             const short*          extent,
+                             int                   misalignment,
+                             short                 top,
+                             short                 left )
+{
+	const unsigned char fill = op == raster_paint ? 0x00
+	                         : op == raster_erase ? 0xFF
+	                         :                      0x5A;
+	
+	test_bitmap dst( misalignment, top, left, fill );
+	test_bitmap src( misalignment, top, left, 0xC3 );
+	test_bitmap old( misalignment, top, left, fill );
+	
+	short* scratch = scratch_for( extent );
+	
+	if ( scratch == NULL )
+	{
+		return false;
+	}
+	
+	quickdraw::draw_region( extent, op, dst.bits, src.bits.base, scratch );
+	
+	if ( !dst.guards_intact( fill ) )
+	{
+		return false;
+	}
+	
+	const short* bounds = dst.bits.bounds;
+	
+	for ( short v = bounds[ 0 ];  v < bounds[ 2 ];  ++v )
+	{
+		for ( short h = bounds[ 1 ];  h < bounds[ 3 ];  ++h )
+		{
+			bool expected = old.get( v, h );
+			
+			if ( in_region( extent, v, h ) )
+			{
+				switch ( op )
+				{
+					case raster_paint:   expected = true;             break;
+					case raster_erase:   expected = false;            break;
+					case raster_invert:  expected = !expected;        break;
+					case raster_copy:    expected = src.get( v, h );  break;
+				}
+			}
+			
+			if ( dst.get( v, h ) != expected )
+			{
+				return false;
+			}
+		}
+		
+		// Pixels past the right bound are untouched
+		
+		for ( short h = bounds[ 3 ];  h < bounds[ 1 ] + stride * 8;  ++h )
+		{
+			if ( dst.get( v, h ) != old.get( v, h ) )
+			{
+				return false;
+			}
+		}
+	}
+	
+	return true;
+}
+
+static bool draws_correctly( quickdraw::raster_op op, const short* extent )
+{
+	for ( int misalignment = 0;  misalignment < 8;  ++misalignment )
+	{
+		for ( short top = -6;  top <= 6;  top += 3 )
+		{
+			for ( short left = -9;  left <= 9;  ++left )
+			{
+				if ( !draws_correctly( op, extent, misalignment, top, left ) )
+				{
+					return false;
+				}
+			}
+		}
+	}
+	
+	return true;
+}
+
+static void simple()
+{
+	test_bitmap dst( 0, 0, 0, 0x00 );
+	
+	quickdraw::draw_region( rgn_a, raster_paint, dst.bits, NULL, scratch_for( rgn_a ) );
+	
+	const unsigned char blank[ stride ] = { 0 };
+	const unsigned char row_a[ stride ] = { 0x7F, 0xFF };
+	
+	EXPECT_CMP( dst.base() + 1 * stride, stride, blank, stride );
+	EXPECT_CMP( dst.base() + 2 * stride, stride, row_a, stride );
+	EXPECT_CMP( dst.base() + 7 * stride, stride, row_a, stride );
+	EXPECT_CMP( dst.base() + 8 * stride, stride, blank, stride );
+}
+
+static void clipping()
+{
+	EXPECT( draws_correctly( raster_paint,  rgn_huge ) );
+	EXPECT( draws_correctly( raster_invert, rgn_huge ) );
+}
+
+static void ops( quickdraw::raster_op op )
+{
+	EXPECT( draws_correctly( op, rgn_a    ) );
+	EXPECT( draws_correctly( op, rgn_ring ) );
+	EXPECT( draws_correctly( op, rgn_bars ) );
+}
+
+int main( int argc, char** argv )
+{
+	tap::start( "region-draw", n_tests );
+	
+	simple();
+	clipping();
+	
+	ops( raster_paint  );
+	ops( raster_erase  );
+	ops( raster_invert );
+	ops( raster_copy   );
+	
+	return 0;
+}
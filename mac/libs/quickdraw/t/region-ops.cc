@@ -0,0 +1,198 @@
+/*
+	region-ops.cc
+	-------------
+*/
+
+// quickdraw
+#include "qd/combine_regions.hh"
+#include "qd/region_detail.hh"
+#include "qd/regions.hh"
+
+// tap-out
+#include "tap/test.hh"
+
+
+#pragma exceptions off
+
+
+static const unsigned n_tests = 4 + 7 + 7;
+
+
+using quickdraw::region_op_union;
+using quickdraw::region_op_sect;
+using quickdraw::region_op_diff;
+using quickdraw::region_op_xor;
+
+
+const short End = quickdraw::Region_end;
+
+
+static const short rgn_empty[] =
+{
+	End
+};
+
+// Two overlapping rectangles:  (2,1)-(8,16) and (5,4)-(12,64)
+
+static const short rgn_a[] =
+{
+	2,  1, 16,  End,
+	8,  1, 16,  End,
+	
+	End
+};
+
+static const short rgn_b[] =
+{
+	5,   4, 64,  End,
+	12,  4, 64,  End,
+	
+	End
+};
+
+static const short rgn_a_union_b[] =
+{
+	2,   1, 16,          End,
+	5,       16, 64,     End,
+	8,   1,  4,          End,
+	12,      4,      64, End,
+	
+	End
+};
+
+static const short rgn_a_sect_b[] =
+{
+	5,  4, 16,  End,
+	8,  4, 16,  End,
+	
+	End
+};
+
+static const short rgn_a_diff_b[] =
+{
+	2,  1,     16,  End,
+	5,      4, 16,  End,
+	8,  1,  4,      End,
+	
+	End
+};
+
+static const short rgn_a_xor_b[] =
+{
+	2,   1, 16,      End,
+	5,   4,     64,  End,
+	8,   1, 16,      End,
+	12,  4,     64,  End,
+	
+	End
+};
+
+static const short rgn_b_diff_a[] =
+{
+	5,      16, 64,  End,
+	8,   4, 16,      End,
+	12,  4,     64,  End,
+	
+	End
+};
+
+// A ring:  (0,0)-(30,30) minus (10,10)-(20,20)
+
+static const short rgn_ring[] =
+{
+	0,   0,          30,  End,
+	10,     10, 20,       End,
+	20,     10, 20,       End,
+	30,  0,          30,  End,
+	
+	End
+};
+
+static const short rgn_hole[] =
+{
+	10,  10, 20,  End,
+	20,  10, 20,  End,
+	
+	End
+};
+
+static const short rgn_square[] =
+{
+	0,   0, 30,  End,
+	30,  0, 30,  End,
+	
+	End
+};
+
+static size_t combine( quickdraw::region_op  op,
+                       const short*          a,
+                       const short*          b,
+                       short*                r )
+{
+	short scratch[ 256 ];
+	
+	const quickdraw::region_geometry_t g_a = quickdraw::region_geometry( a );
+	const quickdraw::region_geometry_t g_b = quickdraw::region_geometry( b );
+	
+	if ( quickdraw::region_op_scratch_size( g_a, g_b ) > 256 )
+	{
+		return 0;
+	}
+	
+	const size_t size = quickdraw::combine_regions( op, a, b, NULL, scratch );
+	
+	if ( quickdraw::combine_regions( op, a, b, r, scratch ) != size )
+	{
+		return 0;
+	}
+	
+	return size;
+}
+
+#define EXPECT_RGN( op, a, b, c )  \
+	do {  \
+		short r[ 64 ];  \
+		const size_t n = combine( op, a, b, r );  \
+		EXPECT_CMP( r, n * sizeof (short), c, sizeof c );  \
+	} while ( 0 )
+
+static void empty()
+{
+	EXPECT_RGN( region_op_union, rgn_empty, rgn_a,     rgn_a     );
+	EXPECT_RGN( region_op_sect,  rgn_a,     rgn_empty, rgn_empty );
+	EXPECT_RGN( region_op_diff,  rgn_a,     rgn_empty, rgn_a     );
+	EXPECT_RGN( region_op_diff,  rgn_empty, rgn_a,     rgn_empty );
+}
+
+static void overlapping()
+{
+	EXPECT_RGN( region_op_union, rgn_a, rgn_b, rgn_a_union_b );
+	EXPECT_RGN( region_op_union, rgn_b, rgn_a, rgn_a_union_b );
+	EXPECT_RGN( region_op_sect,  rgn_a, rgn_b, rgn_a_sect_b  );
+	EXPECT_RGN( region_op_sect,  rgn_b, rgn_a, rgn_a_sect_b  );
+	EXPECT_RGN( region_op_diff,  rgn_a, rgn_b, rgn_a_diff_b  );
+	EXPECT_RGN( region_op_diff,  rgn_b, rgn_a, rgn_b_diff_a  );
+	EXPECT_RGN( region_op_xor,   rgn_a, rgn_b, rgn_a_xor_b   );
+}
+
+static void nested()
+{
+	EXPECT_RGN( region_op_diff,  rgn_square, rgn_hole, rgn_ring   );
+	EXPECT_RGN( region_op_union, rgn_ring,   rgn_hole, rgn_square );
+	EXPECT_RGN( region_op_sect,  rgn_ring,   rgn_hole, rgn_empty  );
+	EXPECT_RGN( region_op_sect,  rgn_ring,   rgn_ring, rgn_ring   );
+	EXPECT_RGN( region_op_union, rgn_ring,   rgn_ring, rgn_ring   );
+	EXPECT_RGN( region_op_diff,  rgn_ring,   rgn_ring, rgn_empty  );
+	EXPECT_RGN( region_op_xor,   rgn_square, rgn_ring, rgn_hole   );
+}
+
+int main( int argc, char** argv )
+{
+	tap::start( "region-ops", n_tests );
+	
+	empty();
+	overlapping();
+	nested();
+	
+	return 0;
+}
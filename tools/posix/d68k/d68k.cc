@@ -9,9 +9,13 @@
 // Standard C
 #include <ctype.h>
 #include <stdint.h>
-#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+// POSIX
+#include <unistd.h>
+#include <sys/stat.h>
+
 // iota
 #include "iota/endian.hh"
 #include "iota/strings.hh"
@@ -19,20 +23,31 @@
 // gear
 #include "gear/hexidecimal.hh"
 #include "gear/inscribe_decimal.hh"
+#include "gear/parse_decimal.hh"
 
 // plus
 #include "plus/var_string.hh"
 
 // poseven
 #include "poseven/functions/dup2.hh"
+#include "poseven/functions/fstat.hh"
+#include "poseven/functions/mmap.hh"
 #include "poseven/functions/open.hh"
 #include "poseven/functions/read.hh"
 #include "poseven/functions/write.hh"
 
+// v68k
+#include "v68k/decode.hh"
+#include "v68k/instruction.hh"
+
 // Orion
 #include "Orion/Main.hh"
 
 // d68k
+#include "descent.hh"
+#include "output.hh"
+#include "profile.hh"
+#include "thread_local.hh"
 #include "traps.hh"
 
 
@@ -55,12 +70,18 @@
 	Line D:  complete (ADD)
 	Line E:  complete (shift/rotate)
 	Line F:  F-Traps
+	
+	By default, the input is disassembled in a linear sweep.  --recursive
+	instead follows control flow from offset 0 (and any --entry=<hex>
+	offsets), on --jobs=<n> threads; see descent.hh.  --strict treats any
+	opcode that v68k doesn't implement as data.
 */
 
 
 namespace tool
 {
 	
+	namespace n = nucleus;
 	namespace p7 = poseven;
 	
 	
@@ -188,17 +209,32 @@ namespace tool
 	static bool globally_prefix_address         = true;
 	static bool globally_attach_target_comments = true;
 	
-	static uint32_t global_bytes_read = 0;
+	static bool globally_descending = false;  // recursive descent, not linear
+	static bool globally_strict     = false;  // only opcodes v68k implements
+	
+	/*
+		The input is read from stdin in a linear sweep, or from a mapped
+		image in recursive descent.  In the latter case several threads
+		decode at once, so the decoding state is per-thread (see
+		thread_local.hh).
+	*/
 	
-	static uint32_t global_pc = 0;
+	static const uint8_t* global_image = NULL;
+	static uint32_t       global_image_size = 0;
 	
-	static uint16_t global_last_op = 0;
+	static THREAD_LOCAL uint32_t global_bytes_read = 0;
 	
-	static uint32_t global_last_CMPI_operand = 0;
+	static THREAD_LOCAL uint32_t global_pc = 0;
 	
-	static uint32_t global_last_branch_target = 0;
-	static uint32_t global_last_pc_relative_target = 0;
-	static uint32_t global_successor_of_last_exit = 0;
+	static THREAD_LOCAL uint16_t global_last_op = 0;
+	
+	static THREAD_LOCAL uint32_t global_last_CMPI_operand = 0;
+	
+	static THREAD_LOCAL uint32_t global_last_branch_target = 0;
+	static THREAD_LOCAL uint32_t global_last_pc_relative_target = 0;
+	static THREAD_LOCAL uint32_t global_successor_of_last_exit = 0;
+	
+	static THREAD_LOCAL bool global_end_of_run = false;
 	
 	static std::vector< uint32_t > global_branch_targets;
 	
@@ -217,9 +253,9 @@ namespace tool
 		0x0002
 	};
 	
-	static int indexed_jump_state = 0;
+	static THREAD_LOCAL int indexed_jump_state = 0;
 	
-	static bool at_indexed_jump = false;
+	static THREAD_LOCAL bool at_indexed_jump = false;
 	
 	
 	static const uint16_t lswtch_code[] =
@@ -244,13 +280,29 @@ namespace tool
 		0x4ed1
 	};
 	
-	static int lswtch_state = 0;
+	static THREAD_LOCAL int lswtch_state = 0;
+	
+	static uint32_t lswtch_offset = 0;  // shared:  there's one __lswtch__
 	
-	static uint32_t lswtch_offset = 0;
 	
+	/*
+		The branch target, exit point, and entry point lists inform the
+		layout of a linear sweep.  In recursive descent, targets and entry
+		points are followed instead, and exit points end a run.
+	*/
+	
+	static inline void end_run()
+	{
+		global_end_of_run = true;
+	}
 	
 	static void add_branch_target( uint32_t address )
 	{
+		if ( globally_descending )
+		{
+			return;
+		}
+		
 		typedef std::vector< uint32_t >::iterator iterator;
 		
 		const iterator it = std::lower_bound( global_branch_targets.begin(),
@@ -267,6 +319,11 @@ namespace tool
 	
 	static bool check_branch_target( uint32_t address )
 	{
+		if ( globally_descending )
+		{
+			return false;
+		}
+		
 		typedef std::vector< uint32_t >::iterator iterator;
 		
 		const iterator it = std::lower_bound( global_branch_targets.begin(),
@@ -282,11 +339,25 @@ namespace tool
 	
 	static void add_exit_point( uint32_t address )
 	{
+		end_run();
+		
+		if ( globally_descending )
+		{
+			return;
+		}
+		
 		global_exit_points.push_back( address );
 	}
 	
 	static void add_entry_point( uint32_t address )
 	{
+		if ( globally_descending )
+		{
+			follow( address );
+			
+			return;
+		}
+		
 		// Add an entry point unless
 		// * it already exists
 		// * it lies between an entry point and an exit point (or eof)
@@ -325,7 +396,7 @@ namespace tool
 		}
 	}
 	
-	static uint16_t read_word( bool peeking = false )
+	static uint16_t word_from_stdin( bool peeking )
 	{
 		const size_t buffer_size = 4096;
 		
@@ -373,7 +444,30 @@ namespace tool
 		if ( !peeking )
 		{
 			p += sizeof (uint16_t);
-			
+		}
+		
+		return result;
+	}
+	
+	static uint16_t word_from_image()
+	{
+		if ( global_bytes_read >= global_image_size  ||  global_image_size - global_bytes_read < sizeof (uint16_t) )
+		{
+			throw end_of_file();
+		}
+		
+		const uint8_t* p = global_image + global_bytes_read;
+		
+		return p[ 0 ] << 8 | p[ 1 ];
+	}
+	
+	static uint16_t read_word( bool peeking = false )
+	{
+		const uint16_t result = global_image ? word_from_image()
+		                                     : word_from_stdin( peeking );
+		
+		if ( !peeking )
+		{
 			global_bytes_read += sizeof (uint16_t);
 			
 			if ( !at_indexed_jump )
@@ -455,8 +549,8 @@ namespace tool
 		return 0;
 	}
 	
-	static uint32_t global_last_absolute_addr_from_ea  = 0;
-	static uint32_t global_last_immediate_data_from_ea = 0;
+	static THREAD_LOCAL uint32_t global_last_absolute_addr_from_ea  = 0;
+	static THREAD_LOCAL uint32_t global_last_immediate_data_from_ea = 0;
 	
 	static plus::string read_ea( short mode_reg, short immediate_size )
 	{
@@ -698,7 +792,9 @@ namespace tool
 	
 	static void decode_default( uint16_t op )
 	{
-		printf( "%#.4x\n", op );
+		print( "%#.4x\n", op );
+		
+		end_run();
 	}
 	
 	
@@ -742,7 +838,7 @@ namespace tool
 		                                       : is_chk2 ? "CHK2"
 		                                                 : "CMP2";
 		
-		printf( "%s     ...\n", op_name );
+		print( "%s     ...\n", op_name );
 	}
 	
 	static void decode_Immediate( uint16_t op )
@@ -780,7 +876,7 @@ namespace tool
 		
 		if ( mode_reg == 0x3c )
 		{
-			printf( format, name, "", space, immediate_data, size_index ? "SR" : "CCR" );
+			print( format, name, "", space, immediate_data, size_index ? "SR" : "CCR" );
 		}
 		else
 		{
@@ -801,7 +897,7 @@ namespace tool
 			
 			const plus::string ea = read_ea( mode_reg, immediate_size );
 			
-			printf( format, name, qualifier, space, immediate_data, ea.c_str() );
+			print( format, name, qualifier, space, immediate_data, ea.c_str() );
 		}
 	}
 	
@@ -828,7 +924,7 @@ namespace tool
 		
 		const plus::string ea = read_ea( mode_reg, immediate_size );
 		
-		printf( format, data, ea.c_str() );
+		print( format, data, ea.c_str() );
 	}
 	
 #pragma mark -
@@ -894,9 +990,9 @@ namespace tool
 		const char* format = address ? "MOVEA.%c  %s,%s%s" "\n"
 		                             : "MOVE.%c   %s,%s%s" "\n";
 		
-		printf( format, size_codes[ size_index ], source.c_str(),
-		                                          dest.c_str(),
-		                                          comment.c_str() );
+		print( format, size_codes[ size_index ], source.c_str(),
+		                                         dest.c_str(),
+		                                         comment.c_str() );
 	}
 	
 #pragma mark -
@@ -936,7 +1032,7 @@ namespace tool
 		
 		const plus::string ea = read_ea( op & 0x3f, immediate_size );
 		
-		printf( format, name.string, size_codes[ size_index ], ea.c_str() );
+		print( format, name.string, size_codes[ size_index ], ea.c_str() );
 	}
 	
 	static const char* move_ccr_sr[] =
@@ -951,7 +1047,7 @@ namespace tool
 	{
 		if ( op == 0x4afc )
 		{
-			printf( "%s" "\n", "ILLEGAL" );
+			print( "%s" "\n", "ILLEGAL" );
 			
 			return;
 		}
@@ -965,7 +1061,7 @@ namespace tool
 		const char* format = tas ? "TAS.B    %s" "\n"
 		                         : move_ccr_sr[ op >> 9 & 0x3 ];
 		
-		printf( format, ea.c_str() );
+		print( format, ea.c_str() );
 	}
 	
 	static bool jump_breaks_routine( uint16_t mode_reg )
@@ -987,12 +1083,12 @@ namespace tool
 	
 	static void print_comment( uint32_t pc_relative_target )
 	{
-		printf( COMMENT "%#.6x", pc_relative_target );
+		print( COMMENT "%#.6x", pc_relative_target );
 	}
 	
 	static void decode_jump_table()
 	{
-		printf( "; indexed jump table\n" );
+		print( "; indexed jump table\n" );
 		
 		const uint32_t jump_table = global_bytes_read;
 		
@@ -1000,27 +1096,33 @@ namespace tool
 		
 		while ( n_jumps-- >= 0 )
 		{
-			printf( "; goto $%.6x\n", jump_table + read_word() );
+			const uint32_t target = jump_table + read_word();
+			
+			print( "; goto $%.6x\n", target );
+			
+			follow( target );
 		}
 	}
 	
 	static void decode_switch_table()
 	{
-		printf( "; __lswtch__ table\n" );
+		print( "; __lswtch__ table\n" );
 		
 		const uint32_t table_start = global_bytes_read;
 		
 		const uint32_t default_case = table_start + read_word();
 		
-		printf( "; default:  goto $%.6x\n", default_case );
+		print( "; default:  goto $%.6x\n", default_case );
+		
+		follow( default_case );
 		
 		const uint32_t min = read_long();
 		
-		printf( "; min: %#x, %d\n", min, min );
+		print( "; min: %#x, %d\n", min, min );
 		
 		const uint32_t max = read_long();
 		
-		printf( "; max: %#x, %d\n", max, max );
+		print( "; max: %#x, %d\n", max, max );
 		
 		int n = read_word();
 		
@@ -1034,8 +1136,12 @@ namespace tool
 			
 			target += offset;
 			
-			printf( "; case %#x, %d:  goto $%.6x\n", value, value, target );
+			print( "; case %#x, %d:  goto $%.6x\n", value, value, target );
+			
+			follow( target );
 		}
+		
+		end_run();  // __lswtch__ doesn't return
 	}
 	
 	static void decode_Jump( uint16_t op )
@@ -1050,11 +1156,16 @@ namespace tool
 		
 		const plus::string ea = read_ea( source, 0 );
 		
-		printf( format, op_name, ea.c_str() );
+		print( format, op_name, ea.c_str() );
 		
-		if ( globally_attach_target_comments  &&  source == 0x3a )
+		if ( source == 0x3a )
 		{
-			print_comment( global_last_pc_relative_target );
+			if ( globally_attach_target_comments )
+			{
+				print_comment( global_last_pc_relative_target );
+			}
+			
+			follow( global_last_pc_relative_target );
 		}
 		
 		const char* newlines = "\n\n";
@@ -1066,10 +1177,12 @@ namespace tool
 			++newlines;
 		}
 		
-		printf( "%s", newlines );
+		print( "%s", newlines );
 		
 		if ( jump )
 		{
+			end_run();
+			
 			if ( at_indexed_jump )
 			{
 				const bool fpu_selector = global_last_op == 0xc0fc;
@@ -1238,7 +1351,7 @@ namespace tool
 		
 		const char* format = "%s%c%s  %s,%sD%c" "\n";
 		
-		printf( format, basename, sign, qualifier, ea.c_str(), extra, '0' + d_base );
+		print( format, basename, sign, qualifier, ea.c_str(), extra, '0' + d_base );
 	}
 	
 	static void decode_MOVEM( uint16_t op )
@@ -1269,7 +1382,7 @@ namespace tool
 		const char* source =  restore ? ea.c_str() : buffer;
 		const char* dest   = !restore ? ea.c_str() : buffer;
 		
-		printf( format, size_code, source, dest );
+		print( format, size_code, source, dest );
 	}
 	
 	static const char* const control_registers_000[] =
@@ -1320,11 +1433,11 @@ namespace tool
 		
 		if ( to )
 		{
-			printf( "MOVEC    %c%d,%s" "\n", bank, reg, control_register_name );
+			print( "MOVEC    %c%d,%s" "\n", bank, reg, control_register_name );
 		}
 		else
 		{
-			printf( "MOVEC    %s,%c%d" "\n", control_register_name, bank, reg );
+			print( "MOVEC    %s,%c%d" "\n", control_register_name, bank, reg );
 		}
 	}
 	
@@ -1334,23 +1447,23 @@ namespace tool
 		{
 			case 0x00:
 			case 0x08:
-				printf( "TRAP     #%#x" "\n", op & 0xf );
+				print( "TRAP     #%#x" "\n", op & 0xf );
 				break;
 			
 			case 0x10:
-				printf( "LINK     A%d,#%d" "\n", op & 0x7, read_word_signed() );
+				print( "LINK     A%d,#%d" "\n", op & 0x7, read_word_signed() );
 				break;
 			
 			case 0x18:
-				printf( "UNLK     A%d" "\n", op & 0x7 );
+				print( "UNLK     A%d" "\n", op & 0x7 );
 				break;
 			
 			case 0x20:
-				printf( "MOVE     A%d,USP" "\n", op & 0x7 );
+				print( "MOVE     A%d,USP" "\n", op & 0x7 );
 				break;
 			
 			case 0x28:
-				printf( "MOVE     USP,A%d" "\n", op & 0x7 );
+				print( "MOVE     USP,A%d" "\n", op & 0x7 );
 				break;
 			
 			case 0x30:
@@ -1371,7 +1484,7 @@ namespace tool
 						arg = 0;  // not used, but needed to silence warning
 				}
 				
-				printf( name, arg );
+				print( name, arg );
 				
 				switch ( op & 0x7 )
 				{
@@ -1389,8 +1502,10 @@ namespace tool
 					case 4:  // RTD
 					case 7:  // RTR
 						global_successor_of_last_exit = global_bytes_read;
+						
+						end_run();
 					
-						printf( "\n" );
+						print( "\n" );
 						break;
 				}
 				
@@ -1414,7 +1529,7 @@ namespace tool
 	
 	static void decode_data( uint16_t op )
 	{
-		printf( "%.6x:  DC.W     %#.4x  ; %d bytes of data\n", global_bytes_read - 2, op, op );
+		print( "%.6x:  DC.W     %#.4x  ; %d bytes of data\n", global_bytes_read - 2, op, op );
 		
 		int n_words = (op + 1) / 2;
 		
@@ -1424,15 +1539,15 @@ namespace tool
 			
 			if ( n_words-- )
 			{
-				printf( "%.6x:  DC.L     %#.8x\n", bytes_read, read_long() );
+				print( "%.6x:  DC.L     %#.8x\n", bytes_read, read_long() );
 			}
 			else
 			{
-				printf( "%.6x:  DC.W     %#.4x\n", bytes_read, read_word() );
+				print( "%.6x:  DC.W     %#.4x\n", bytes_read, read_word() );
 			}
 		}
 		
-		printf( "\n" );
+		print( "\n" );
 	}
 	
 	static bool decoded_data( uint16_t op )
@@ -1458,7 +1573,7 @@ namespace tool
 		{
 			(void) read_word();
 			
-			printf( "DC.L     0x00000000\n\n" );
+			print( "DC.L     0x00000000\n\n" );
 		}
 		else if ( op != 0 )
 		{
@@ -1517,7 +1632,7 @@ namespace tool
 			out.append( register_operand, sizeof register_operand );
 		}
 		
-		printf( "%s\n", out.c_str() );
+		print( "%s\n", out.c_str() );
 	}
 	
 	static void decode_MOVES( uint16_t op )
@@ -1545,11 +1660,11 @@ namespace tool
 		
 		if ( to )
 		{
-			printf( "MOVES.%c  %c%d,%s\n", size_code, bank, reg, ea.c_str() );
+			print( "MOVES.%c  %c%d,%s\n", size_code, bank, reg, ea.c_str() );
 		}
 		else
 		{
-			printf( "MOVES.%c  %s,%c%d\n", size_code, ea.c_str(), bank, reg );
+			print( "MOVES.%c  %s,%c%d\n", size_code, ea.c_str(), bank, reg );
 		}
 	}
 	
@@ -1620,7 +1735,7 @@ namespace tool
 		
 		if ( (op & 0xfff8) == 0x49c0 )
 		{
-			printf( "EXTB.L   D%d" "\n", op & 0x7 );
+			print( "EXTB.L   D%d" "\n", op & 0x7 );
 			
 			return;
 		}
@@ -1636,14 +1751,14 @@ namespace tool
 			
 			const plus::string ea = read_ea( source, immediate_size );
 			
-			printf( format, ea.c_str(), op >> 9 & 0x7 );
+			print( format, ea.c_str(), op >> 9 & 0x7 );
 			
 			if ( globally_attach_target_comments  &&  lea  &&  source == 0x3a )
 			{
 				print_comment( global_last_pc_relative_target );
 			}
 			
-			printf( "\n" );
+			print( "\n" );
 			
 			return;
 		}
@@ -1676,7 +1791,7 @@ namespace tool
 				{
 					const plus::string ea = read_ea( source, 1 );
 					
-					printf( "NBCD.B   %s" "\n", ea.c_str() );
+					print( "NBCD.B   %s" "\n", ea.c_str() );
 					
 					break;
 				}
@@ -1685,7 +1800,7 @@ namespace tool
 					// SWAP, EXT.[WL]
 					const char* name = swap_ext[ op >> 6 & 0x3 ];
 					
-					printf( "%s    D%d" "\n", name, op & 0x7 );
+					print( "%s    D%d" "\n", name, op & 0x7 );
 					
 					break;
 				}
@@ -1696,7 +1811,7 @@ namespace tool
 						// BKPT
 						const uint16_t vector = op & 0x7;
 						
-						printf( "BKPT     #%d" "\n", vector );
+						print( "BKPT     #%d" "\n", vector );
 						
 						break;
 					}
@@ -1704,7 +1819,7 @@ namespace tool
 					// PEA
 					const plus::string ea = read_ea( source, 0 );
 					
-					printf( "PEA      %s" "\n", ea.c_str() );
+					print( "PEA      %s" "\n", ea.c_str() );
 					
 					break;
 				}
@@ -1766,20 +1881,22 @@ namespace tool
 				
 				const short displacement = read_word();
 				
-				printf( "DB%s     D%d,*%+d", ccode, op & 0x7, displacement + 2 );
+				print( "DB%s     D%d,*%+d", ccode, op & 0x7, displacement + 2 );
 				
 				if ( globally_attach_target_comments )
 				{
 					print_comment( global_pc + displacement );
 				}
 				
-				printf( "\n" );
+				print( "\n" );
+				
+				follow( global_pc + displacement );
 			}
 			else
 			{
 				const plus::string ea = read_ea( op & 0x3f, 1 );
 				
-				printf( "S%s.B    %s" "\n", ccode, ea.c_str() );
+				print( "S%s.B    %s" "\n", ccode, ea.c_str() );
 			}
 			
 			return;
@@ -1795,7 +1912,7 @@ namespace tool
 		
 		const plus::string ea = read_ea( op & 0x3f, sizes[ size_index ] );
 		
-		printf( format, name, size_codes[ size_index ], quick_data, ea.c_str() );
+		print( format, name, size_codes[ size_index ], quick_data, ea.c_str() );
 	}
 	
 	static void decode_Branch( uint16_t op )
@@ -1837,14 +1954,14 @@ namespace tool
 		
 		global_last_branch_target = target;
 		
-		printf( "B%s%s    *%+d", ccode, qualifier, arg + 2 );
+		print( "B%s%s    *%+d", ccode, qualifier, arg + 2 );
 		
 		if ( globally_attach_target_comments )
 		{
 			print_comment( target );
 		}
 		
-		printf( "\n" );
+		print( "\n" );
 		
 		if ( index != 1 )
 		{
@@ -1872,7 +1989,7 @@ namespace tool
 		
 		const int reg = op >> 9 & 0x7;
 		
-		printf( "MOVEQ    #%d,D%d" "\n", arg, reg );
+		print( "MOVEQ    #%d,D%d" "\n", arg, reg );
 	}
 	
 	static const char* sbcd_ops[] =
@@ -1895,7 +2012,7 @@ namespace tool
 			
 			const plus::string ea = read_ea( op & 0x3f, 2 );
 			
-			printf( "DIV%c.W   %s,D%d" "\n", sign_code, ea.c_str(), reg );
+			print( "DIV%c.W   %s,D%d" "\n", sign_code, ea.c_str(), reg );
 			
 			return;
 		}
@@ -1919,7 +2036,7 @@ namespace tool
 			
 			if ( format )
 			{
-				printf( format, op & 0x7, reg );
+				print( format, op & 0x7, reg );
 				
 				return;
 			}
@@ -1931,11 +2048,11 @@ namespace tool
 		
 		if ( op & 0x0100 )
 		{
-			printf( "OR.%c     D%d,%s" "\n", size_code, reg, ea.c_str() );
+			print( "OR.%c     D%d,%s" "\n", size_code, reg, ea.c_str() );
 		}
 		else
 		{
-			printf( "OR.%c     %s,D%d" "\n", size_code, ea.c_str(), reg );
+			print( "OR.%c     %s,D%d" "\n", size_code, ea.c_str(), reg );
 		}
 	}
 	
@@ -1954,7 +2071,7 @@ namespace tool
 		
 		if ( size_index != 3  &&  (op & 0x0138) == 0x0108 )
 		{
-			printf( "CMPM.%c   (A%d)+,(A%d)+" "\n", size_code, op & 0x7, reg );
+			print( "CMPM.%c   (A%d)+,(A%d)+" "\n", size_code, op & 0x7, reg );
 			
 			return;
 		}
@@ -1963,15 +2080,15 @@ namespace tool
 		
 		if ( size_index == 3 )
 		{
-			printf( "CMPA.%c   %s,A%d" "\n", size_code, ea.c_str(), reg );
+			print( "CMPA.%c   %s,A%d" "\n", size_code, ea.c_str(), reg );
 		}
 		else if ( op & 0x0100 )
 		{
-			printf( "EOR.%c    D%d,%s" "\n", size_code, reg, ea.c_str() );
+			print( "EOR.%c    D%d,%s" "\n", size_code, reg, ea.c_str() );
 		}
 		else
 		{
-			printf( "CMP.%c    %s,D%d" "\n", size_code, ea.c_str(), reg );
+			print( "CMP.%c    %s,D%d" "\n", size_code, ea.c_str(), reg );
 		}
 	}
 	
@@ -1999,7 +2116,7 @@ namespace tool
 			
 			const plus::string ea = read_ea( op & 0x3f, 2 );
 			
-			printf( "MUL%c.W   %s,D%d" "\n", sign_code, ea.c_str(), reg );
+			print( "MUL%c.W   %s,D%d" "\n", sign_code, ea.c_str(), reg );
 			
 			return;
 		}
@@ -2028,11 +2145,11 @@ namespace tool
 			{
 				if ( op_mode >> 1 )
 				{
-					printf( format, reg, op & 0x7 );
+					print( format, reg, op & 0x7 );
 				}
 				else
 				{
-					printf( format, op & 0x7, reg );
+					print( format, op & 0x7, reg );
 				}
 				
 				return;
@@ -2045,11 +2162,11 @@ namespace tool
 		
 		if ( op & 0x0100 )
 		{
-			printf( "AND.%c    D%d,%s" "\n", size_code, reg, ea.c_str() );
+			print( "AND.%c    D%d,%s" "\n", size_code, reg, ea.c_str() );
 		}
 		else
 		{
-			printf( "AND.%c    %s,D%d" "\n", size_code, ea.c_str(), reg );
+			print( "AND.%c    %s,D%d" "\n", size_code, ea.c_str(), reg );
 		}
 	}
 	
@@ -2074,10 +2191,10 @@ namespace tool
 		
 		if ( const bool addx = (op & 0x0130) == 0x0100  &&  !adda )
 		{
-			const char* format = op & 0x08 ? "%sX.%c   %s-(A%d),-(A%d)" "\n"
-			                               : "%sX.%c   %sD%d,D%d" "\n";
+			const char* format = op & 0x08 ? "%sX.%c   -(A%d),-(A%d)" "\n"
+			                               : "%sX.%c   D%d,D%d" "\n";
 			
-			printf( format, name, size_code, op & 0x7, reg );
+			print( format, name, size_code, op & 0x7, reg );
 			
 			return;
 		}
@@ -2088,18 +2205,18 @@ namespace tool
 		{
 			const char* format = "%sA.%c   %s,A%d" "\n";
 			
-			printf( format, name, size_code, ea.c_str(), reg );
+			print( format, name, size_code, ea.c_str(), reg );
 			
 			return;
 		}
 		
 		if ( const bool reversed = op & 0x0100 )
 		{
-			printf( "%s.%c    D%d,%s" "\n", name, size_code, reg, ea.c_str() );
+			print( "%s.%c    D%d,%s" "\n", name, size_code, reg, ea.c_str() );
 		}
 		else
 		{
-			printf( "%s.%c    %s,D%d" "\n", name, size_code, ea.c_str(), reg );
+			print( "%s.%c    %s,D%d" "\n", name, size_code, ea.c_str(), reg );
 		}
 	}
 	
@@ -2129,22 +2246,22 @@ namespace tool
 			++space;  // ROX
 		}
 		
-		printf( "%s%c", op_name, direction );
+		print( "%s%c", op_name, direction );
 		
 		if ( !uses_ea )
 		{
-			printf( ".%c", size_codes[ size_index ] );
+			print( ".%c", size_codes[ size_index ] );
 			
 			space += 2;
 		}
 		
-		printf( "%s", space );
+		print( "%s", space );
 		
 		if ( uses_ea )
 		{
 			const plus::string ea = read_ea( op & 0x3f, 0 );
 			
-			printf( "%s", ea.c_str() );
+			print( "%s", ea.c_str() );
 		}
 		else
 		{
@@ -2156,10 +2273,10 @@ namespace tool
 			
 			const uint16_t count = count_in_Dn ? source : get_quick_data( source );
 			
-			printf( format, count, op & 0x7 );
+			print( format, count, op & 0x7 );
 		}
 		
-		printf( "\n" );
+		print( "\n" );
 	}
 	
 	static void decode_A_line( uint16_t op )
@@ -2168,27 +2285,29 @@ namespace tool
 		
 		if ( name )
 		{
-			printf( "%s" "\n", name );
+			print( "%s" "\n", name );
 		}
 		else if ( op >= 0xA800  &&  (name = get_aTrap_name( op & ~0x0400 )) )
 		{
-			printf( "%s,AutoPop" "\n", name );
+			print( "%s,AutoPop" "\n", name );
 		}
 		else if ( op < 0xA800  &&  (name = get_aTrap_name( op & ~0x0600 )) )
 		{
 			const char* sys   = op & 0x0400 ? ",Sys"   : "";
 			const char* immed = op & 0X0200 ? ",Immed" : "";
 			
-			printf( "%s%s%s" "\n", name, sys, immed );
+			print( "%s%s%s" "\n", name, sys, immed );
 		}
 		else
 		{
-			decode_default( op );
+			print( "%#.4x\n", op );  // unnamed, but still a trap
 		}
 		
 		if ( op == 0xa9f4 )
 		{
 			global_successor_of_last_exit = global_bytes_read;
+			
+			end_run();  // _ExitToShell
 		}
 	}
 	
@@ -2202,7 +2321,7 @@ namespace tool
 			{
 				const short fp = extension >> 7 & 0x7;
 				
-				printf( "FMOVE.X  (A0),FP%d\n", fp );
+				print( "FMOVE.X  (A0),FP%d\n", fp );
 				
 				return;
 			}
@@ -2267,7 +2386,7 @@ namespace tool
 			return NULL;
 		}
 		
-		static char name[ 256 ];
+		static THREAD_LOCAL char name[ 256 ];
 		
 		char* p = name;
 		
@@ -2323,6 +2442,27 @@ namespace tool
 		return name;
 	}
 	
+	static void decode_name( const char* name )
+	{
+		print( "; ^^^ %s\n\n", name );
+		
+		decode_data( read_word() );
+	}
+	
+	static bool implemented_by_v68k( uint16_t word )
+	{
+		const uint16_t line = word >> 12;
+		
+		if ( line == 0xA  ||  line == 0xF )
+		{
+			return true;  // v68k traps these, so they're one-word instructions
+		}
+		
+		v68k::instruction storage = { 0 };
+		
+		return v68k::decode( word, storage );
+	}
+	
 	static void decode_one()
 	{
 		if ( global_bytes_read == global_successor_of_last_exit )
@@ -2333,9 +2473,7 @@ namespace tool
 			
 			if ( const char* name = get_name( word_0 ) )
 			{
-				printf( "; ^^^ %s\n\n", name );
-				
-				decode_data( read_word() );
+				decode_name( name );
 				
 				return;
 			}
@@ -2343,13 +2481,32 @@ namespace tool
 		
 		if ( globally_prefix_address )
 		{
-			printf( "%.6x:  ", global_bytes_read );
+			if ( profile_loaded() )
+			{
+				if ( uint32_t count = get_execution_count( global_bytes_read ) )
+				{
+					print( "%10u  ", count );
+				}
+				else
+				{
+					print( "%10s  ", "" );
+				}
+			}
+			
+			print( "%.6x:  ", global_bytes_read );
 		}
 		
 		const uint16_t word = read_word();
 		
 		global_pc = global_bytes_read;
 		
+		if ( globally_strict  &&  !implemented_by_v68k( word ) )
+		{
+			decode_default( word );
+			
+			return;
+		}
+		
 		if ( const decoder decode = mask_of_4_bits[ word >> 12 ] )
 		{
 			try
@@ -2362,11 +2519,11 @@ namespace tool
 			}
 			catch ( const illegal_instruction& )
 			{
-				printf( "Illegal instruction" "\n" );
+				print( "Illegal instruction" "\n" );
 			}
 			catch ( const illegal_operand& )
 			{
-				printf( "Illegal operand" "\n" );
+				print( "Illegal operand" "\n" );
 			}
 		}
 		
@@ -2380,28 +2537,276 @@ namespace tool
 		const uint16_t  id      = read_word();
 		const uint16_t  version = read_word();
 		
-		printf( "; Flags:          %d" "\n", flags   );
+		print( "; Flags:          %d" "\n", flags   );
 		
-		printf( "; Resource type:  '%c%c%c%c'" "\n", type >> 24,
-		                                             type >> 16,
-		                                             type >>  8,
-		                                             type );
+		print( "; Resource type:  '%c%c%c%c'" "\n", type >> 24,
+		                                            type >> 16,
+		                                            type >>  8,
+		                                            type );
 		
-		printf( "; Resource id:    %d" "\n", id      );
-		printf( "; Version:        %d" "\n", version );
+		print( "; Resource id:    %d" "\n", id      );
+		print( "; Version:        %d" "\n", version );
 	}
 	
-	int Main( int argc, char** argv )
+	static void print_trace_target( int16_t target, uint32_t value )
+	{
+		const char* kind = target < 8 ? "D" : "A";
+		
+		if ( target >= 0 )
+		{
+			print( "%10s" COMMENT "%s%d = 0x%.8x\n", "", kind, target & 7, value );
+		}
+		else if ( target == -1 )
+		{
+			print( "%10s" COMMENT "stored to 0x%.8x\n", "", value );
+		}
+	}
+	
+	static void decode_trace()
+	{
+		/*
+			Disassemble an instruction trace written by xv68k (the format
+			is described in v68k-utils' dump_trace.hh).  Each record holds
+			the instruction's address and code, and where its result went.
+		*/
+		
+		const uint32_t magic_0     = read_long();
+		const uint32_t magic_1     = read_long();
+		const uint32_t n_records   = read_long();
+		const uint32_t record_size = read_long();
+		
+		const uint32_t code_size = record_size - 10;
+		
+		if ( magic_0 != 0x7636386B  ||  magic_1 != 0x54726163  ||  record_size <= 10 )
+		{
+			p7::write( p7::stderr_fileno, STR_LEN( "d68k: Not a v68k trace file\n" ) );
+			
+			throw end_of_file();
+		}
+		
+		print( "; %u instructions traced\n\n", n_records );
+		
+		while ( true )
+		{
+			const uint32_t pc     = read_long();
+			const uint32_t value  = read_long();
+			const int16_t  target = read_word();
+			
+			global_bytes_read = pc;
+			
+			global_successor_of_last_exit = uint32_t( -1 );  // no MacsBug names
+			
+			decode_one();
+			
+			if ( global_bytes_read - pc > code_size )
+			{
+				p7::write( p7::stderr_fileno, STR_LEN( "d68k: Instruction overruns trace record\n" ) );
+				
+				throw end_of_file();
+			}
+			
+			while ( global_bytes_read - pc < code_size )
+			{
+				read_word();
+			}
+			
+			print_trace_target( target, value );
+		}
+	}
+	
+	static void decode_run( uint32_t address )
 	{
-		if ( argc > 1 )
+		/*
+			Decode from address until an instruction that doesn't continue
+			to the next (or one that's already been decoded), queueing any
+			branch targets along the way.
+		*/
+		
+		global_bytes_read = address;
+		
+		global_last_op = 0;
+		
+		global_successor_of_last_exit = uint32_t( -1 );
+		
+		indexed_jump_state = 0;
+		lswtch_state       = 0;
+		at_indexed_jump    = false;
+		
+		global_end_of_run = false;
+		
+		uint32_t pc = address;
+		
+		bool decoding = false;
+		
+		try
 		{
-			p7::dup2( p7::open( argv[1], p7::o_rdonly ), p7::stdin_fileno );
+			while ( !global_end_of_run  &&  (decoding = claim_instruction( pc )) )
+			{
+				decode_one();
+				
+				mark_decoded( pc, global_bytes_read - pc );
+				
+				decoding = false;
+				
+				pc = global_bytes_read;
+			}
+			
+			if ( pc == global_successor_of_last_exit )
+			{
+				// A routine's MacsBug name isn't reached, but it's not data.
+				
+				if ( const char* name = get_name( peek_word() ) )
+				{
+					if ( (decoding = claim_instruction( pc )) )
+					{
+						decode_name( name );
+						
+						mark_decoded( pc, global_bytes_read - pc );
+					}
+				}
+			}
+		}
+		catch ( const end_of_file& )
+		{
+			if ( decoding )
+			{
+				print( "\n" );
+				
+				mark_decoded( pc, global_bytes_read - pc );
+			}
 		}
+	}
+	
+	static void find_lswtch()
+	{
+		/*
+			A linear sweep recognizes __lswtch__ as it goes by, before any
+			calls to it.  In recursive descent there's no such order, so
+			search for it up front.
+		*/
+		
+		const uint32_t n_words = sizeof lswtch_code / sizeof lswtch_code[0];
+		
+		for ( uint32_t offset = 0;  offset + n_words * 2 <= global_image_size;  offset += 2 )
+		{
+			const uint8_t* p = global_image + offset;
+			
+			uint32_t i = 0;
+			
+			while ( i < n_words  &&  (p[ i * 2 ] << 8 | p[ i * 2 + 1 ]) == lswtch_code[ i ] )
+			{
+				++i;
+			}
+			
+			if ( i == n_words )
+			{
+				lswtch_offset = offset;
+				
+				return;
+			}
+		}
+	}
+	
+	static void disassemble_image( const struct stat& st, unsigned n_threads )
+	{
+		global_image      = (const uint8_t*) "";
+		global_image_size = st.st_size;
+		
+		n::owned< p7::mmap_t > image;
+		
+		if ( global_image_size != 0 )
+		{
+			image = p7::mmap( global_image_size,
+			                  p7::prot_read,
+			                  p7::map_private,
+			                  p7::stdin_fileno );
+			
+			global_image = (const uint8_t*) image.get().addr;
+		}
+		
+		find_lswtch();
+		
+		disassemble_recursively( global_image_size,
+		                         &global_entry_points[ 0 ],
+		                         global_entry_points.size(),
+		                         n_threads,
+		                         &decode_run );
+		
+		print( "\n" );
+	}
+	
+	int Main( int argc, char** argv )
+	{
+		char* const* args = argv + 1;
+		
+		bool tracing = false;
+		
+		unsigned n_threads = sysconf( _SC_NPROCESSORS_ONLN );
 		
 		global_entry_points.push_back( 0 );  // default entry point
 		
+		for ( ;  *args != NULL  &&  strncmp( *args, STR_LEN( "--" ) ) == 0;  ++args )
+		{
+			const char* arg = *args;
+			
+			if ( strncmp( arg, STR_LEN( "--profile=" ) ) == 0 )
+			{
+				read_profile( arg + STRLEN( "--profile=" ) );
+			}
+			else if ( strcmp( arg, "--trace" ) == 0 )
+			{
+				tracing = true;
+			}
+			else if ( strcmp( arg, "--recursive" ) == 0 )
+			{
+				globally_descending = true;
+			}
+			else if ( strcmp( arg, "--strict" ) == 0 )
+			{
+				globally_strict = true;
+			}
+			else if ( strncmp( arg, STR_LEN( "--jobs=" ) ) == 0 )
+			{
+				n_threads = gear::parse_unsigned_decimal( arg + STRLEN( "--jobs=" ) );
+			}
+			else if ( strncmp( arg, STR_LEN( "--entry=" ) ) == 0 )
+			{
+				const char* hex = arg + STRLEN( "--entry=" );
+				
+				global_entry_points.push_back( strtoul( hex, NULL, 16 ) );
+			}
+		}
+		
+		if ( *args != NULL )
+		{
+			p7::dup2( p7::open( *args, p7::o_rdonly ), p7::stdin_fileno );
+		}
+		
+		if ( globally_descending  &&  !tracing )
+		{
+			const struct stat st = p7::fstat( p7::stdin_fileno );
+			
+			if ( !S_ISREG( st.st_mode ) )
+			{
+				p7::write( p7::stderr_fileno, STR_LEN( "d68k: --recursive requires a file\n" ) );
+				
+				return 1;
+			}
+			
+			disassemble_image( st, n_threads );
+			
+			flush_output();
+			
+			return 0;
+		}
+		
 		try
 		{
+			if ( tracing )
+			{
+				decode_trace();
+			}
+			
 			decode_one();
 			
 			if ( global_last_branch_target == 12 )
@@ -2416,9 +2821,11 @@ namespace tool
 		}
 		catch ( const end_of_file& )
 		{
-			printf( "\n" );
+			print( "\n" );
 		}
 		
+		flush_output();
+		
 		return 0;
 	}
 	
@@ -0,0 +1,270 @@
+/*
+	descent.cc
+	----------
+*/
+
+#include "descent.hh"
+
+// Standard C++
+#include <algorithm>
+#include <vector>
+
+// Standard C
+#include <stdlib.h>
+
+// POSIX
+#include <pthread.h>
+
+// plus
+#include "plus/var_string.hh"
+
+// d68k
+#include "output.hh"
+#include "thread_local.hh"
+
+
+namespace tool
+{
+	
+	struct decoded_range
+	{
+		uint32_t  address;
+		uint32_t  size;
+		uint32_t  text_offset;
+		uint32_t  text_length;
+		unsigned  worker;
+	};
+	
+	static inline bool operator<( const decoded_range& a, const decoded_range& b )
+	{
+		return a.address < b.address;
+	}
+	
+	struct worker
+	{
+		plus::var_string              text;
+		std::vector< decoded_range >  ranges;
+		uint32_t                      marked;  // text already attributed
+		unsigned                      index;
+	};
+	
+	static uint32_t global_image_size;
+	
+	static uint32_t* global_claimed;  // one bit per word
+	
+	static run_decoder global_decode_run;
+	
+	static std::vector< uint32_t > global_queue;
+	
+	static unsigned global_n_busy;
+	
+	static pthread_mutex_t global_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+	static pthread_cond_t  global_queue_cond  = PTHREAD_COND_INITIALIZER;
+	
+	static THREAD_LOCAL worker* global_worker;
+	
+	
+	static inline bool in_image( uint32_t address )
+	{
+		return address < global_image_size  &&  (address & 1) == 0;
+	}
+	
+	static inline bool claimed( uint32_t address )
+	{
+		const uint32_t i = address >> 1;
+		
+		return global_claimed[ i >> 5 ] & 1 << (i & 31);
+	}
+	
+	bool claim_instruction( uint32_t address )
+	{
+		if ( !in_image( address ) )
+		{
+			return false;
+		}
+		
+		const uint32_t i   = address >> 1;
+		const uint32_t bit = 1 << (i & 31);
+		
+		return !(__sync_fetch_and_or( &global_claimed[ i >> 5 ], bit ) & bit);
+	}
+	
+	void follow( uint32_t address )
+	{
+		if ( global_worker == NULL  ||  !in_image( address )  ||  claimed( address ) )
+		{
+			return;
+		}
+		
+		pthread_mutex_lock( &global_queue_mutex );
+		
+		global_queue.push_back( address );
+		
+		pthread_cond_signal( &global_queue_cond );
+		
+		pthread_mutex_unlock( &global_queue_mutex );
+	}
+	
+	void mark_decoded( uint32_t address, uint32_t size )
+	{
+		worker& self = *global_worker;
+		
+		const uint32_t length = self.text.size() - self.marked;
+		
+		const decoded_range range = { address, size, self.marked, length, self.index };
+		
+		self.ranges.push_back( range );
+		
+		self.marked += length;
+	}
+	
+	static void* descent_worker( void* arg )
+	{
+		worker& self = *(worker*) arg;
+		
+		global_worker = &self;
+		
+		capture_output( &self.text );
+		
+		pthread_mutex_lock( &global_queue_mutex );
+		
+		for ( ;; )
+		{
+			while ( global_queue.empty()  &&  global_n_busy != 0 )
+			{
+				pthread_cond_wait( &global_queue_cond, &global_queue_mutex );
+			}
+			
+			if ( global_queue.empty() )
+			{
+				break;  // nothing queued, and nothing running to queue more
+			}
+			
+			const uint32_t address = global_queue.back();
+			
+			global_queue.pop_back();
+			
+			++global_n_busy;
+			
+			pthread_mutex_unlock( &global_queue_mutex );
+			
+			global_decode_run( address );
+			
+			pthread_mutex_lock( &global_queue_mutex );
+			
+			if ( --global_n_busy == 0  &&  global_queue.empty() )
+			{
+				pthread_cond_broadcast( &global_queue_cond );
+			}
+		}
+		
+		pthread_mutex_unlock( &global_queue_mutex );
+		
+		capture_output( NULL );
+		
+		global_worker = NULL;
+		
+		return NULL;
+	}
+	
+	static void print_unreached( uint32_t begin, uint32_t end )
+	{
+		print( "; %.6x-%.6x:  not reached (%u bytes)\n\n", begin, end - 1, end - begin );
+	}
+	
+	void disassemble_recursively( uint32_t         image_size,
+	                              const uint32_t*  entry_points,
+	                              unsigned         n_entry_points,
+	                              unsigned         n_threads,
+	                              run_decoder      decode_run )
+	{
+		global_image_size = image_size;
+		global_decode_run = decode_run;
+		
+		global_claimed = (uint32_t*) calloc( image_size / 64 + 1, sizeof (uint32_t) );
+		
+		if ( global_claimed == NULL )
+		{
+			abort();
+		}
+		
+		// The queue is a stack, so push the first entry point last.
+		
+		for ( unsigned i = n_entry_points;  i > 0;  --i )
+		{
+			if ( in_image( entry_points[ i - 1 ] ) )
+			{
+				global_queue.push_back( entry_points[ i - 1 ] );
+			}
+		}
+		
+		if ( n_threads == 0  ||  ! CONFIG_THREAD_LOCAL )
+		{
+			n_threads = 1;
+		}
+		
+		std::vector< worker > workers( n_threads );
+		
+		std::vector< pthread_t > threads( n_threads );
+		
+		for ( unsigned i = 0;  i < n_threads;  ++i )
+		{
+			workers[ i ].marked = 0;
+			workers[ i ].index  = i;
+			
+			if ( pthread_create( &threads[ i ], NULL, &descent_worker, &workers[ i ] ) != 0 )
+			{
+				abort();
+			}
+		}
+		
+		size_t n_ranges = 0;
+		
+		for ( unsigned i = 0;  i < n_threads;  ++i )
+		{
+			pthread_join( threads[ i ], NULL );
+			
+			n_ranges += workers[ i ].ranges.size();
+		}
+		
+		std::vector< decoded_range > ranges;
+		
+		ranges.reserve( n_ranges );
+		
+		for ( unsigned i = 0;  i < n_threads;  ++i )
+		{
+			ranges.insert( ranges.end(), workers[ i ].ranges.begin(),
+			                             workers[ i ].ranges.end() );
+		}
+		
+		std::sort( ranges.begin(), ranges.end() );
+		
+		uint32_t next = 0;
+		
+		for ( size_t i = 0;  i < n_ranges;  ++i )
+		{
+			const decoded_range& range = ranges[ i ];
+			
+			if ( range.address > next )
+			{
+				print_unreached( next, range.address );
+			}
+			
+			const plus::var_string& text = workers[ range.worker ].text;
+			
+			write_output( text.data() + range.text_offset, range.text_length );
+			
+			next = std::max( next, range.address + range.size );
+		}
+		
+		if ( next < image_size )
+		{
+			print_unreached( next, image_size );
+		}
+		
+		free( global_claimed );
+		
+		global_claimed = NULL;
+	}
+	
+}
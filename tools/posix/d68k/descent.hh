@@ -0,0 +1,44 @@
+/*
+	descent.hh
+	----------
+*/
+
+#ifndef D68K_DESCENT_HH
+#define D68K_DESCENT_HH
+
+// C99
+#include <stdint.h>
+
+
+namespace tool
+{
+	
+	/*
+		Recursive-descent disassembly.  Rather than sweeping linearly, a
+		pool of threads decodes runs of instructions starting at each entry
+		point and at every branch target discovered along the way, so that
+		data isn't mistaken for code.  Each thread captures its output; once
+		every reachable instruction has been decoded, the text is written to
+		stdout in address order, noting any ranges that weren't reached.
+	*/
+	
+	typedef void (*run_decoder)( uint32_t address );
+	
+	// Claim the instruction at address for decoding, unless already claimed.
+	bool claim_instruction( uint32_t address );
+	
+	// Queue a branch target for decoding.  (Ignored in a linear sweep.)
+	void follow( uint32_t address );
+	
+	// Attribute the output printed since the last call to this instruction.
+	void mark_decoded( uint32_t address, uint32_t size );
+	
+	void disassemble_recursively( uint32_t         image_size,
+	                              const uint32_t*  entry_points,
+	                              unsigned         n_entry_points,
+	                              unsigned         n_threads,
+	                              run_decoder      decode_run );
+	
+}
+
+#endif
@@ -0,0 +1,130 @@
+/*
+	output.cc
+	---------
+*/
+
+#include "output.hh"
+
+// Standard C
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// POSIX
+#include <unistd.h>
+
+// plus
+#include "plus/var_string.hh"
+
+// d68k
+#include "thread_local.hh"
+
+
+namespace tool
+{
+	
+	static char global_output_buffer[ 64 * 1024 ];
+	
+	static size_t global_output_length;
+	
+	static THREAD_LOCAL plus::var_string* global_captured_output;
+	
+	
+	static void write_all( const char* text, size_t length )
+	{
+		while ( length > 0 )
+		{
+			const ssize_t n_written = write( STDOUT_FILENO, text, length );
+			
+			if ( n_written <= 0 )
+			{
+				break;
+			}
+			
+			text   += n_written;
+			length -= n_written;
+		}
+	}
+	
+	void write_output( const char* text, size_t length )
+	{
+		if ( global_captured_output )
+		{
+			global_captured_output->append( text, length );
+			
+			return;
+		}
+		
+		if ( global_output_length + length > sizeof global_output_buffer )
+		{
+			flush_output();
+			
+			if ( length > sizeof global_output_buffer )
+			{
+				write_all( text, length );
+				
+				return;
+			}
+		}
+		
+		memcpy( global_output_buffer + global_output_length, text, length );
+		
+		global_output_length += length;
+	}
+	
+	void flush_output()
+	{
+		write_all( global_output_buffer, global_output_length );
+		
+		global_output_length = 0;
+	}
+	
+	plus::var_string* capture_output( plus::var_string* text )
+	{
+		plus::var_string* previous = global_captured_output;
+		
+		global_captured_output = text;
+		
+		return previous;
+	}
+	
+	void print( const char* format, ... )
+	{
+		char buffer[ 512 ];
+		
+		va_list args;
+		
+		va_start( args, format );
+		
+		int length = vsnprintf( buffer, sizeof buffer, format, args );
+		
+		va_end( args );
+		
+		if ( length < 0 )
+		{
+			return;
+		}
+		
+		if ( length < sizeof buffer )
+		{
+			write_output( buffer, length );
+			
+			return;
+		}
+		
+		// Too long for the buffer (e.g. a long MacsBug name); format it again.
+		
+		plus::var_string text;
+		
+		text.resize( length + 1 );
+		
+		va_start( args, format );
+		
+		vsnprintf( &text[ 0 ], length + 1, format, args );
+		
+		va_end( args );
+		
+		write_output( text.data(), length );
+	}
+	
+}
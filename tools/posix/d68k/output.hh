@@ -0,0 +1,40 @@
+/*
+	output.hh
+	---------
+*/
+
+#ifndef D68K_OUTPUT_HH
+#define D68K_OUTPUT_HH
+
+// Standard C
+#include <stddef.h>
+
+
+namespace plus
+{
+	
+	class var_string;
+	
+}
+
+namespace tool
+{
+	
+	/*
+		All disassembly goes through print().  Normally it accumulates in
+		a buffer that's written to stdout when full (and by flush_output()),
+		but a thread can capture its output in a string instead, so that
+		text decoded out of order can be emitted in address order later.
+	*/
+	
+	void print( const char* format, ... )  __attribute__(( format( printf, 1, 2 ) ));
+	
+	void write_output( const char* text, size_t length );
+	
+	void flush_output();
+	
+	plus::var_string* capture_output( plus::var_string* text );
+	
+}
+
+#endif
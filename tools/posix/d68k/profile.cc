@@ -0,0 +1,109 @@
+/*
+	profile.cc
+	----------
+*/
+
+#include "profile.hh"
+
+// Standard C++
+#include <map>
+
+// Standard C
+#include <string.h>
+
+// iota
+#include "iota/strings.hh"
+
+// gear
+#include "gear/hexidecimal.hh"
+#include "gear/parse_decimal.hh"
+
+// plus
+#include "plus/string.hh"
+
+// text-input
+#include "text_input/feed.hh"
+#include "text_input/get_line_from_feed.hh"
+
+// poseven
+#include "poseven/extras/fd_reader.hh"
+#include "poseven/functions/open.hh"
+#include "poseven/functions/read.hh"
+
+
+namespace tool
+{
+	
+	namespace p7 = poseven;
+	
+	/*
+		Reads the CSV profile written by `xv68k --profile`.  Only the
+		`code` and `pc` records matter here; execution counts are stored by
+		offset from the code address, which is how d68k numbers its input.
+	*/
+	
+	typedef std::map< uint32_t, uint32_t > count_map;
+	
+	static count_map global_execution_counts;
+	
+	static bool global_profile_loaded;
+	
+	
+	static inline bool begins_with( const plus::string& line, const char* s, size_t n )
+	{
+		return line.length() >= n  &&  memcmp( line.data(), s, n ) == 0;
+	}
+	
+	static void read_profile( p7::fd_t fd )
+	{
+		text_input::feed feed;
+		
+		p7::fd_reader reader( fd );
+		
+		uint32_t code_address = 0;
+		
+		while ( const plus::string* s = get_line_bare_from_feed( feed, reader ) )
+		{
+			const plus::string& line = *s;
+			
+			if ( begins_with( line, STR_LEN( "code," ) ) )
+			{
+				if ( line.length() >= STRLEN( "code,12345678" ) )
+				{
+					code_address = gear::decode_32_bit_hex( &line[ STRLEN( "code," ) ] );
+				}
+			}
+			else if ( begins_with( line, STR_LEN( "pc," ) ) )
+			{
+				if ( line.length() > STRLEN( "pc,12345678," ) )
+				{
+					const uint32_t pc = gear::decode_32_bit_hex( &line[ STRLEN( "pc," ) ] );
+					
+					const char* count = &line[ STRLEN( "pc,12345678," ) ];
+					
+					global_execution_counts[ pc - code_address ] = gear::parse_unsigned_decimal( count );
+				}
+			}
+		}
+		
+		global_profile_loaded = true;
+	}
+	
+	void read_profile( const char* path )
+	{
+		read_profile( p7::open( path, p7::o_rdonly ) );
+	}
+	
+	bool profile_loaded()
+	{
+		return global_profile_loaded;
+	}
+	
+	uint32_t get_execution_count( uint32_t offset )
+	{
+		count_map::const_iterator it = global_execution_counts.find( offset );
+		
+		return it != global_execution_counts.end() ? it->second : 0;
+	}
+	
+}
@@ -0,0 +1,24 @@
+/*
+	profile.hh
+	----------
+*/
+
+#ifndef D68K_PROFILE_HH
+#define D68K_PROFILE_HH
+
+// C99
+#include <stdint.h>
+
+
+namespace tool
+{
+	
+	void read_profile( const char* path );
+	
+	bool profile_loaded();
+	
+	uint32_t get_execution_count( uint32_t offset );
+	
+}
+
+#endif
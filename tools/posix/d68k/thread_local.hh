@@ -0,0 +1,23 @@
+/*
+	thread_local.hh
+	---------------
+*/
+
+#ifndef D68K_THREADLOCAL_HH
+#define D68K_THREADLOCAL_HH
+
+/*
+	Recursive descent decodes on several threads, each with its own copy
+	of the decoder's state.  Apple's GCC has no thread-local storage, so
+	there the state is shared and the descent runs on a single thread.
+*/
+
+#if defined( __clang__ )  ||  (defined( __GNUC__ )  &&  !defined( __APPLE__ ))
+	#define THREAD_LOCAL  __thread
+	#define CONFIG_THREAD_LOCAL  1
+#else
+	#define THREAD_LOCAL  /**/
+	#define CONFIG_THREAD_LOCAL  0
+#endif
+
+#endif
@@ -0,0 +1,407 @@
+/*
+	batch.cc
+	--------
+*/
+
+#include "batch.hh"
+
+// Standard C
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// POSIX
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// gear
+#include "gear/inscribe_decimal.hh"
+
+
+#pragma exceptions off
+
+
+#define STR_LEN( s )  "" s, (sizeof s - 1)
+
+
+/*
+	Batch mode
+	----------
+	
+	The manifest lists one program per line:  the code file followed by
+	its arguments, separated by spaces or tabs (there's no quoting).
+	Blank lines and lines starting with '#' are ignored.
+	
+	Each program runs in its own emulator on one of a pool of worker
+	threads.  Guest stdin is /dev/null, and guest stdout and stderr go to
+	a temporary file.  The results are written to stdout in manifest
+	order:  a line with the exit status (or the signal that stopped the
+	program), followed by its output.
+	
+	A program's result is reported (and its temporary file closed) as
+	soon as it and every program before it have finished, by whichever
+	worker finished last.  So that one slow program can't leave the rest
+	of the manifest holding open files, a worker won't start a program
+	more than max_unreported places past the oldest unreported one.
+*/
+
+const unsigned n_spare_outputs = 64;
+
+struct batch_queue
+{
+	batch_job*        jobs;
+	bool*             done;
+	unsigned          n_jobs;
+	unsigned          next;
+	unsigned          n_reported;
+	unsigned          max_unreported;
+	bool              reporting;
+	batch_job_runner  run;
+	pthread_mutex_t   mutex;
+	pthread_cond_t    reported;
+};
+
+static void report( const batch_job& job );
+
+static void report_finished_jobs( batch_queue& queue )
+{
+	// Called with the mutex locked
+	
+	if ( queue.reporting )
+	{
+		return;  // The reporting worker will see our job when it's ready.
+	}
+	
+	queue.reporting = true;
+	
+	while ( queue.n_reported < queue.n_jobs  &&  queue.done[ queue.n_reported ] )
+	{
+		const batch_job& job = queue.jobs[ queue.n_reported ];
+		
+		pthread_mutex_unlock( &queue.mutex );
+		
+		report( job );
+		
+		pthread_mutex_lock( &queue.mutex );
+		
+		++queue.n_reported;
+		
+		pthread_cond_broadcast( &queue.reported );
+	}
+	
+	queue.reporting = false;
+}
+
+static void start_job( batch_job& job, batch_job_runner run )
+{
+	FILE* output = tmpfile();
+	
+	if ( output != NULL )
+	{
+		job.output_fd = dup( fileno( output ) );
+		
+		job.error = job.output_fd < 0 ? errno : 0;
+		
+		fclose( output );
+	}
+	else
+	{
+		job.error = errno;
+	}
+	
+	if ( job.output_fd < 0 )
+	{
+		job.status = 1;
+		
+		return;
+	}
+	
+	run( job );
+}
+
+static void* batch_worker( void* arg )
+{
+	batch_queue& queue = *(batch_queue*) arg;
+	
+	for ( ;; )
+	{
+		pthread_mutex_lock( &queue.mutex );
+		
+		while ( queue.next < queue.n_jobs  &&
+		        queue.next - queue.n_reported >= queue.max_unreported )
+		{
+			pthread_cond_wait( &queue.reported, &queue.mutex );
+		}
+		
+		const unsigned i = queue.next;
+		
+		if ( i < queue.n_jobs )
+		{
+			++queue.next;
+		}
+		
+		pthread_mutex_unlock( &queue.mutex );
+		
+		if ( i >= queue.n_jobs )
+		{
+			break;
+		}
+		
+		start_job( queue.jobs[ i ], queue.run );
+		
+		pthread_mutex_lock( &queue.mutex );
+		
+		queue.done[ i ] = true;
+		
+		report_finished_jobs( queue );
+		
+		pthread_mutex_unlock( &queue.mutex );
+	}
+	
+	return NULL;
+}
+
+static char* read_manifest( const char* path, size_t* size )
+{
+	int fd = open( path, O_RDONLY );
+	
+	if ( fd < 0 )
+	{
+		return NULL;
+	}
+	
+	char* buffer = NULL;
+	
+	struct stat st;
+	
+	if ( fstat( fd, &st ) == 0 )
+	{
+		buffer = (char*) malloc( st.st_size + 1 );
+		
+		if ( buffer != NULL )
+		{
+			const ssize_t n_read = read( fd, buffer, st.st_size );
+			
+			if ( n_read < 0 )
+			{
+				free( buffer );
+				
+				buffer = NULL;
+			}
+			else
+			{
+				*size = n_read;
+				
+				buffer[ n_read ] = '\0';
+			}
+		}
+	}
+	
+	const int saved_errno = errno;
+	
+	close( fd );
+	
+	errno = saved_errno;
+	
+	return buffer;
+}
+
+static inline bool is_blank( char c )
+{
+	return c == ' '  ||  c == '\t'  ||  c == '\r';
+}
+
+static unsigned parse_manifest( char* p, char* end, batch_job* jobs, char** args )
+{
+	unsigned n = 0;
+	
+	while ( p < end )
+	{
+		char* eol = (char*) memchr( p, '\n', end - p );
+		
+		if ( eol == NULL )
+		{
+			eol = end;
+		}
+		
+		*eol = '\0';
+		
+		char** argv = args;
+		
+		while ( p < eol )
+		{
+			while ( p < eol  &&  is_blank( *p ) )
+			{
+				*p++ = '\0';
+			}
+			
+			if ( p < eol )
+			{
+				*args++ = p;
+				
+				while ( p < eol  &&  !is_blank( *p ) )
+				{
+					++p;
+				}
+			}
+		}
+		
+		if ( args > argv  &&  *argv[ 0 ] == '#' )
+		{
+			args = argv;  // comment
+		}
+		
+		if ( args > argv )
+		{
+			batch_job& job = jobs[ n++ ];
+			
+			job.argc = args - argv;
+			job.argv = argv;
+			
+			*args++ = NULL;
+		}
+		
+		p = eol + 1;
+	}
+	
+	return n;
+}
+
+static void report( const batch_job& job )
+{
+	const char* path = job.argv[ 0 ];
+	
+	const char* number = gear::inscribe_decimal( job.signo ? job.signo : job.status );
+	
+	write( STDOUT_FILENO, STR_LEN( "### " ) );
+	write( STDOUT_FILENO, path, strlen( path ) );
+	
+	if ( job.signo )
+	{
+		write( STDOUT_FILENO, STR_LEN( ": signal " ) );
+	}
+	else
+	{
+		write( STDOUT_FILENO, STR_LEN( ": exit " ) );
+	}
+	
+	write( STDOUT_FILENO, number, strlen( number ) );
+	write( STDOUT_FILENO, STR_LEN( "\n" ) );
+	
+	if ( job.output_fd < 0 )
+	{
+		const char* error = strerror( job.error );
+		
+		write( STDOUT_FILENO, STR_LEN( "xv68k: can't create output file: " ) );
+		write( STDOUT_FILENO, error, strlen( error ) );
+		write( STDOUT_FILENO, STR_LEN( "\n" ) );
+		
+		return;
+	}
+	
+	char buffer[ 4096 ];
+	
+	ssize_t n_read;
+	
+	char last = '\n';
+	
+	lseek( job.output_fd, 0, SEEK_SET );
+	
+	while ( (n_read = read( job.output_fd, buffer, sizeof buffer )) > 0 )
+	{
+		write( STDOUT_FILENO, buffer, n_read );
+		
+		last = buffer[ n_read - 1 ];
+	}
+	
+	// Keep the next header at the start of a line.
+	
+	if ( last != '\n' )
+	{
+		write( STDOUT_FILENO, STR_LEN( "\n" ) );
+	}
+	
+	close( job.output_fd );
+}
+
+int run_batch( const char* manifest, unsigned n_threads, batch_job_runner run )
+{
+	size_t size;
+	
+	char* text = read_manifest( manifest, &size );
+	
+	if ( text == NULL )
+	{
+		return -1;
+	}
+	
+	// Every job and argument takes at least two bytes, including the newline.
+	
+	const size_t max_jobs = size / 2 + 1;
+	
+	batch_job* jobs = (batch_job*) calloc( max_jobs, sizeof (batch_job) );
+	char**     args = (char**)     calloc( size + 2, sizeof (char*)     );
+	bool*      done = (bool*)      calloc( max_jobs, sizeof (bool)      );
+	
+	const int null_fd = open( "/dev/null", O_RDONLY );
+	
+	if ( jobs == NULL  ||  args == NULL  ||  done == NULL  ||  null_fd < 0 )
+	{
+		abort();
+	}
+	
+	const unsigned n_jobs = parse_manifest( text, text + size, jobs, args );
+	
+	for ( unsigned i = 0;  i < n_jobs;  ++i )
+	{
+		jobs[ i ].input_fd  = null_fd;
+		jobs[ i ].output_fd = -1;
+	}
+	
+	if ( n_threads > n_jobs )
+	{
+		n_threads = n_jobs;
+	}
+	
+	batch_queue queue = { jobs, done, n_jobs, 0, 0, n_threads + n_spare_outputs, false, run };
+	
+	pthread_mutex_init( &queue.mutex, NULL );
+	pthread_cond_init( &queue.reported, NULL );
+	
+	pthread_t* threads = (pthread_t*) alloca( n_threads * sizeof (pthread_t) );
+	
+	for ( unsigned i = 0;  i < n_threads;  ++i )
+	{
+		if ( pthread_create( &threads[ i ], NULL, &batch_worker, &queue ) != 0 )
+		{
+			abort();
+		}
+	}
+	
+	for ( unsigned i = 0;  i < n_threads;  ++i )
+	{
+		pthread_join( threads[ i ], NULL );
+	}
+	
+	pthread_cond_destroy( &queue.reported );
+	pthread_mutex_destroy( &queue.mutex );
+	
+	int n_failed = 0;
+	
+	for ( unsigned i = 0;  i < n_jobs;  ++i )
+	{
+		n_failed += jobs[ i ].signo  ||  jobs[ i ].status;
+	}
+	
+	close( null_fd );
+	
+	free( done );
+	free( args );
+	free( jobs );
+	free( text );
+	
+	return n_failed;
+}
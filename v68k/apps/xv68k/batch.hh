@@ -0,0 +1,32 @@
+/*
+	batch.hh
+	--------
+*/
+
+#ifndef BATCH_HH
+#define BATCH_HH
+
+
+struct batch_job
+{
+	int     argc;
+	char**  argv;  // code file and its arguments, NULL-terminated
+	
+	int  input_fd;   // for guest stdin
+	int  output_fd;  // for guest stdout and stderr
+	
+	int  status;  // exit status
+	int  signo;   // or the signal that stopped the program, if nonzero
+	int  error;   // errno, if output_fd couldn't be created
+};
+
+typedef void (*batch_job_runner)( batch_job& job );
+
+/*
+	Returns the number of programs that didn't exit with status zero,
+	or -1 (with errno set) if the manifest can't be read.
+*/
+
+int run_batch( const char* manifest, unsigned n_threads, batch_job_runner run );
+
+#endif
@@ -0,0 +1,137 @@
+/*
+	interrupts.cc
+	-------------
+*/
+
+#include "interrupts.hh"
+
+// Standard C
+#include <errno.h>
+#include <time.h>
+
+// POSIX
+#include <pthread.h>
+#include <sys/time.h>
+
+// v68k
+#include "v68k/emulator.hh"
+
+
+#pragma exceptions off
+
+
+const int VBL_level = 1;
+
+const long VBL_nsecs = 1000000000 / 60;
+
+static pthread_mutex_t the_interrupt_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  the_interrupt_cond  = PTHREAD_COND_INITIALIZER;
+
+static int the_highest_source_level;
+
+static void post_interrupt( v68k::emulator& emu, int level, uint8_t vector )
+{
+	/*
+		The emulator's post_interrupt() is thread-safe on its own; the lock
+		is only so that a sleeping wait_for_interrupt() can't miss the wakeup.
+	*/
+	
+	pthread_mutex_lock( &the_interrupt_mutex );
+	
+	emu.post_interrupt( level, vector );
+	
+	pthread_cond_broadcast( &the_interrupt_cond );
+	
+	pthread_mutex_unlock( &the_interrupt_mutex );
+}
+
+static void advance( timespec& ts, long nsecs )
+{
+	ts.tv_nsec += nsecs;
+	
+	if ( ts.tv_nsec >= 1000000000 )
+	{
+		ts.tv_nsec -= 1000000000;
+		
+		++ts.tv_sec;
+	}
+}
+
+static void* VBL_timer_start( void* arg )
+{
+	v68k::emulator& emu = *(v68k::emulator*) arg;
+	
+	timeval tv;
+	
+	gettimeofday( &tv, NULL );
+	
+	timespec next = { tv.tv_sec, tv.tv_usec * 1000 };
+	
+	/*
+		Nothing ever signals the timer's own condition variable, so this
+		is just a sleep until an absolute deadline.  Advancing the deadline
+		by a fixed period (rather than sleeping for one) keeps the ticks
+		from drifting.
+	*/
+	
+	pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+	pthread_cond_t  cond  = PTHREAD_COND_INITIALIZER;
+	
+	pthread_mutex_lock( &mutex );
+	
+	while ( true )
+	{
+		advance( next, VBL_nsecs );
+		
+		while ( pthread_cond_timedwait( &cond, &mutex, &next ) != ETIMEDOUT )
+		{
+			continue;
+		}
+		
+		post_interrupt( emu, VBL_level, 24 + VBL_level );
+	}
+	
+	return 0;  // NULL
+}
+
+int start_VBL_timer( v68k::emulator& emu )
+{
+	pthread_t thread;
+	
+	if ( int nok = pthread_create( &thread, NULL, &VBL_timer_start, &emu ) )
+	{
+		return nok;
+	}
+	
+	pthread_detach( thread );
+	
+	pthread_mutex_lock( &the_interrupt_mutex );
+	
+	if ( the_highest_source_level < VBL_level )
+	{
+		the_highest_source_level = VBL_level;
+	}
+	
+	pthread_mutex_unlock( &the_interrupt_mutex );
+	
+	return 0;
+}
+
+bool wait_for_interrupt( const v68k::emulator& emu )
+{
+	pthread_mutex_lock( &the_interrupt_mutex );
+	
+	const bool wakeable = the_highest_source_level > emu.sr.iii;
+	
+	if ( wakeable )
+	{
+		while ( !emu.interrupt_pending() )
+		{
+			pthread_cond_wait( &the_interrupt_cond, &the_interrupt_mutex );
+		}
+	}
+	
+	pthread_mutex_unlock( &the_interrupt_mutex );
+	
+	return wakeable;
+}
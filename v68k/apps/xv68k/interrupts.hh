@@ -0,0 +1,31 @@
+/*
+	interrupts.hh
+	-------------
+*/
+
+#ifndef INTERRUPTS_HH
+#define INTERRUPTS_HH
+
+
+namespace v68k
+{
+	class emulator;
+}
+
+/*
+	Host-side interrupt sources.  The VBL timer posts the Mac's level 1
+	(autovectored) vertical blanking interrupt 60 times per second from
+	its own thread.
+*/
+
+int start_VBL_timer( v68k::emulator& emu );
+
+/*
+	For a stopped processor, sleep until an interrupt is pending and
+	return true -- or return false at once if no running source posts a
+	level above the interrupt mask, since then nothing will wake it.
+*/
+
+bool wait_for_interrupt( const v68k::emulator& emu );
+
+#endif
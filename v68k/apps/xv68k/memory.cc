@@ -41,7 +41,7 @@ uint8_t* memory_manager::translate( uint32_t               addr,
 		return its_screen.translate( addr - screen_addr, length, fc, access );
 	}
 	
-	if ( addr >= v68k::alloc::start  &&  addr < v68k::alloc::limit )
+	if ( addr >= its_alloc_mem.window_start()  &&  addr < its_alloc_mem.window_limit() )
 	{
 		return its_alloc_mem.translate( addr, length, fc, access );
 	}
@@ -49,3 +49,35 @@ uint8_t* memory_manager::translate( uint32_t               addr,
 	return its_callback_memory.translate( addr, length, fc, access );
 }
 
+
+uint8_t* memory_manager::translate_page( uint32_t               page_addr,
+                                         v68k::function_code_t  fc,
+                                         v68k::memory_access_t  access ) const
+{
+	/*
+		Only plain RAM is cacheable.  Mac low memory globals are synthesized
+		per address, the screen needs update notifications, and callback
+		memory maps every address to the same few bytes.
+	*/
+	
+	if ( page_addr < 3 * 1024 )
+	{
+		if ( fc <= v68k::user_program_space  &&  access != v68k::mem_exec )
+		{
+			// This page includes Mac OS low memory
+			return 0;  // NULL
+		}
+	}
+	
+	if ( page_addr < its_low_mem_size )
+	{
+		return its_low_mem.translate_page( page_addr, fc, access );
+	}
+	
+	if ( page_addr >= its_alloc_mem.window_start()  &&  page_addr < its_alloc_mem.window_limit() )
+	{
+		return its_alloc_mem.translate_page( page_addr, fc, access );
+	}
+	
+	return 0;  // NULL
+}
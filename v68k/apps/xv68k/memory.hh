@@ -36,10 +36,18 @@ class memory_manager : public v68k::memory
 		memory_manager( uint8_t*  low_mem_base,
 		                uint32_t  low_mem_size );
 		
+		v68k::alloc::memory& alloc()  { return its_alloc_mem; }
+		
+		screen_memory& screen()  { return its_screen; }
+		
 		uint8_t* translate( uint32_t               addr,
 		                    uint32_t               length,
 		                    v68k::function_code_t  fc,
 		                    v68k::memory_access_t  access ) const;
+		
+		uint8_t* translate_page( uint32_t               page_addr,
+		                         v68k::function_code_t  fc,
+		                         v68k::memory_access_t  access ) const;
 };
 
 #endif
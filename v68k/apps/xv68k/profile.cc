@@ -0,0 +1,333 @@
+/*
+	profile.cc
+	----------
+*/
+
+#include "profile.hh"
+
+// Standard C
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+// POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+// gear
+#include "gear/hexidecimal.hh"
+#include "gear/inscribe_decimal.hh"
+
+// v68k
+#include "v68k/emulator.hh"
+
+// v68k-callbacks
+#include "callback/bridge.hh"
+
+
+#pragma exceptions off
+
+
+/*
+	Profile format
+	--------------
+	
+	The profile is a CSV file, one record per line, written at exit.
+	Addresses and trap words are hexadecimal, everything else decimal.
+	
+		code,<address>                      where the main program is loaded
+		pc,<address>,<count>                executions of the instruction
+		trap,<opcode>,<count>               A-line trap executions
+		syscall,<number>,<count>,<usecs>    bridge_call() system calls
+		callback,<number>,<count>,<usecs>   host callbacks (BKPT #3)
+	
+	The usecs column is wall-clock time spent in the host.  Lines starting
+	with '#' are comments.  d68k --profile=<file> annotates disassembly
+	with the pc counts.
+*/
+
+bool profiling;
+
+static int the_profile_fd = -1;
+
+static uint32_t the_code_address;
+
+/*
+	Execution counts are kept per instruction word in a two-level table
+	indexed by the high and low halves of the PC, so storage is only
+	allocated for the 64K segments that the guest actually executes in.
+*/
+
+const int segment_bits = 16;
+
+const uint32_t n_segments  = 1 << (32 - segment_bits);
+const uint32_t n_pc_counts = 1 << (segment_bits - 1);  // one per word
+
+typedef uint32_t pc_counts[ n_pc_counts ];
+
+static pc_counts** the_pc_counts;
+
+const uint32_t n_A_line_traps = 0x1000;
+
+static uint32_t the_trap_counts[ n_A_line_traps ];
+
+struct host_call_stats
+{
+	uint32_t      count;
+	profile_time  usecs;
+};
+
+const uint32_t n_syscalls = 0x10000;  // call numbers are 16-bit
+
+static host_call_stats* the_syscall_stats;
+
+static host_call_stats the_callback_stats[ v68k::callback::n ];
+
+
+int set_profile_file( const char* path, uint32_t code_address )
+{
+	int fd = open( path, O_WRONLY | O_CREAT | O_TRUNC, 0666 );
+	
+	if ( fd < 0 )
+	{
+		return errno;
+	}
+	
+	the_pc_counts     = (pc_counts**)       calloc( n_segments, sizeof (pc_counts*)      );
+	the_syscall_stats = (host_call_stats*)  calloc( n_syscalls, sizeof (host_call_stats) );
+	
+	if ( the_pc_counts == NULL  ||  the_syscall_stats == NULL )
+	{
+		close( fd );
+		
+		return ENOMEM;
+	}
+	
+	the_profile_fd   = fd;
+	the_code_address = code_address;
+	
+	profiling = true;
+	
+	return 0;
+}
+
+static void count_pc( uint32_t pc )
+{
+	pc_counts*& segment = the_pc_counts[ pc >> segment_bits ];
+	
+	if ( segment == NULL )
+	{
+		segment = (pc_counts*) calloc( 1, sizeof (pc_counts) );
+		
+		if ( segment == NULL )
+		{
+			return;
+		}
+	}
+	
+	++(*segment)[ (pc & (1 << segment_bits) - 1) >> 1 ];
+}
+
+bool profile_run( v68k::emulator& emu, unsigned long n_instructions )
+{
+	while ( n_instructions-- > 0 )
+	{
+		const uint32_t pc = emu.pc();
+		
+		count_pc( pc );
+		
+		uint16_t opcode;
+		
+		if ( emu.get_instruction_word( pc, opcode, emu.program_space() ) )
+		{
+			if ( (opcode & 0xF000) == 0xA000 )
+			{
+				++the_trap_counts[ opcode & 0x0FFF ];
+			}
+		}
+		
+		if ( !emu.step() )
+		{
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+profile_time profile_clock()
+{
+	if ( !profiling )
+	{
+		return 0;
+	}
+	
+	timeval tv;
+	
+	gettimeofday( &tv, NULL );
+	
+	return tv.tv_sec * profile_time( 1000000 ) + tv.tv_usec;
+}
+
+static inline void add_call( host_call_stats& stats, profile_time start )
+{
+	++stats.count;
+	
+	stats.usecs += profile_clock() - start;
+}
+
+void profile_syscall( uint32_t call_number, profile_time start )
+{
+	if ( profiling  &&  call_number < n_syscalls )
+	{
+		add_call( the_syscall_stats[ call_number ], start );
+	}
+}
+
+void profile_callback( uint32_t call_number, profile_time start )
+{
+	if ( profiling  &&  call_number < v68k::callback::n )
+	{
+		add_call( the_callback_stats[ call_number ], start );
+	}
+}
+
+
+class record_writer
+{
+	private:
+		int    its_fd;
+		char*  its_mark;
+		char   its_buffer[ 4096 ];
+		
+		// non-copyable
+		record_writer           ( const record_writer& );
+		record_writer& operator=( const record_writer& );
+	
+	public:
+		record_writer( int fd ) : its_fd( fd ), its_mark( its_buffer )
+		{
+		}
+		
+		void flush();
+		
+		void begin( const char* kind );
+		
+		void hex( uint32_t x, unsigned short n_digits );
+		
+		void decimal( profile_time x );
+		
+		void end()  { *its_mark++ = '\n'; }
+};
+
+void record_writer::flush()
+{
+	write( its_fd, its_buffer, its_mark - its_buffer );
+	
+	its_mark = its_buffer;
+}
+
+void record_writer::begin( const char* kind )
+{
+	const size_t max_record_size = 64;
+	
+	if ( its_mark + max_record_size > its_buffer + sizeof its_buffer )
+	{
+		flush();
+	}
+	
+	const size_t length = strlen( kind );
+	
+	memcpy( its_mark, kind, length );
+	
+	its_mark += length;
+}
+
+void record_writer::hex( uint32_t x, unsigned short n_digits )
+{
+	*its_mark++ = ',';
+	
+	gear::inscribe_n_hex_digits( its_mark, x, n_digits );
+	
+	its_mark += n_digits;
+}
+
+void record_writer::decimal( profile_time x )
+{
+	*its_mark++ = ',';
+	
+	its_mark = gear::inscribe_unsigned_r< 10 >( x, its_mark );
+}
+
+static void write_host_calls( record_writer&          out,
+                              const char*             kind,
+                              const host_call_stats*  stats,
+                              uint32_t                n )
+{
+	for ( uint32_t i = 0;  i < n;  ++i )
+	{
+		if ( stats[ i ].count != 0 )
+		{
+			out.begin  ( kind             );
+			out.decimal( i                );
+			out.decimal( stats[ i ].count );
+			out.decimal( stats[ i ].usecs );
+			out.end();
+		}
+	}
+}
+
+void write_profile()
+{
+	if ( !profiling )
+	{
+		return;
+	}
+	
+	profiling = false;  // Only write once, and stop collecting
+	
+	record_writer out( the_profile_fd );
+	
+	out.begin( "# xv68k profile" );
+	out.end();
+	
+	out.begin( "code" );
+	out.hex( the_code_address, 8 );
+	out.end();
+	
+	for ( uint32_t seg = 0;  seg < n_segments;  ++seg )
+	{
+		if ( const pc_counts* segment = the_pc_counts[ seg ] )
+		{
+			for ( uint32_t i = 0;  i < n_pc_counts;  ++i )
+			{
+				if ( const uint32_t count = (*segment)[ i ] )
+				{
+					out.begin( "pc" );
+					out.hex( seg << segment_bits | i << 1, 8 );
+					out.decimal( count );
+					out.end();
+				}
+			}
+		}
+	}
+	
+	for ( uint32_t i = 0;  i < n_A_line_traps;  ++i )
+	{
+		if ( const uint32_t count = the_trap_counts[ i ] )
+		{
+			out.begin( "trap" );
+			out.hex( 0xA000 | i, 4 );
+			out.decimal( count );
+			out.end();
+		}
+	}
+	
+	write_host_calls( out, "syscall",  the_syscall_stats,  n_syscalls        );
+	write_host_calls( out, "callback", the_callback_stats, v68k::callback::n );
+	
+	out.flush();
+	
+	close( the_profile_fd );
+}
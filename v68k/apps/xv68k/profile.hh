@@ -0,0 +1,34 @@
+/*
+	profile.hh
+	----------
+*/
+
+#ifndef PROFILE_HH
+#define PROFILE_HH
+
+// Standard C
+#include <stdint.h>
+
+
+namespace v68k
+{
+	class emulator;
+}
+
+typedef uint64_t profile_time;
+
+extern bool profiling;
+
+int set_profile_file( const char* path, uint32_t code_address );
+
+bool profile_run( v68k::emulator& emu, unsigned long n_instructions );
+
+profile_time profile_clock();
+
+void profile_syscall( uint32_t call_number, profile_time start );
+
+void profile_callback( uint32_t call_number, profile_time start );
+
+void write_profile();
+
+#endif
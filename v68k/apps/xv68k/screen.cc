@@ -7,20 +7,47 @@
 
 // POSIX
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/mman.h>
 
+// iota
+#include "iota/endian.hh"
+
 // xv68k
 #include "shared_memory.hh"
 
 
-static void* the_screen_buffer;
+screen_memory::screen_memory()
+:
+	its_buffer(),
+	its_notification_fd( -1 ),
+	its_dirty_top( screen_n_rows ),
+	its_dirty_bottom( 0 )
+{
+}
 
+inline void screen_memory::mark_dirty( uint32_t addr, uint32_t length ) const
+{
+	const uint32_t top    = addr / screen_rowBytes;
+	const uint32_t bottom = (addr + length - 1) / screen_rowBytes + 1;
+	
+	if ( top < its_dirty_top )
+	{
+		its_dirty_top = top;
+	}
+	
+	if ( bottom > its_dirty_bottom )
+	{
+		its_dirty_bottom = bottom;
+	}
+}
 
-int set_screen_backing_store_file( const char* path )
+int screen_memory::set_backing_store_file( const char* path )
 {
-	the_screen_buffer = open_shared_memory( path, screen_size );
+	its_buffer = open_shared_memory( path, screen_size );
 	
-	if ( the_screen_buffer == 0 )  // NULL
+	if ( its_buffer == 0 )  // NULL
 	{
 		return errno;
 	}
@@ -28,6 +55,57 @@ int set_screen_backing_store_file( const char* path )
 	return 0;
 }
 
+void screen_memory::set_notification_fd( int fd )
+{
+	fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+	
+	its_notification_fd = fd;
+}
+
+void screen_memory::notify_viewer( uint32_t top, uint32_t bottom ) const
+{
+	/*
+		Each notification is a pair of big-endian 16-bit integers:  the
+		first dirty row and the row after the last.  A viewer that falls
+		behind will find the pipe full; since it can always redraw the
+		whole screen, dropping a notification (EAGAIN) is harmless.
+	*/
+	
+	const uint16_t rows[ 2 ] =
+	{
+		iota::big_u16( top    ),
+		iota::big_u16( bottom ),
+	};
+	
+	write( its_notification_fd, rows, sizeof rows );
+}
+
+void screen_memory::flush()
+{
+	if ( its_dirty_top >= its_dirty_bottom )
+	{
+		return;
+	}
+	
+	const uint32_t top    = its_dirty_top;
+	const uint32_t bottom = its_dirty_bottom;
+	
+	its_dirty_top    = screen_n_rows;
+	its_dirty_bottom = 0;
+	
+	const long page_size = sysconf( _SC_PAGESIZE );
+	
+	const uint32_t begin = top    * screen_rowBytes & -page_size;
+	const uint32_t end   = bottom * screen_rowBytes;
+	
+	msync( (char*) its_buffer + begin, end - begin, MS_ASYNC );
+	
+	if ( its_notification_fd >= 0 )
+	{
+		notify_viewer( top, bottom );
+	}
+}
+
 uint8_t* screen_memory::translate( uint32_t               addr,
                                    uint32_t               length,
                                    v68k::function_code_t  fc,
@@ -38,7 +116,7 @@ uint8_t* screen_memory::translate( uint32_t               addr,
 		return 0;  // NULL
 	}
 	
-	if ( the_screen_buffer == 0 )  // NULL
+	if ( its_buffer == 0 )  // NULL
 	{
 		return 0;  // NULL
 	}
@@ -56,11 +134,11 @@ uint8_t* screen_memory::translate( uint32_t               addr,
 			return 0;  // NULL
 		}
 		
-		uint8_t* p = (uint8_t*) the_screen_buffer + addr;
+		uint8_t* p = (uint8_t*) its_buffer + addr;
 		
 		if ( access == v68k::mem_update )
 		{
-			msync( the_screen_buffer, screen_size, MS_SYNC );
+			mark_dirty( addr, length );
 		}
 		
 		return p;
@@ -14,12 +14,40 @@ const uint32_t screen_addr = 0x0001A700;
 
 const uint32_t screen_size = 21888;  // 512x342x1 / 8
 
+const uint32_t screen_rowBytes = 64;  // 512 / 8
 
-int set_screen_backing_store_file( const char* path );
+const uint32_t screen_n_rows = screen_size / screen_rowBytes;  // 342
+
+
+/*
+	Stores into the screen only mark the affected scanlines as dirty.
+	flush() (called periodically from the emulation loop) writes back the
+	dirty band in one msync() call and optionally tells a viewer which
+	rows changed.
+*/
 
 class screen_memory : public v68k::memory
 {
+	private:
+		void*  its_buffer;
+		int    its_notification_fd;
+		
+		mutable uint32_t  its_dirty_top;
+		mutable uint32_t  its_dirty_bottom;
+		
+		void mark_dirty( uint32_t addr, uint32_t length ) const;
+		
+		void notify_viewer( uint32_t top, uint32_t bottom ) const;
+	
 	public:
+		screen_memory();
+		
+		int set_backing_store_file( const char* path );
+		
+		void set_notification_fd( int fd );
+		
+		void flush();
+		
 		uint8_t* translate( uint32_t               addr,
 		                    uint32_t               length,
 		                    v68k::function_code_t  fc,
@@ -0,0 +1,348 @@
+/*
+	snapshot.cc
+	-----------
+*/
+
+#include "snapshot.hh"
+
+// Standard C
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+// POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// v68k
+#include "v68k/endian.hh"
+#include "v68k/state.hh"
+
+// v68k-alloc
+#include "v68k-alloc/memory.hh"
+
+
+#pragma exceptions off
+
+
+/*
+	Snapshot format
+	---------------
+	
+	A snapshot captures the machine after the trap tables are set up and
+	any modules are installed, so later runs can skip all of that.  It's
+	restored by mapping the file copy-on-write (extents directly into the
+	v68k::alloc arena), so the cost of a restore is a page fault per page
+	actually touched.
+	
+	Each section starts on a 64K boundary (the alloc page size, which is
+	at least the host page size) so it can be used in place:
+	
+		header        big-endian longwords, described below
+		low memory    low_mem_size bytes
+		extents       each block of v68k::alloc pages, in order
+	
+	Extents are followed by a one-page hole (which costs no disk space).
+	
+	The header is:
+	
+		'v68k', 'Snap', version, low_mem_size, SR, n_registers, n_extents,
+		registers[ n_registers ],
+		{ address, n_pages }[ n_extents ]
+*/
+
+using v68k::big_longword;
+using v68k::longword_from_big;
+
+using v68k::alloc::page_size;
+
+enum
+{
+	snapshot_magic_0 = 0x7636386B,  // 'v68k'
+	snapshot_magic_1 = 0x536E6170,  // 'Snap'
+	snapshot_version = 1,
+};
+
+enum
+{
+	header_magic_0,
+	header_magic_1,
+	header_version,
+	header_low_mem_size,
+	header_SR,
+	header_n_registers,
+	header_n_extents,
+	header_registers,
+};
+
+const uint32_t header_size = page_size;
+
+const uint32_t max_header_longs = header_size / sizeof (uint32_t);
+
+static const uint32_t* the_mapped_header;
+
+static off_t the_mapped_size;
+
+static int the_snapshot_fd = -1;
+
+
+static inline uint32_t section_size( uint32_t size )
+{
+	return (size + page_size - 1) & -page_size;
+}
+
+int save_snapshot( const char*                     path,
+                   const v68k::processor_state&    s,
+                   const v68k::alloc::memory&      alloc_mem,
+                   const uint8_t*                  low_mem,
+                   uint32_t                        low_mem_size )
+{
+	uint32_t* header = (uint32_t*) calloc( 1, header_size );
+	
+	if ( header == NULL )
+	{
+		return ENOMEM;
+	}
+	
+	uint32_t* h = header;
+	
+	*h++ = big_longword( snapshot_magic_0 );
+	*h++ = big_longword( snapshot_magic_1 );
+	*h++ = big_longword( snapshot_version );
+	*h++ = big_longword( low_mem_size     );
+	*h++ = big_longword( s.get_SR()       );
+	*h++ = big_longword( v68k::n_registers );
+	
+	uint32_t* n_extents = h++;
+	
+	for ( int i = 0;  i < v68k::n_registers;  ++i )
+	{
+		*h++ = big_longword( s.regs[ i ] );
+	}
+	
+	int fd = open( path, O_WRONLY | O_CREAT | O_TRUNC, 0666 );
+	
+	int nok = fd < 0;
+	
+	off_t offset = header_size;
+	
+	if ( !nok )
+	{
+		nok = pwrite( fd, low_mem, low_mem_size, offset ) != low_mem_size;
+		
+		offset += section_size( low_mem_size );
+	}
+	
+	uint32_t n = 0;
+	
+	uint32_t addr = 0;
+	uint32_t n_pages;
+	
+	while ( !nok  &&  (addr = alloc_mem.find_extent( addr, &n_pages )) )
+	{
+		if ( h + 2 > header + max_header_longs )
+		{
+			errno = E2BIG;
+			
+			nok = true;
+			break;
+		}
+		
+		*h++ = big_longword( addr    );
+		*h++ = big_longword( n_pages );
+		
+		++n;
+		
+		// Pages of a block needn't be contiguous in host memory.
+		
+		for ( uint32_t i = 0;  !nok  &&  i < n_pages;  ++i )
+		{
+			const uint8_t* p = alloc_mem.translate( addr,
+			                                        page_size,
+			                                        v68k::supervisor_data_space,
+			                                        v68k::mem_read );
+			
+			nok = pwrite( fd, p, page_size, offset ) != page_size;
+			
+			offset += page_size;
+			
+			addr += page_size;
+		}
+		
+		offset += page_size;
+	}
+	
+	*n_extents = big_longword( n );
+	
+	if ( !nok )
+	{
+		nok = pwrite( fd, header, header_size, 0 ) != header_size;
+	}
+	
+	const int saved_errno = errno;
+	
+	if ( fd >= 0 )
+	{
+		close( fd );
+	}
+	
+	free( header );
+	
+	return nok ? saved_errno : 0;
+}
+
+static bool place_extents( v68k::alloc::memory&  alloc_mem,
+                           const uint8_t*        base,
+                           int                   fd,
+                           off_t                 offset,
+                           off_t                 file_size )
+{
+	const uint32_t* header = (const uint32_t*) base;
+	
+	const uint32_t n_registers = longword_from_big( header[ header_n_registers ] );
+	const uint32_t n_extents   = longword_from_big( header[ header_n_extents   ] );
+	
+	const uint32_t* extent = header + header_registers + n_registers;
+	
+	if ( n_registers != v68k::n_registers  ||  n_extents > (max_header_longs - (extent - header)) / 2 )
+	{
+		return false;
+	}
+	
+	for ( uint32_t i = 0;  i < n_extents;  ++i )
+	{
+		const uint32_t addr    = longword_from_big( *extent++ );
+		const uint32_t n_pages = longword_from_big( *extent++ );
+		
+		const off_t size = off_t( n_pages ) * page_size;
+		
+		if ( offset + size > file_size )
+		{
+			return false;
+		}
+		
+		if ( !alloc_mem.allocate_n_pages_at( addr, n_pages ) )
+		{
+			return false;
+		}
+		
+		void* p = alloc_mem.translate( addr,
+		                               size,
+		                               v68k::supervisor_data_space,
+		                               v68k::mem_write );
+		
+		if ( mmap( p, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, offset ) == MAP_FAILED )
+		{
+			return false;
+		}
+		
+		offset += size + page_size;
+	}
+	
+	return true;
+}
+
+int map_snapshot( const char* path, uint8_t** low_mem, uint32_t low_mem_size )
+{
+	int fd = open( path, O_RDONLY );
+	
+	if ( fd < 0 )
+	{
+		return errno;
+	}
+	
+	struct stat st;
+	
+	void* addr = MAP_FAILED;
+	
+	if ( fstat( fd, &st ) == 0 )
+	{
+		if ( st.st_size < header_size + low_mem_size )
+		{
+			errno = EINVAL;
+		}
+		else
+		{
+			addr = mmap( NULL,
+			             st.st_size,
+			             PROT_READ | PROT_WRITE,
+			             MAP_PRIVATE,
+			             fd,
+			             0 );
+		}
+	}
+	
+	if ( addr == MAP_FAILED )
+	{
+		const int saved_errno = errno;
+		
+		close( fd );
+		
+		return saved_errno;
+	}
+	
+	const uint8_t* base = (const uint8_t*) addr;
+	
+	const uint32_t* header = (const uint32_t*) base;
+	
+	const off_t low_mem_offset = header_size;
+	
+	if ( longword_from_big( header[ header_magic_0      ] ) != snapshot_magic_0  ||
+	     longword_from_big( header[ header_magic_1      ] ) != snapshot_magic_1  ||
+	     longword_from_big( header[ header_version      ] ) != snapshot_version  ||
+	     longword_from_big( header[ header_low_mem_size ] ) != low_mem_size )
+	{
+		munmap( addr, st.st_size );
+		
+		close( fd );
+		
+		return EINVAL;
+	}
+	
+	// Keep the file open to map extents from it later.
+	
+	the_mapped_header = header;
+	the_mapped_size   = st.st_size;
+	the_snapshot_fd   = fd;
+	
+	*low_mem = (uint8_t*) base + low_mem_offset;
+	
+	return 0;
+}
+
+int restore_snapshot_memory( v68k::alloc::memory& alloc_mem )
+{
+	const uint8_t* base = (const uint8_t*) the_mapped_header;
+	
+	const uint32_t low_mem_size = longword_from_big( the_mapped_header[ header_low_mem_size ] );
+	
+	const off_t extents_offset = header_size + section_size( low_mem_size );
+	
+	const bool ok = place_extents( alloc_mem,
+	                               base,
+	                               the_snapshot_fd,
+	                               extents_offset,
+	                               the_mapped_size );
+	
+	close( the_snapshot_fd );
+	
+	the_snapshot_fd = -1;
+	
+	return ok ? 0 : EINVAL;
+}
+
+void restore_snapshot_registers( v68k::processor_state& s )
+{
+	const uint32_t* header = the_mapped_header;
+	
+	// Set SR first, since it swaps stack pointers.
+	
+	s.set_SR( longword_from_big( header[ header_SR ] ) );
+	
+	for ( int i = 0;  i < v68k::n_registers;  ++i )
+	{
+		s.regs[ i ] = longword_from_big( header[ header_registers + i ] );
+	}
+}
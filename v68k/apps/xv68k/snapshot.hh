@@ -0,0 +1,35 @@
+/*
+	snapshot.hh
+	-----------
+*/
+
+#ifndef SNAPSHOT_HH
+#define SNAPSHOT_HH
+
+// Standard C
+#include <stdint.h>
+
+
+namespace v68k
+{
+	struct processor_state;
+	
+	namespace alloc
+	{
+		class memory;
+	}
+}
+
+int save_snapshot( const char*                     path,
+                   const v68k::processor_state&    s,
+                   const v68k::alloc::memory&      alloc_mem,
+                   const uint8_t*                  low_mem,
+                   uint32_t                        low_mem_size );
+
+int map_snapshot( const char* path, uint8_t** low_mem, uint32_t low_mem_size );
+
+int restore_snapshot_memory( v68k::alloc::memory& alloc_mem );
+
+void restore_snapshot_registers( v68k::processor_state& s );
+
+#endif
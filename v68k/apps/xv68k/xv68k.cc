@@ -4,6 +4,7 @@
 */
 
 // Standard C
+#include <errno.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
@@ -30,6 +31,7 @@
 #include "auth/auth.hh"
 
 // v68k-mac
+#include "v68k-mac/native_traps.hh"
 #include "v68k-mac/trap_dispatcher.hh"
 
 // v68k-user
@@ -39,6 +41,7 @@
 #include "callback/bridge.hh"
 
 // v68k-utils
+#include "utils/dump_trace.hh"
 #include "utils/load.hh"
 #include "utils/print_register_dump.hh"
 
@@ -47,9 +50,13 @@
 #include "syscall/handler.hh"
 
 // xv68k
+#include "batch.hh"
 #include "diagnostics.hh"
+#include "interrupts.hh"
 #include "memory.hh"
+#include "profile.hh"
 #include "screen.hh"
+#include "snapshot.hh"
 
 
 #pragma exceptions off
@@ -66,10 +73,23 @@ using v68k::auth::fully_authorized;
 
 static bool verbose;
 
-static unsigned long n_instructions;
+static bool native_traps = true;
 
 static const char** module_names;
 
+static int32_t fake_pid;
+
+static const char* screen_file;
+static int screen_notify_fd = -1;
+
+static const char* trace_file;
+
+static const char* snapshot_file;
+static const char* save_snapshot_file;
+
+static const char* batch_file;
+static unsigned n_batch_threads;
+
 
 enum
 {
@@ -79,48 +99,36 @@ enum
 	
 	Opt_last_byte = 255,
 	
+	Opt_batch,
+	Opt_jobs,
+	Opt_no_native_traps,
 	Opt_pid,
+	Opt_profile,
+	Opt_save_snapshot,
 	Opt_screen,
+	Opt_screen_notify,
+	Opt_trace_file,
+	Opt_snapshot,
 };
 
 static command::option options[] =
 {
-	{ "",        Opt_authorized },
-	{ "verbose", Opt_verbose    },
-	{ "pid",     Opt_pid,    command::Param_optional },
-	{ "screen",  Opt_screen, command::Param_required },
-	{ "module",  Opt_module, command::Param_required },
+	{ "",                Opt_authorized      },
+	{ "verbose",         Opt_verbose         },
+	{ "pid",             Opt_pid,            command::Param_optional },
+	{ "profile",         Opt_profile,        command::Param_required },
+	{ "screen",          Opt_screen,         command::Param_required },
+	{ "screen-notify",   Opt_screen_notify,  command::Param_required },
+	{ "trace-file",      Opt_trace_file,     command::Param_required },
+	{ "snapshot",        Opt_snapshot,       command::Param_required },
+	{ "save-snapshot",   Opt_save_snapshot,  command::Param_required },
+	{ "module",          Opt_module,         command::Param_required },
+	{ "batch",           Opt_batch,          command::Param_required },
+	{ "jobs",            Opt_jobs,           command::Param_required },
+	{ "no-native-traps", Opt_no_native_traps },
 };
 
 
-static void atexit_report()
-{
-	if ( verbose )
-	{
-		const char* count = gear::inscribe_unsigned_decimal( n_instructions );
-		
-		write( STDERR_FILENO, STR_LEN( "### Instruction count: " ) );
-		write( STDERR_FILENO, count, strlen( count ) );
-		write( STDERR_FILENO, STR_LEN( "\n" ) );
-	}
-}
-
-static void dump( const v68k::processor_state& s )
-{
-	using v68k::utils::print_register_dump;
-	
-	print_register_dump( s.regs, s.get_SR() );
-}
-
-static void dump_and_raise( const v68k::processor_state& s, int signo )
-{
-	dump( s );
-	
-	atexit_report();
-	
-	raise( signo );
-}
-
 /*
 	Memory map
 	----------
@@ -174,7 +182,7 @@ static void dump_and_raise( const v68k::processor_state& s, int signo )
 		|                       |
 		|                       |  48K
 	64K	+-----------------------+
-		
+	
 	104	+-----------------------+
 		|                       |  screen memory begins 0x0001A700  (1792 bytes after)
 		|                       |  screen memory ends   0x0001FC80  (896 bytes before)
@@ -184,7 +192,7 @@ static void dump_and_raise( const v68k::processor_state& s, int signo )
 		|                       |
 		|                       |  24K (21.375K used)
 	128	+-----------------------+
-	
+
 */
 
 const uint32_t params_max_size = 4096;
@@ -214,6 +222,80 @@ const uint16_t argv_addr = params_addr + 44;  // 4 bytes
 const uint32_t args_addr = params_addr + 48;
 
 
+/*
+	Everything that belongs to one emulated program, so that a batch can
+	run many at once.  The breakpoint handler only gets the processor
+	state, so it finds the rest by downcasting.  (The memory is in a base
+	class so it's constructed before the emulator that refers to it.)
+*/
+
+struct program_memory
+{
+	memory_manager  memory;
+	
+	program_memory( uint8_t* mem ) : memory( mem, mem_size )
+	{
+	}
+};
+
+struct emulated_program : program_memory, v68k::emulator
+{
+	syscall_context          syscalls;
+	v68k::callback::context  callbacks;
+	int                      fault_signal;
+	
+	emulated_program( uint8_t* mem, v68k::callback::fault_handler fault = 0 );  // NULL
+};
+
+static inline emulated_program& get_program( v68k::processor_state& s )
+{
+	return static_cast< emulated_program& >( s );
+}
+
+static emulated_program* the_program;
+
+static void atexit_report()
+{
+	if ( the_program != NULL )
+	{
+		the_program->memory.screen().flush();
+	}
+	
+	write_profile();
+	
+	if ( verbose  &&  the_program != NULL )
+	{
+		/*
+			Read the count from the emulator itself, since we may be called
+			from within run() (e.g. by exit() in the system call bridge).
+		*/
+		
+		const unsigned long n_instructions = the_program->instruction_count();
+		
+		const char* count = gear::inscribe_unsigned_decimal( n_instructions );
+		
+		write( STDERR_FILENO, STR_LEN( "### Instruction count: " ) );
+		write( STDERR_FILENO, count, strlen( count ) );
+		write( STDERR_FILENO, STR_LEN( "\n" ) );
+	}
+}
+
+static void dump( const v68k::processor_state& s )
+{
+	using v68k::utils::print_register_dump;
+	
+	print_register_dump( s.regs, s.get_SR() );
+}
+
+static void dump_and_raise( const v68k::processor_state& s, int signo )
+{
+	dump( s );
+	
+	atexit_report();
+	
+	raise( signo );
+}
+
 static void init_trap_table( uint32_t* table, uint32_t* end, uint32_t address )
 {
 	const uint32_t unimplemented = v68k::big_longword( address );
@@ -268,6 +350,11 @@ static const uint16_t loader_code[] =
 	0x4E75   // RTS
 };
 
+static const uint16_t VBL_handler[] =
+{
+	0x4E73   // RTE
+};
+
 #define HANDLER( handler )  handler, sizeof handler
 
 static void load_vectors( v68k::user::os_load_spec& os )
@@ -283,6 +370,7 @@ static void load_vectors( v68k::user::os_load_spec& os )
 	
 	install_exception_handler( os, 10, HANDLER( trap_dispatcher ) );
 	install_exception_handler( os, 32, HANDLER( system_call ) );
+	install_exception_handler( os, 25, HANDLER( VBL_handler ) );
 	
 	os.mem_used = boot_address;
 	
@@ -316,9 +404,10 @@ static void load_Mac_traps( uint8_t* mem )
 	os_traps[ 0x2E ] = big_longword( callback_address( BlockMove_trap  ) );
 	os_traps[ 0xAD ] = big_longword( callback_address( Gestalt_trap    ) );
 	
+	os_traps[ 0x46 ] = big_longword( callback_address( GetTrapAddress_trap ) );
+	
 	const uint32_t big_no_op = big_longword( callback_address( v68k::callback::no_op ) );
 	
-	os_traps[ 0x46 ] = big_no_op;  // GetTrapAddress
 	os_traps[ 0x47 ] = big_no_op;  // SetTrapAddress
 	os_traps[ 0x55 ] = big_no_op;  // StripAddress
 	os_traps[ 0x98 ] = big_no_op;  // HWPriv
@@ -430,7 +519,15 @@ static void load_code( uint8_t* mem, const char* path )
 
 static uint16_t bkpt_2( v68k::processor_state& s )
 {
-	if ( bridge_call( s ) )
+	const uint32_t call_number = s.d(0);
+	
+	const profile_time start = profile_clock();
+	
+	const bool ok = bridge_call( s, get_program( s ).syscalls );
+	
+	profile_syscall( call_number, start );
+	
+	if ( ok )
 	{
 		return 0x4E75;  // RTS
 	}
@@ -450,7 +547,15 @@ static uint16_t bkpt_2( v68k::processor_state& s )
 
 static uint16_t bkpt_3( v68k::processor_state& s )
 {
-	if ( uint32_t new_opcode = v68k::callback::bridge( s ) )
+	const uint32_t call_number = int32_t( s.pc() ) / -2 - 1;
+	
+	const profile_time start = profile_clock();
+	
+	const uint32_t new_opcode = v68k::callback::bridge( s, get_program( s ).callbacks );
+	
+	profile_callback( call_number, start );
+	
+	if ( new_opcode )
 	{
 		return new_opcode;
 	}
@@ -458,6 +563,51 @@ static uint16_t bkpt_3( v68k::processor_state& s )
 	return 0x4AFC;  // ILLEGAL
 }
 
+static bool native_callback( v68k::processor_state& s, uint32_t address )
+{
+	const uint32_t call_number = int32_t( address ) / -2 - 1;
+	
+	const profile_time start = profile_clock();
+	
+	const uint32_t new_opcode = v68k::callback::bridge( s, get_program( s ).callbacks, address );
+	
+	profile_callback( call_number, start );
+	
+	if ( new_opcode == 0x4E75 )  // RTS
+	{
+		return true;
+	}
+	
+	// As in bkpt_3(), a failed callback is an illegal instruction.
+	
+	if ( s.condition == v68k::normal )
+	{
+		get_program( s ).illegal_instruction();
+	}
+	
+	return false;
+}
+
+/*
+	Hot OS traps whose routines are host callbacks skip the 68K trap
+	dispatcher and the callback's BKPT round trip:  The emulator's line A
+	handler calls the callback directly.  (The trap table entries are the
+	same either way, so a guest patch still takes effect.)
+*/
+
+static void install_native_traps()
+{
+	using namespace v68k::callback;
+	
+	using v68k::mac::install_native_trap;
+	
+	install_native_trap( 0xA01E, callback_address( NewPtr_trap         ), &native_callback );
+	install_native_trap( 0xA01F, callback_address( DisposePtr_trap     ), &native_callback );
+	install_native_trap( 0xA02E, callback_address( BlockMove_trap      ), &native_callback );
+	install_native_trap( 0xA046, callback_address( GetTrapAddress_trap ), &native_callback );
+	install_native_trap( 0xA0AD, callback_address( Gestalt_trap        ), &native_callback );
+}
+
 static uint16_t bkpt_handler( v68k::processor_state& s, int vector )
 {
 	switch ( vector )
@@ -473,6 +623,22 @@ static uint16_t bkpt_handler( v68k::processor_state& s, int vector )
 	}
 }
 
+emulated_program::emulated_program( uint8_t* mem, v68k::callback::fault_handler fault )
+:
+	program_memory( mem ),
+	v68k::emulator( v68k::mc68000, memory, bkpt_handler ),
+	fault_signal()
+{
+	syscalls.alloc          = &memory.alloc();
+	syscalls.errno_ptr_addr = params_addr + 2 * sizeof (uint32_t);
+	syscalls.fake_pid       = fake_pid;
+	
+	callbacks.alloc = &memory.alloc();
+	callbacks.fault = fault;
+	
+	set_line_A_handler( &v68k::mac::native_trap_dispatcher );
+}
+
 static inline unsigned parse_instruction_limit( const char* var )
 {
 	if ( var == NULL )
@@ -483,27 +649,96 @@ static inline unsigned parse_instruction_limit( const char* var )
 	return gear::parse_unsigned_decimal( var );
 }
 
-static void emulation_loop( v68k::emulator& emu )
+static bool sleep_until_interrupt( emulated_program& emu )
+{
+	/*
+		A guest that draws and then STOPs is waiting for the viewer to
+		show its work, so don't hold the update until the next yield.
+	*/
+	
+	emu.memory.screen().flush();
+	
+	return wait_for_interrupt( emu );
+}
+
+static void emulation_loop( emulated_program& emu )
 {
 	const char* instruction_limit_var = getenv( "XV68K_INSTRUCTION_LIMIT" );
 	
 	const unsigned instruction_limit = parse_instruction_limit( instruction_limit_var );
 	
-	while ( emu.step() )
+	/*
+		Run until the next yield point (every 64K instructions), or until
+		the instruction limit would be exceeded, whichever comes first.
+	*/
+	
+	const unsigned long yield_interval = 0x10000;
+	
+	unsigned long n;
+	
+	do
 	{
-		n_instructions = emu.instruction_count();
+		const unsigned long n_instructions = emu.instruction_count();
 		
-		if ( short( n_instructions ) == 0 )
+		if ( short( n_instructions ) == 0  &&  n_instructions != 0 )
 		{
+			emu.memory.screen().flush();
+			
 			kill( 1, 0 );  // Guaranteed yield point in MacRelix
 		}
 		
-		if ( instruction_limit != 0  &&  emu.instruction_count() > instruction_limit )
+		if ( instruction_limit != 0  &&  n_instructions > instruction_limit )
 		{
+			if ( emu.callbacks.fault )
+			{
+				emu.callbacks.fault( emu, SIGXCPU );
+				
+				return;
+			}
+			
 			print_instruction_limit_exceeded( instruction_limit_var );
 			
 			dump_and_raise( emu, SIGXCPU );
 		}
+		
+		n = yield_interval - (n_instructions & (yield_interval - 1));
+		
+		if ( instruction_limit != 0  &&  n > instruction_limit + 1 - n_instructions )
+		{
+			n = instruction_limit + 1 - n_instructions;
+		}
+	}
+	while ( (profiling ? profile_run( emu, n ) : emu.run( n ))  ||
+	        (emu.condition == v68k::stopped  &&  sleep_until_interrupt( emu )) );
+}
+
+static void dump_trace( const v68k::emulator& emu )
+{
+	/*
+		Show the last few instructions leading up to the crash, and save
+		the whole trace buffer if requested, for `d68k --trace`.
+	*/
+	
+	using v68k::utils::print_trace_dump;
+	using v68k::utils::write_trace_dump;
+	
+	const unsigned n_shown = 16;
+	
+	print_trace_dump( emu.trace(), n_shown );
+	
+	if ( trace_file != NULL )
+	{
+		int fd = open( trace_file, O_WRONLY | O_CREAT | O_TRUNC, 0666 );
+		
+		if ( fd < 0  ||  !write_trace_dump( fd, emu.mem, emu.trace() ) )
+		{
+			more::perror( "xv68k", trace_file );
+		}
+		
+		if ( fd >= 0 )
+		{
+			close( fd );
+		}
 	}
 }
 
@@ -518,6 +753,8 @@ static void report_condition( v68k::emulator& emu )
 		case halted:
 			print_halted();
 			
+			dump_trace( emu );
+			
 			dump_and_raise( emu, SIGSEGV );
 			break;
 		
@@ -530,7 +767,7 @@ static void report_condition( v68k::emulator& emu )
 	}
 }
 
-static void load_module( uint8_t* mem, const char* module )
+static void load_module( emulated_program& emu, uint8_t* mem, const char* module )
 {
 	if ( strchr( module, '/' ) == NULL )
 	{
@@ -578,11 +815,9 @@ static void load_module( uint8_t* mem, const char* module )
 		exit( 1 );
 	}
 	
-	using namespace v68k::alloc;
-	
-	const int n = (size + page_size - 1) / page_size;  // round up
+	const uint32_t addr = emu.memory.alloc().allocate_copy( alloc, size );
 	
-	const uint32_t addr = allocate_n_pages_for_existing_alloc_unchecked( n, alloc );
+	free( alloc );
 	
 	if ( addr == 0 )
 	{
@@ -598,8 +833,32 @@ static void load_module( uint8_t* mem, const char* module )
 	*p++ = iota::big_u16( addr );
 }
 
-static int execute_68k( int argc, char* const* argv )
+static void exit_with_file_error( const char* path, int error_number )
+{
+	const char* error = strerror( error_number );
+	
+	write( STDERR_FILENO, path, strlen( path ) );
+	write( STDERR_FILENO, STR_LEN( ": " ) );
+	write( STDERR_FILENO, error, strlen( error ) );
+	write( STDERR_FILENO, STR_LEN( "\n" ) );
+	
+	exit( 1 );
+}
+
+static uint8_t* new_low_memory()
 {
+	if ( snapshot_file != NULL )
+	{
+		uint8_t* mem;
+		
+		if ( int nok = map_snapshot( snapshot_file, &mem, mem_size ) )
+		{
+			exit_with_file_error( snapshot_file, nok );
+		}
+		
+		return mem;
+	}
+	
 	uint8_t* mem = (uint8_t*) calloc( 1, mem_size );
 	
 	if ( mem == NULL )
@@ -607,19 +866,58 @@ static int execute_68k( int argc, char* const* argv )
 		abort();
 	}
 	
-	const memory_manager memory( mem, mem_size );
+	return mem;
+}
+
+static void set_up_screen( screen_memory& screen )
+{
+	if ( screen_file != NULL )
+	{
+		if ( int nok = screen.set_backing_store_file( screen_file ) )
+		{
+			exit_with_file_error( screen_file, nok );
+		}
+	}
+	
+	if ( screen_notify_fd >= 0 )
+	{
+		screen.set_notification_fd( screen_notify_fd );
+	}
+}
+
+static int execute_68k( int argc, char* const* argv )
+{
+	uint8_t* mem = new_low_memory();
 	
-	v68k::emulator emu( v68k::mc68000, memory, bkpt_handler );
+	// Static, so atexit_report() can still use it after we return.
 	
-	errno_ptr_addr = params_addr + 2 * sizeof (uint32_t);
+	static emulated_program emu( mem );
 	
-	atexit( &atexit_report );
+	set_up_screen( emu.memory.screen() );
 	
-	v68k::user::os_load_spec load = { mem, mem_size, os_address };
+	the_program = &emu;
 	
-	load_vectors( load );
+	atexit( &atexit_report );
 	
-	load_Mac_traps( mem );
+	if ( snapshot_file != NULL )
+	{
+		// Vectors, trap tables, and previous modules are already loaded.
+		
+		if ( int nok = restore_snapshot_memory( emu.memory.alloc() ) )
+		{
+			exit_with_file_error( snapshot_file, nok );
+		}
+		
+		restore_snapshot_registers( emu );
+	}
+	else
+	{
+		v68k::user::os_load_spec load = { mem, mem_size, os_address };
+		
+		load_vectors( load );
+		
+		load_Mac_traps( mem );
+	}
 	
 	if ( *module_names )
 	{
@@ -630,7 +928,7 @@ static int execute_68k( int argc, char* const* argv )
 	
 	for ( const char** m = module_names;  *m;  ++m  )
 	{
-		load_module( mem, *m );
+		load_module( emu, mem, *m );
 		
 		emu.reset();
 		
@@ -644,6 +942,16 @@ static int execute_68k( int argc, char* const* argv )
 		}
 	}
 	
+	if ( save_snapshot_file != NULL )
+	{
+		if ( int nok = save_snapshot( save_snapshot_file, emu, emu.memory.alloc(), mem, mem_size ) )
+		{
+			exit_with_file_error( save_snapshot_file, nok );
+		}
+		
+		return 0;
+	}
+	
 	load_argv( mem, argc, argv );
 	
 	const char* path = argv[0];
@@ -652,6 +960,11 @@ static int execute_68k( int argc, char* const* argv )
 	
 	emu.reset();
 	
+	if ( int nok = start_VBL_timer( emu ) )
+	{
+		more::perror( "xv68k", "VBL timer", nok );
+	}
+	
 	emulation_loop( emu );
 	
 	report_condition( emu );
@@ -661,6 +974,133 @@ static int execute_68k( int argc, char* const* argv )
 	return 1;
 }
 
+static int load_batch_code( uint8_t* mem, const char* path )
+{
+	uint32_t size;
+	
+	void* alloc = v68k::utils::load_file( path, &size );
+	
+	if ( alloc == NULL )
+	{
+		return errno;
+	}
+	
+	const int nok = size == 0             ? ENOEXEC
+	              : size > code_max_size  ? EFBIG
+	              :                         0;
+	
+	if ( !nok )
+	{
+		memcpy( mem + code_address, alloc, size );
+	}
+	
+	free( alloc );
+	
+	return nok;
+}
+
+static void batch_fault( v68k::processor_state& s, int signo )
+{
+	get_program( s ).fault_signal = signo;
+	
+	s.condition = v68k::halted;
+}
+
+static void run_batch_job( batch_job& job )
+{
+	uint8_t* mem = (uint8_t*) calloc( 1, mem_size );
+	
+	if ( mem == NULL )
+	{
+		abort();
+	}
+	
+	emulated_program emu( mem, &batch_fault );
+	
+	emu.syscalls.fds[ 0 ] = job.input_fd;
+	emu.syscalls.fds[ 1 ] = job.output_fd;
+	emu.syscalls.fds[ 2 ] = job.output_fd;
+	
+	emu.syscalls.own_fds_only = true;  // keep out of other jobs' output
+	
+	emu.syscalls.exit_in_place = true;
+	
+	v68k::user::os_load_spec load = { mem, mem_size, os_address };
+	
+	load_vectors( load );
+	
+	load_Mac_traps( mem );
+	
+	load_argv( mem, job.argc, job.argv );
+	
+	job.status = 1;
+	
+	if ( int nok = load_batch_code( mem, job.argv[ 0 ] ) )
+	{
+		const char* error = strerror( nok );
+		
+		const char* path = job.argv[ 0 ];
+		
+		write( job.output_fd, STR_LEN( "xv68k: " ) );
+		write( job.output_fd, path, strlen( path ) );
+		write( job.output_fd, STR_LEN( ": " ) );
+		write( job.output_fd, error, strlen( error ) );
+		write( job.output_fd, STR_LEN( "\n" ) );
+	}
+	else
+	{
+		emu.reset();
+		
+		emulation_loop( emu );
+		
+		if ( emu.fault_signal )
+		{
+			job.signo = emu.fault_signal;
+		}
+		else if ( emu.condition == v68k::halted )
+		{
+			job.signo = SIGSEGV;
+		}
+		else if ( emu.syscalls.exited )
+		{
+			job.status = emu.syscalls.exit_status;
+		}
+	}
+	
+	free( mem );
+}
+
+static int execute_batch()
+{
+	if ( *module_names  ||  profiling  ||  screen_file  ||  screen_notify_fd >= 0  ||
+	     snapshot_file  ||  save_snapshot_file  ||  trace_file )
+	{
+		write( STDERR_FILENO, STR_LEN( "xv68k: --batch can't be combined with "
+		                               "--module, --profile, --screen, --screen-notify, "
+		                               "--snapshot, --save-snapshot, or --trace-file\n" ) );
+		
+		return 2;
+	}
+	
+	unsigned n_threads = n_batch_threads;
+	
+	if ( n_threads == 0 )
+	{
+		const long n_cpus = sysconf( _SC_NPROCESSORS_ONLN );
+		
+		n_threads = n_cpus > 0 ? n_cpus : 1;
+	}
+	
+	const int n_failed = run_batch( batch_file, n_threads, &run_batch_job );
+	
+	if ( n_failed < 0 )
+	{
+		exit_with_file_error( batch_file, errno );
+	}
+	
+	return n_failed != 0;
+}
+
 static char* const* get_options( char* const* argv )
 {
 	const char** module = module_names;
@@ -701,24 +1141,57 @@ static char* const* get_options( char* const* argv )
 				
 				break;
 			
-			case Opt_screen:
+			case Opt_profile:
 				const char* path;
 				path = global_result.param;
 				
-				if ( int nok = set_screen_backing_store_file( path ) )
+				if ( int nok = set_profile_file( path, code_address ) )
 				{
-					const char* error = strerror( nok );
-					
-					write( STDERR_FILENO, path, strlen( path ) );
-					write( STDERR_FILENO, STR_LEN( ": " ) );
-					write( STDERR_FILENO, error, strlen( error ) );
-					write( STDERR_FILENO, STR_LEN( "\n" ) );
-					
-					exit( 1 );
+					exit_with_file_error( path, nok );
 				}
 				
 				break;
 			
+			case Opt_screen:
+				screen_file = global_result.param;
+				
+				break;
+			
+			case Opt_screen_notify:
+				screen_notify_fd = gear::parse_unsigned_decimal( global_result.param );
+				
+				break;
+			
+			case Opt_batch:
+				batch_file = global_result.param;
+				
+				break;
+			
+			case Opt_jobs:
+				n_batch_threads = gear::parse_unsigned_decimal( global_result.param );
+				
+				break;
+			
+			case Opt_no_native_traps:
+				native_traps = false;
+				
+				break;
+			
+			case Opt_snapshot:
+				snapshot_file = global_result.param;
+				
+				break;
+			
+			case Opt_save_snapshot:
+				save_snapshot_file = global_result.param;
+				
+				break;
+			
+			case Opt_trace_file:
+				trace_file = global_result.param;
+				
+				break;
+			
 			case Opt_module:
 				*module++ = global_result.param;
 				
@@ -750,6 +1223,16 @@ int main( int argc, char** argv )
 	
 	int argn = argc - (args - argv);
 	
+	if ( native_traps )
+	{
+		install_native_traps();
+	}
+	
+	if ( batch_file != NULL )
+	{
+		return execute_batch();
+	}
+	
 	return execute_68k( argn, args );
 }
 
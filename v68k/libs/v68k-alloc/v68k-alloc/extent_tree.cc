@@ -0,0 +1,153 @@
+/*
+	extent_tree.cc
+	--------------
+*/
+
+#include "v68k-alloc/extent_tree.hh"
+
+// Standard C
+#include <stdlib.h>
+#include <string.h>
+
+
+#pragma exceptions off
+
+
+namespace v68k  {
+namespace alloc {
+
+static inline uint32_t max( uint32_t a, uint32_t b )
+{
+	return a > b ? a : b;
+}
+
+extent_tree::~extent_tree()
+{
+	free( its_nodes );
+}
+
+bool extent_tree::initialize( uint32_t n )
+{
+	uint32_t width = 1;
+	
+	while ( width < n )
+	{
+		width *= 2;
+	}
+	
+	node* nodes = (node*) calloc( 2 * width, sizeof (node) );
+	
+	if ( nodes == NULL )
+	{
+		return false;
+	}
+	
+	free( its_nodes );
+	
+	its_nodes = nodes;
+	its_width = width;
+	
+	// Leaves past n stay reserved.
+	
+	release( 0, n );
+	
+	return true;
+}
+
+bool extent_tree::copy( const extent_tree& other )
+{
+	const size_t size = 2 * other.its_width * sizeof (node);
+	
+	node* nodes = (node*) malloc( size );
+	
+	if ( nodes == NULL )
+	{
+		return false;
+	}
+	
+	memcpy( nodes, other.its_nodes, size );
+	
+	free( its_nodes );
+	
+	its_nodes = nodes;
+	its_width = other.its_width;
+	
+	return true;
+}
+
+void extent_tree::set_range( uint32_t first, uint32_t n, bool free )
+{
+	if ( n == 0 )
+	{
+		return;
+	}
+	
+	uint32_t lo = its_width + first;
+	uint32_t hi = its_width + first + n - 1;
+	
+	const node leaf = { free, free, free };
+	
+	for ( uint32_t i = lo;  i <= hi;  ++i )
+	{
+		its_nodes[ i ] = leaf;
+	}
+	
+	// Update the ancestors of the range, one level at a time.
+	
+	for ( uint32_t span = 1;  lo > 1;  span *= 2 )
+	{
+		lo /= 2;
+		hi /= 2;
+		
+		for ( uint32_t i = lo;  i <= hi;  ++i )
+		{
+			const node& l = its_nodes[ 2 * i     ];
+			const node& r = its_nodes[ 2 * i + 1 ];
+			
+			node& parent = its_nodes[ i ];
+			
+			parent.prefix  = l.prefix == span ? span + r.prefix : l.prefix;
+			parent.suffix  = r.suffix == span ? span + l.suffix : r.suffix;
+			parent.longest = max( max( l.longest, r.longest ), l.suffix + r.prefix );
+		}
+	}
+}
+
+int32_t extent_tree::find( uint32_t n ) const
+{
+	if ( n == 0  ||  longest_free_run() < n )
+	{
+		return -1;
+	}
+	
+	// Descend toward the leftmost node whose span holds n free pages.
+	
+	uint32_t i     = 1;
+	uint32_t first = 0;
+	
+	for ( uint32_t span = its_width / 2;  span > 0;  span /= 2 )
+	{
+		const node& l = its_nodes[ 2 * i     ];
+		const node& r = its_nodes[ 2 * i + 1 ];
+		
+		if ( l.longest >= n )
+		{
+			i = 2 * i;
+		}
+		else if ( l.suffix + r.prefix >= n )
+		{
+			return first + span - l.suffix;  // straddles the middle
+		}
+		else
+		{
+			i = 2 * i + 1;
+			
+			first += span;
+		}
+	}
+	
+	return first;
+}
+
+}  // namespace alloc
+}  // namespace v68k
@@ -0,0 +1,69 @@
+/*
+	extent_tree.hh
+	--------------
+*/
+
+#ifndef V68KALLOC_EXTENTTREE_HH
+#define V68KALLOC_EXTENTTREE_HH
+
+// Standard C
+#include <stdint.h>
+
+
+namespace v68k  {
+namespace alloc {
+
+/*
+	Tracks which of n pages are free, as a segment tree:  Each node records
+	the longest run of free pages within its span, and the free runs at
+	either end of it, so the lowest run of a given length can be found (and
+	a range reserved or released) in logarithmic time.
+*/
+
+class extent_tree
+{
+	private:
+		struct node
+		{
+			uint32_t  prefix;   // free pages at the start of the span
+			uint32_t  suffix;   // free pages at the end of the span
+			uint32_t  longest;  // longest free run within the span
+		};
+		
+		node*     its_nodes;  // root at 1, leaves at its_width and up
+		uint32_t  its_width;  // a power of two, at least n
+		
+		void set_range( uint32_t first, uint32_t n, bool free );
+		
+		// non-copyable
+		extent_tree           ( const extent_tree& );
+		extent_tree& operator=( const extent_tree& );
+	
+	public:
+		extent_tree() : its_nodes(), its_width()
+		{
+		}
+		
+		~extent_tree();
+		
+		bool initialize( uint32_t n );  // all free
+		
+		bool copy( const extent_tree& other );
+		
+		uint32_t longest_free_run() const
+		{
+			return its_nodes ? its_nodes[ 1 ].longest : 0;
+		}
+		
+		// Returns the first page of the lowest run of n free pages, or -1
+		int32_t find( uint32_t n ) const;
+		
+		void reserve( uint32_t first, uint32_t n )  { set_range( first, n, false ); }
+		void release( uint32_t first, uint32_t n )  { set_range( first, n, true  ); }
+};
+
+}  // namespace alloc
+}  // namespace v68k
+
+
+#endif
@@ -7,196 +7,481 @@
 
 // Standard C
 #include <stdlib.h>
+#include <string.h>
+
+// POSIX
+#include <sys/mman.h>
 
 
 #pragma exceptions off
 
 
+#ifndef MAP_ANON
+#define MAP_ANON  MAP_ANONYMOUS
+#endif
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE  0
+#endif
+
+
 namespace v68k  {
 namespace alloc {
 
-static void* alloc_pages[ n_alloc_pages + 1 ];
+enum
+{
+	page_mapped       = 1,
+	page_first        = 2,  // the first page of a block
+	page_host_mapping = 4,  // (first page only)
+};
+
+struct image
+{
+	uint8_t*  base;
+	size_t    size;
+	long      refs;  // one per page (in any memory) that shares it
+};
+
+static inline void retain( image* img )
+{
+	__sync_fetch_and_add( &img->refs, 1 );
+}
+
+static void release( image* img )
+{
+	if ( __sync_sub_and_fetch( &img->refs, 1 ) == 0 )
+	{
+		munmap( img->base, img->size );
+		
+		free( img );
+	}
+}
 
+static uint8_t* map_anonymous( void* addr, size_t size )
+{
+	const int fixed = addr ? MAP_FIXED : 0;
+	
+	void* p = mmap( addr,
+	                size,
+	                PROT_READ | PROT_WRITE,
+	                MAP_PRIVATE | MAP_ANON | MAP_NORESERVE | fixed,
+	                -1,
+	                0 );
+	
+	return p == MAP_FAILED ? NULL : (uint8_t*) p;
+}
 
-static int find_n_pages_at( int n, void* alloc, int i )
+memory::memory( uint32_t start_addr, uint32_t limit_addr )
+:
+	its_start( start_addr ),
+	its_n_pages(),
+	its_arena(),
+	its_images(),
+	its_flags()
 {
-	// Returns 0 on success, or next index to try
+	const uint32_t n = (limit_addr - start_addr) / page_size;
 	
-	void* const ante = (char*) alloc - page_size;
-	void* const post = (char*) alloc + page_size;
+	its_arena  = map_anonymous( NULL, n * size_t( page_size ) );
+	its_images = (image**) calloc( n, sizeof (image*) );
+	its_flags  = (uint8_t*) calloc( n, sizeof (uint8_t) );
 	
-	int j = i + 1 + n;
+	if ( its_arena  &&  its_images  &&  its_flags  &&  its_free_pages.initialize( n ) )
+	{
+		its_n_pages = n;
+		
+		return;
+	}
 	
-	if ( alloc_pages[ j ] == post )
+	// Leave an empty window, in which every allocation fails.
+	
+	if ( its_arena )
 	{
-		return j;
+		munmap( its_arena, n * size_t( page_size ) );
+		
+		its_arena = NULL;
 	}
 	
-	while ( --j > i )
+	free( its_images );
+	free( its_flags  );
+	
+	its_images = NULL;
+	its_flags  = NULL;
+}
+
+memory::~memory()
+{
+	for ( uint32_t i = 0;  i < its_n_pages;  ++i )
 	{
-		if ( alloc_pages[ j ] != NULL )
+		if ( image* img = its_images[ i ] )
 		{
-			return j;
+			release( img );
 		}
 	}
 	
-	if ( alloc_pages[ i ] == ante )
+	if ( its_arena )
+	{
+		munmap( its_arena, its_n_pages * size_t( page_size ) );
+	}
+	
+	free( its_images );
+	free( its_flags  );
+}
+
+uint8_t* memory::host_page( uint32_t i ) const
+{
+	const image* img = its_images[ i ];
+	
+	return (img ? img->base : its_arena) + i * size_t( page_size );
+}
+
+uint8_t* memory::private_page( uint32_t i ) const
+{
+	uint8_t* page = its_arena + i * size_t( page_size );
+	
+	if ( image* img = its_images[ i ] )
 	{
-		return i + 1;
+		memcpy( page, img->base + i * size_t( page_size ), page_size );
+		
+		its_images[ i ] = NULL;
+		
+		release( img );
 	}
 	
-	return 0;
+	return page;
 }
 
-static int find_n_pages( int n, void* alloc )
+void memory::release_pages( uint32_t first, uint32_t n )
 {
-	// Returns index of first page on success, otherwise 0
+	/*
+		Drop shared pages' references, and replace the contents (and any
+		file mappings) of private ones, so that the arena is untouched
+		wherever pages are free.
+	*/
 	
-	const int end = n_alloc_pages - n;
+	const uint32_t end = first + n;
 	
-	int i = 0;
+	uint32_t i = first;
 	
 	while ( i < end )
 	{
-		int next = find_n_pages_at( n, alloc, i );
+		if ( image* img = its_images[ i ] )
+		{
+			its_images[ i++ ] = NULL;
+			
+			release( img );
+			
+			continue;
+		}
+		
+		uint32_t j = i + 1;
+		
+		while ( j < end  &&  its_images[ j ] == NULL )
+		{
+			++j;
+		}
 		
-		if ( next == 0 )
+		uint8_t* p = its_arena + i * size_t( page_size );
+		
+		const size_t size = (j - i) * size_t( page_size );
+		
+		if ( map_anonymous( p, size ) == NULL )
 		{
-			return i + 1;
+			memset( p, '\0', size );
 		}
 		
-		i = next;
+		i = j;
 	}
-	
-	return 0;
 }
 
-uint32_t allocate_n_pages_for_existing_alloc_unchecked( uint32_t n, void* alloc )
+uint32_t memory::allocate_n_pages( uint32_t n, uint8_t flags )
 {
-	if ( alloc == NULL )
+	const int32_t i = its_free_pages.find( n );
+	
+	if ( i < 0 )
 	{
 		return 0;  // NULL
 	}
 	
-	int i = find_n_pages( n, alloc );
+	its_free_pages.reserve( i, n );
+	
+	its_flags[ i ] = page_mapped | page_first | flags;
 	
-	if ( i == 0 )
+	memset( &its_flags[ i + 1 ], page_mapped, n - 1 );
+	
+	// Free pages are untouched, so they're already zeroed.
+	
+	return its_start + i * page_size;
+}
+
+uint32_t memory::allocate( uint32_t size )
+{
+	if ( size > its_n_pages * page_size )
 	{
-		return 0;
+		return 0;  // NULL
 	}
 	
-	const uint32_t result = start + i * page_size;
+	const uint32_t n = size ? (size + page_size - 1) / page_size : 1;  // round up
+	
+	return allocate_n_pages( n, 0 );
+}
+
+uint32_t memory::allocate_copy( const void* data, uint32_t size )
+{
+	const uint32_t addr = allocate( size );
 	
-	for ( const int end = i + n;  i != end;  ++i )
+	if ( addr != 0 )
 	{
-		alloc_pages[ i ] = alloc;
-		
-		alloc = (char*) alloc + page_size;
+		memcpy( its_arena + (addr - its_start), data, size );
 	}
 	
-	return result;
+	return addr;
 }
 
-uint32_t allocate( uint32_t size )
+uint32_t memory::allocate_host_mapping( uint32_t n )
 {
-	if ( size > n_alloc_bytes )
+	if ( n > its_n_pages )
 	{
 		return 0;  // NULL
 	}
 	
-	const int n = (size + page_size - 1) / page_size;  // round up
+	return allocate_n_pages( n, page_host_mapping );
+}
+
+bool memory::is_host_mapping( uint32_t addr ) const
+{
+	const uint32_t i = (addr - its_start) >> page_size_bits;
+	
+	const uint8_t host_mapping = page_first | page_host_mapping;
 	
-	void* alloc = calloc( n, page_size );
+	return i < its_n_pages  &&  (its_flags[ i ] & host_mapping) == host_mapping;
+}
+
+void memory::deallocate( uint32_t addr )
+{
+	const uint32_t i = (addr - its_start) >> page_size_bits;
+	
+	if ( i >= its_n_pages  ||  !(its_flags[ i ] & page_first) )
+	{
+		return;
+	}
 	
-	const uint32_t result = allocate_n_pages_for_existing_alloc_unchecked( n, alloc );
+	uint32_t n = 0;
 	
-	if ( result == 0 )
+	do
 	{
-		free( alloc );
+		its_flags[ i + n++ ] = 0;
 	}
+	while ( i + n < its_n_pages  &&  its_flags[ i + n ] == page_mapped );
+	
+	release_pages( i, n );
 	
-	return result;
+	its_free_pages.release( i, n );
 }
 
-void* deallocate_existing( uint32_t addr )
+uint32_t memory::find_extent( uint32_t addr, uint32_t* n_pages ) const
 {
-	if ( start <= addr  &&  addr < limit )
+	if ( addr < its_start )
 	{
-		int i = (addr - start) / page_size;
-		
-		void* alloc = alloc_pages[ i ];
-		
-		if ( alloc != NULL  &&  alloc != (void*) -1L )
+		addr = its_start;
+	}
+	
+	for ( uint32_t i = (addr - its_start) >> page_size_bits;  i < its_n_pages;  ++i )
+	{
+		if ( its_flags[ i ] & page_mapped )
 		{
-			void* next = alloc;
+			uint32_t n = 1;
 			
-			do
+			while ( i + n < its_n_pages  &&  its_flags[ i + n ] == page_mapped )
 			{
-				alloc_pages[ i++ ] = NULL;
-				
-				next = (char*) next + page_size;
+				++n;
 			}
-			while ( alloc_pages[ i ] == next );
 			
-			return alloc;
+			*n_pages = n;
+			
+			return its_start + i * page_size;
 		}
 	}
 	
-	return NULL;
+	return 0;  // NULL
 }
 
-void deallocate( uint32_t addr )
+bool memory::allocate_n_pages_at( uint32_t addr, uint32_t n )
 {
-	free( deallocate_existing( addr ) );
+	const uint32_t offset = addr - its_start;
+	
+	const uint32_t i = offset >> page_size_bits;
+	
+	if ( offset % page_size  ||  i >= its_n_pages  ||  n == 0  ||  n > its_n_pages - i )
+	{
+		return false;
+	}
+	
+	for ( uint32_t j = i;  j < i + n;  ++j )
+	{
+		if ( its_flags[ j ] )
+		{
+			return false;
+		}
+	}
+	
+	its_free_pages.reserve( i, n );
+	
+	its_flags[ i ] = page_mapped | page_first;
+	
+	memset( &its_flags[ i + 1 ], page_mapped, n - 1 );
+	
+	return true;
 }
 
+bool memory::fork( memory& child )
+{
+	const bool compatible = child.its_start   == its_start    &&
+	                        child.its_n_pages == its_n_pages  &&
+	                        its_n_pages != 0;
+	
+	// The child must have nothing allocated.
+	
+	if ( !compatible  ||  child.its_free_pages.longest_free_run() != its_n_pages )
+	{
+		return false;
+	}
+	
+	const size_t size = its_n_pages * size_t( page_size );
+	
+	uint32_t n_private = 0;
+	
+	for ( uint32_t i = 0;  i < its_n_pages;  ++i )
+	{
+		n_private += its_flags[ i ]  &&  its_images[ i ] == NULL;
+	}
+	
+	if ( n_private != 0 )
+	{
+		// Freeze the arena as an image, and continue in a new one.
+		
+		image* img = (image*) malloc( sizeof (image) );
+		
+		uint8_t* arena = img ? map_anonymous( NULL, size ) : NULL;
+		
+		if ( arena == NULL )
+		{
+			free( img );
+			
+			return false;
+		}
+		
+		mprotect( its_arena, size, PROT_READ );
+		
+		img->base = its_arena;
+		img->size = size;
+		img->refs = n_private;
+		
+		its_arena = arena;
+		
+		for ( uint32_t i = 0;  i < its_n_pages;  ++i )
+		{
+			if ( its_flags[ i ]  &&  its_images[ i ] == NULL )
+			{
+				its_images[ i ] = img;
+			}
+		}
+	}
+	
+	if ( !child.its_free_pages.copy( its_free_pages ) )
+	{
+		return false;
+	}
+	
+	for ( uint32_t i = 0;  i < its_n_pages;  ++i )
+	{
+		child.its_flags[ i ] = its_flags[ i ];
+		
+		if ( image* img = its_images[ i ] )
+		{
+			retain( img );
+			
+			child.its_images[ i ] = img;
+		}
+	}
+	
+	return true;
+}
 
 uint8_t* memory::translate( uint32_t               addr,
                             uint32_t               length,
                             v68k::function_code_t  fc,
                             v68k::memory_access_t  access ) const
 {
-	if ( access == mem_exec )
+	const uint32_t offset = addr - its_start;
+	
+	const uint32_t first = offset >> page_size_bits;
+	
+	if ( first >= its_n_pages  ||  length > its_n_pages * page_size - offset )
 	{
-		// alloc memory is not executable, for now
-		
-		/*
-			FIXME:  alloc memory must be executable for load().  We need a
-			way to specify whether a region should be executable or not.
-		*/
-		
-		//return 0;  // NULL
+		return 0;  // NULL
 	}
 	
-	if ( addr < start  ||  addr >= limit )
+	const uint32_t last = (offset + length - (length != 0)) >> page_size_bits;
+	
+	/*
+		Every page in the range must be mapped and contiguous in host
+		memory, i.e. either in the arena or all in the same image.  Storing
+		makes each page private first.
+	*/
+	
+	const bool writing = access == mem_write;
+	
+	const image* img = writing ? NULL : its_images[ first ];
+	
+	for ( uint32_t i = first;  i <= last;  ++i )
 	{
-		return 0;
+		if ( !(its_flags[ i ] & page_mapped) )
+		{
+			return 0;  // NULL
+		}
+		
+		if ( writing )
+		{
+			private_page( i );
+		}
+		else if ( its_images[ i ] != img )
+		{
+			return 0;  // NULL
+		}
 	}
 	
-	addr -= start;
+	return host_page( first ) + (offset & (page_size - 1));
+}
+
+uint8_t* memory::translate_page( uint32_t               page_addr,
+                                 v68k::function_code_t  fc,
+                                 v68k::memory_access_t  access ) const
+{
+	/*
+		Translation pages are smaller than (and aligned within) alloc pages,
+		so a mapped translation page is always contiguous in host memory.
+		
+		A cached translation must stay valid until the next TLB flush, but
+		taking a private copy of a shared page moves it.  So reading from a
+		shared page isn't cached, and executing one takes the copy early.
+	*/
 	
-	const int index  = addr / page_size;
-	const int offset = addr % page_size;
+	const uint32_t offset = page_addr - its_start;
 	
-	void* page_alloc = alloc_pages[ index ];
+	const uint32_t i = offset >> page_size_bits;
 	
-	if ( page_alloc == NULL  ||  page_alloc == (void*) -1L )
+	if ( i >= its_n_pages  ||  !(its_flags[ i ] & page_mapped) )
 	{
-		// Address is not mapped, or reserved
-		
-		return 0;
+		return 0;  // NULL
 	}
 	
-	if ( offset + length > page_size  &&  alloc_pages[ index + 1 ] != (char*) page_alloc + page_size )
+	if ( its_images[ i ]  &&  access == mem_read )
 	{
-		// Access runs off end of block
-		
-		return 0;
+		return 0;  // NULL
 	}
 	
-	return (uint8_t*) page_alloc + offset;
+	return private_page( i ) + (offset & (page_size - 1));
 }
 
 }  // namespace alloc
 }  // namespace v68k
-
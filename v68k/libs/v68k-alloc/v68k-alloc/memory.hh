@@ -9,10 +9,15 @@
 // v68k
 #include "v68k/memory.hh"
 
+// v68k-alloc
+#include "v68k-alloc/extent_tree.hh"
+
 
 namespace v68k  {
 namespace alloc {
 
+// The default window of guest addresses
+
 const uint32_t start = 0x00800000;  //  8 MiB
 const uint32_t limit = 0x00F00000;  // 15 MiB
 
@@ -24,43 +29,106 @@ const uint32_t n_alloc_bytes = limit - start;  // 7 MiB
 const uint32_t n_alloc_pages = n_alloc_bytes / page_size;
 
 
-uint32_t allocate_n_pages_for_existing_alloc_unchecked( uint32_t n, void* alloc );
+struct image;
 
-inline uint32_t allocate_n_pages( void* alloc, uint32_t n )
-{
-	if ( n > n_alloc_pages )
-	{
-		return 0;
-	}
+/*
+	Each memory object has its own address space, so separate emulator
+	instances (even on separate threads) have separate memory.
 	
-	return allocate_n_pages_for_existing_alloc_unchecked( n, alloc );
-}
-
-inline uint32_t allocate( void* alloc, uint32_t size )
-{
-	if ( size & (page_size - 1) )
-	{
-		return 0;  // Not a page size multiple
-	}
+	The window of guest addresses is backed by a single anonymous host
+	mapping (the arena), reserved up front and faulted in by the host as
+	pages are touched.  Guest page i is at arena + i * page_size.  A free
+	page's arena memory is never touched, so allocations are zeroed for
+	free; deallocate() replaces the pages with fresh anonymous memory,
+	returning them to the host.  Free pages are tracked by an extent_tree.
 	
-	const uint32_t n = size >> page_size_bits;
+	fork() makes a copy-on-write clone of the address space (e.g. so each
+	test case can run from the same initial state).  The parent's arena
+	becomes an image, shared read-only by both, and each gets a new arena.
+	A memory's first write to a shared page copies it from the image into
+	its own arena.  Shared pages aren't cached by a TLB for reading (since
+	the copy would move them), but executing a shared page copies it, like
+	writing does.
 	
-	return allocate_n_pages( alloc, n );
-}
-
-uint32_t allocate( uint32_t size );
-
-void* deallocate_existing( uint32_t addr );
-
-void deallocate( uint32_t addr );
+	Freezing the arena makes it read-only, so any host pointers into it
+	that a v68k::tlb has cached for writing are stale after fork().  Every
+	emulator using the parent must call tlb.flush() before it runs again,
+	or its next store through the TLB will fault in the host.
+	
+	Snapshot support:  find_extent() reports the first block of pages at
+	or above addr (returning its address, or 0 if there are none), and
+	allocate_n_pages_at() reserves pages at a specific address.
+	
+	Blocks added by allocate_host_mapping() are the ones that the guest
+	may munmap(), and the caller may mmap() files over them with MAP_FIXED.
+	deallocate() replaces them with anonymous memory like any other block.
+*/
 
 class memory : public v68k::memory
 {
+	private:
+		uint32_t  its_start;
+		uint32_t  its_n_pages;
+		
+		uint8_t*  its_arena;
+		
+		/*
+			Each page's image, if it's shared, or NULL for the arena.  Taking
+			a private copy of a page changes its entry, even in a translate()
+			call, which is logically const.
+		*/
+		
+		image**   its_images;
+		uint8_t*  its_flags;
+		
+		extent_tree  its_free_pages;
+		
+		uint32_t allocate_n_pages( uint32_t n, uint8_t flags );
+		
+		uint8_t* host_page( uint32_t i ) const;
+		
+		uint8_t* private_page( uint32_t i ) const;
+		
+		void release_pages( uint32_t first, uint32_t n );
+		
+		// non-copyable
+		memory           ( const memory& );
+		memory& operator=( const memory& );
+	
 	public:
+		memory( uint32_t start_addr = start,
+		        uint32_t limit_addr = limit );
+		
+		~memory();
+		
+		uint32_t window_start() const  { return its_start; }
+		
+		uint32_t window_limit() const  { return its_start + its_n_pages * page_size; }
+		
+		uint32_t allocate( uint32_t size );
+		
+		uint32_t allocate_copy( const void* data, uint32_t size );
+		
+		uint32_t allocate_host_mapping( uint32_t n );
+		
+		bool is_host_mapping( uint32_t addr ) const;
+		
+		void deallocate( uint32_t addr );
+		
+		uint32_t find_extent( uint32_t addr, uint32_t* n_pages ) const;
+		
+		bool allocate_n_pages_at( uint32_t addr, uint32_t n );
+		
+		bool fork( memory& child );
+		
 		uint8_t* translate( uint32_t               addr,
 		                    uint32_t               length,
 		                    v68k::function_code_t  fc,
 		                    v68k::memory_access_t  access ) const;
+		
+		uint8_t* translate_page( uint32_t               page_addr,
+		                         v68k::function_code_t  fc,
+		                         v68k::memory_access_t  access ) const;
 };
 
 }  // namespace alloc
@@ -68,4 +136,3 @@ class memory : public v68k::memory
 
 
 #endif
-
@@ -55,11 +55,18 @@ enum
 	nil = 0
 };
 
-typedef uint32_t (*function_type)( v68k::processor_state& s );
+typedef uint32_t (*function_type)( v68k::processor_state& s, const context& c );
 
 
-static void dump_and_raise( const v68k::processor_state& s, int signo )
+static void dump_and_raise( v68k::processor_state& s, const context& c, int signo )
 {
+	if ( c.fault != NULL )
+	{
+		c.fault( s, signo );
+		
+		return;
+	}
+	
 	using v68k::utils::print_register_dump;
 	
 	print_register_dump( s.regs, s.get_SR() );
@@ -67,7 +74,7 @@ static void dump_and_raise( const v68k::processor_state& s, int signo )
 	raise( signo );
 }
 
-static uint32_t unimplemented_callback( v68k::processor_state& s )
+static uint32_t unimplemented_callback( v68k::processor_state& s, const context& c )
 {
 	abort();
 	
@@ -75,12 +82,12 @@ static uint32_t unimplemented_callback( v68k::processor_state& s )
 	return nil;
 }
 
-static uint32_t no_op_callback( v68k::processor_state& s )
+static uint32_t no_op_callback( v68k::processor_state& s, const context& c )
 {
 	return rts;
 }
 
-static uint32_t load_callback( v68k::processor_state& s )
+static uint32_t load_callback( v68k::processor_state& s, const context& c )
 {
 	const uint32_t path_addr = s.a(0);
 	const uint32_t path_size = s.d(0);  // includes trailing NUL
@@ -113,34 +120,31 @@ static uint32_t load_callback( v68k::processor_state& s )
 		return rts;
 	}
 	
-	using v68k::alloc::page_size;
-	using v68k::alloc::page_size_bits;
-	using v68k::alloc::allocate_n_pages;
 	using v68k::utils::load_file;
 	
 	const char* path = (const char*) p;
 	
 	void* alloc = load_file( path, &s.d(0) );
 	
-	const size_t n = (s.d(0) + page_size - 1) >> page_size_bits;  // round up
+	const uint32_t addr = alloc ? c.alloc->allocate_copy( alloc, s.d(0) ) : 0;
 	
-	const uint32_t addr = allocate_n_pages( alloc, n );
+	free( alloc );
 	
 	if ( addr == 0 )
 	{
-		free( alloc );
-		
 		s.d(1) = ENOMEM;
 	}
 	else
 	{
 		s.a(0) = addr;
+		
+		s.tlb.flush();
 	}
 	
 	return rts;
 }
 
-static uint32_t enter_supervisor_mode_callback( v68k::processor_state& s )
+static uint32_t enter_supervisor_mode_callback( v68k::processor_state& s, const context& c )
 {
 	const uint16_t old_SR = s.get_SR();
 	const uint16_t new_SR = old_SR | 0x2000;
@@ -185,14 +189,14 @@ static uint32_t enter_supervisor_mode_callback( v68k::processor_state& s )
 	return rts;
 }
 
-static uint32_t module_suspend_callback( v68k::processor_state& s )
+static uint32_t module_suspend_callback( v68k::processor_state& s, const context& c )
 {
 	s.condition = startup;
 	
 	return rts;
 }
 
-static uint32_t set_trace_mode_callback( v68k::processor_state& s )
+static uint32_t set_trace_mode_callback( v68k::processor_state& s, const context& c )
 {
 	s.sr.ttsm = (s.sr.ttsm & 0x3) | (uint8_t( s.pc() ) << 1 & 0xC);
 	
@@ -209,9 +213,9 @@ static char hex[] =
 
 #define UNIMPLEMENTED_TRAP_PREFIX  "v68k: exception: Unimplemented Mac trap: "
 
-static uint32_t unimplemented_trap_callback( v68k::processor_state& s )
+static uint32_t unimplemented_trap_callback( v68k::processor_state& s, const context& c )
 {
-	static char buffer[] = UNIMPLEMENTED_TRAP_PREFIX "A123\n";
+	char buffer[] = UNIMPLEMENTED_TRAP_PREFIX "A123\n";
 	
 	char* p = buffer + STRLEN( UNIMPLEMENTED_TRAP_PREFIX );
 	
@@ -223,21 +227,25 @@ static uint32_t unimplemented_trap_callback( v68k::processor_state& s )
 	
 	must_write( STDERR_FILENO, buffer, STRLEN( UNIMPLEMENTED_TRAP_PREFIX "A123\n" ) );
 	
-	dump_and_raise( s, SIGILL );
+	dump_and_raise( s, c, SIGILL );
 	
 	// Not reached
 	return nil;
 }
 
-static uint32_t NewPtr_callback( v68k::processor_state& s )
+static uint32_t NewPtr_callback( v68k::processor_state& s, const context& c )
 {
 	const uint32_t size = s.d(0);
 	
-	uint32_t addr = v68k::alloc::allocate( size );
+	uint32_t addr = c.alloc->allocate( size );
 	
 	s.a(0) = addr;
 	
-	if ( addr == 0 )
+	if ( addr != 0 )
+	{
+		s.tlb.flush();  // the new pages may have been cached as unmapped
+	}
+	else
 	{
 		const uint32_t addr_MemErr = 0x0220;
 		
@@ -249,48 +257,39 @@ static uint32_t NewPtr_callback( v68k::processor_state& s )
 	return rts;
 }
 
-static uint32_t DisposePtr_callback( v68k::processor_state& s )
+static uint32_t DisposePtr_callback( v68k::processor_state& s, const context& c )
 {
 	const uint32_t addr = s.a(0);
 	
-	v68k::alloc::deallocate( addr );
+	c.alloc->deallocate( addr );
+	
+	s.tlb.flush();  // don't leave cached pointers to freed memory
 	
 	return rts;
 }
 
-static uint32_t BlockMove_callback( v68k::processor_state& s )
+static uint32_t BlockMove_callback( v68k::processor_state& s, const context& c )
 {
 	const uint32_t src = s.a(0);
 	const uint32_t dst = s.a(1);
 	
 	const uint32_t n = s.d(0);
 	
-	const uint8_t* p = s.mem.translate( src, n, v68k::user_data_space, v68k::mem_read );
+	// The ranges may overlap, or span more than one memory region.
 	
-	if ( p == NULL )
+	if ( !s.mem.copy( dst, src, n, v68k::user_data_space ) )
 	{
-		abort();
-		return nil;  // FIXME
-	}
-	
-	uint8_t* q = s.mem.translate( dst, n, v68k::user_data_space, v68k::mem_write );
-	
-	if ( q == NULL )
-	{
-		abort();
-		return nil;  // FIXME
+		dump_and_raise( s, c, SIGSEGV );
+		
+		return nil;
 	}
 	
-	memcpy( q, p, n );
-	
-	s.mem.translate( dst, n, v68k::user_data_space, v68k::mem_update );
-	
 	return rts;
 }
 
 #define OSTYPE(a, b, c, d)  ((a) << 24 | (b) << 16 | (c) << 8 | (d))
 
-static uint32_t Gestalt_callback( v68k::processor_state& s )
+static uint32_t Gestalt_callback( v68k::processor_state& s, const context& c )
 {
 	const int32_t gestaltUndefSelectorErr = -5551;
 	
@@ -320,75 +319,106 @@ static uint32_t Gestalt_callback( v68k::processor_state& s )
 	return rts;
 }
 
+static uint32_t GetTrapAddress_callback( v68k::processor_state& s, const context& c )
+{
+	/*
+		The trap number is in D0, and the trap word (from the dispatcher)
+		in D1.  With bit 9 set, bit 10 selects the Toolbox table.  Without
+		it, the old single-table numbering is mapped onto the two tables.
+	*/
+	
+	const uint16_t trap = s.d(1);
+	const uint16_t n    = s.d(0) & (trap & 0x0200 ? 0x03FF : 0x01FF);
+	
+	const bool toolbox = trap & 0x0200 ? trap & 0x0400
+	                                   : n >= 0x50  &&  n != 0x54  &&  n != 0x57;
+	
+	const uint32_t table = toolbox ? 0x0C00 : 0x0400;
+	const uint16_t index = toolbox ? n      : n & 0x00FF;
+	
+	uint32_t addr;
+	
+	if ( !s.get_long( table + index * 4, addr, v68k::user_data_space ) )
+	{
+		dump_and_raise( s, c, SIGSEGV );
+		
+		return nil;
+	}
+	
+	s.a(0) = addr;
+	
+	return rts;
+}
+
 
-static uint32_t illegal_instruction_callback( v68k::processor_state& s )
+static uint32_t illegal_instruction_callback( v68k::processor_state& s, const context& c )
 {
 	WRITE_ERR( "Illegal Instruction" );
 	
-	dump_and_raise( s, SIGILL );
+	dump_and_raise( s, c, SIGILL );
 	
 	return nil;
 }
 
-static uint32_t division_by_zero_callback( v68k::processor_state& s )
+static uint32_t division_by_zero_callback( v68k::processor_state& s, const context& c )
 {
 	WRITE_ERR( "Division By Zero" );
 	
-	dump_and_raise( s, SIGFPE );
+	dump_and_raise( s, c, SIGFPE );
 	
 	return nil;
 }
 
-static uint32_t chk_trap_callback( v68k::processor_state& s )
+static uint32_t chk_trap_callback( v68k::processor_state& s, const context& c )
 {
 	WRITE_ERR( "CHK range exceeded" );
 	
-	dump_and_raise( s, SIGFPE );
+	dump_and_raise( s, c, SIGFPE );
 	
 	return nil;
 }
 
-static uint32_t trapv_trap_callback( v68k::processor_state& s )
+static uint32_t trapv_trap_callback( v68k::processor_state& s, const context& c )
 {
 	WRITE_ERR( "TRAPV on overflow" );
 	
-	dump_and_raise( s, SIGFPE );
+	dump_and_raise( s, c, SIGFPE );
 	
 	return nil;
 }
 
-static uint32_t privilege_violation_callback( v68k::processor_state& s )
+static uint32_t privilege_violation_callback( v68k::processor_state& s, const context& c )
 {
 	WRITE_ERR( "Privilege Violation" );
 	
-	dump_and_raise( s, SIGILL );
+	dump_and_raise( s, c, SIGILL );
 	
 	return nil;
 }
 
-static uint32_t trace_exception_callback( v68k::processor_state& s )
+static uint32_t trace_exception_callback( v68k::processor_state& s, const context& c )
 {
 	WRITE_ERR( "Trace Exception" );
 	
-	dump_and_raise( s, SIGTRAP );
+	dump_and_raise( s, c, SIGTRAP );
 	
 	return nil;
 }
 
-static uint32_t line_A_emulator_callback( v68k::processor_state& s )
+static uint32_t line_A_emulator_callback( v68k::processor_state& s, const context& c )
 {
 	WRITE_ERR( "Line A Emulator" );
 	
-	dump_and_raise( s, SIGILL );
+	dump_and_raise( s, c, SIGILL );
 	
 	return nil;
 }
 
-static uint32_t line_F_emulator_callback( v68k::processor_state& s )
+static uint32_t line_F_emulator_callback( v68k::processor_state& s, const context& c )
 {
 	WRITE_ERR( "Line F Emulator" );
 	
-	dump_and_raise( s, SIGILL );
+	dump_and_raise( s, c, SIGILL );
 	
 	return nil;
 }
@@ -417,15 +447,14 @@ static const function_type the_callbacks[] =
 	&DisposePtr_callback,
 	&BlockMove_callback,
 	&Gestalt_callback,
+	&GetTrapAddress_callback,
 	&unimplemented_callback
 };
 
 
-uint32_t bridge( v68k::processor_state& s )
+uint32_t bridge( v68k::processor_state& s, const context& c, uint32_t address )
 {
-	const int32_t pc = s.pc();
-	
-	const uint32_t call_number = pc / -2 - 1;
+	const uint32_t call_number = int32_t( address ) / -2 - 1;
 	
 	const size_t n_callbacks = sizeof the_callbacks / sizeof the_callbacks[0];
 	
@@ -435,7 +464,7 @@ uint32_t bridge( v68k::processor_state& s )
 		
 		if ( f != NULL )
 		{
-			return f( s );
+			return f( s, c );
 		}
 	}
 	
@@ -10,6 +10,14 @@
 #include "v68k/state.hh"
 
 
+namespace v68k  {
+namespace alloc {
+
+class memory;
+
+}  // namespace alloc
+}  // namespace v68k
+
 namespace v68k     {
 namespace callback {
 
@@ -36,6 +44,7 @@ enum
 	DisposePtr_trap,
 	BlockMove_trap,
 	Gestalt_trap,
+	GetTrapAddress_trap,
 	unimplemented,
 	n
 };
@@ -45,7 +54,32 @@ inline uint32_t callback_address( int index )
 	return uint32_t( (index + 1) * -2 );
 }
 
-uint32_t bridge( v68k::processor_state& emu );
+/*
+	Per-instance state for callbacks.  If fault is NULL, a fault (e.g. an
+	illegal instruction) dumps the registers and raises a signal in the
+	host process.  Otherwise fault is called with the signal number and
+	is expected to stop the emulator (e.g. by setting its condition).
+*/
+
+typedef void (*fault_handler)( v68k::processor_state& s, int signo );
+
+struct context
+{
+	v68k::alloc::memory*  alloc;
+	fault_handler         fault;
+};
+
+/*
+	bridge() calls the callback at address (by default, the PC) and returns
+	the opcode to execute in its place -- usually RTS -- or 0 on failure.
+*/
+
+uint32_t bridge( v68k::processor_state& emu, const context& c, uint32_t address );
+
+inline uint32_t bridge( v68k::processor_state& emu, const context& c )
+{
+	return bridge( emu, c, emu.pc() );
+}
 
 }  // namespace v68k
 }  // namespace callback
@@ -26,17 +26,12 @@ namespace mac  {
 
 enum
 {
-	tag_Ticks,
-	tag_Ticks_low_word,
-	tag_MemErr,
-	tag_ScrnBase,
-	tag_ScrnBase_low_word,
-	tag_last_A_trap,
-	n_words
+	tag_Ticks       = low_memory::tag_Ticks,
+	tag_MemErr      = low_memory::tag_MemErr,
+	tag_ScrnBase    = low_memory::tag_ScrnBase,
+	tag_last_A_trap = low_memory::tag_last_A_trap,
 };
 
-static uint16_t words[ n_words ];
-
 struct global
 {
 	uint16_t  addr;
@@ -86,7 +81,7 @@ static const global* find_global( uint16_t address )
 	return it;
 }
 
-static void refresh_dynamic_global( uint8_t tag )
+static void refresh_dynamic_global( uint16_t* words, uint8_t tag )
 {
 	uint16_t* address = &words[ tag ];
 	
@@ -106,9 +101,11 @@ static void refresh_dynamic_global( uint8_t tag )
 	}
 }
 
-static uint8_t buffer[ 7 ];
-
-static uint8_t* read_globals( const global* g, uint32_t addr, uint32_t size )
+static uint8_t* read_globals( uint16_t*      words,
+                              uint8_t*       buffer,
+                              const global*  g,
+                              uint32_t       addr,
+                              uint32_t       size )
 {
 	// size == 1 -> offset = 0
 	// size == 2 -> offset = addr & 1
@@ -155,7 +152,7 @@ static uint8_t* read_globals( const global* g, uint32_t addr, uint32_t size )
 		{
 			if ( g->size_ >= 0x40 )
 			{
-				refresh_dynamic_global( g->index );
+				refresh_dynamic_global( words, g->index );
 			}
 			
 			return (uint8_t*) &words[ g->index ];
@@ -182,7 +179,10 @@ static uint8_t* read_globals( const global* g, uint32_t addr, uint32_t size )
 	return buffer + offset;
 }
 
-static uint8_t* write_globals( const global* g, uint32_t addr, uint32_t size )
+static uint8_t* write_globals( uint8_t*       buffer,
+                               const global*  g,
+                               uint32_t       addr,
+                               uint32_t       size )
 {
 	if ( g->addr == addr  &&  g->size_ == size )
 	{
@@ -192,13 +192,21 @@ static uint8_t* write_globals( const global* g, uint32_t addr, uint32_t size )
 	return NULL;
 }
 
-static uint8_t* update_globals( const global* g, uint32_t addr, uint32_t size )
+static uint8_t* update_globals( uint16_t*      words,
+                                uint8_t*       buffer,
+                                const global*  g,
+                                uint32_t       addr,
+                                uint32_t       size )
 {
 	memcpy( &words[ g->index ], buffer, size );
 	
 	return buffer;
 }
 
+low_memory::low_memory() : its_words(), its_buffer()
+{
+}
+
 uint8_t* low_memory::translate( uint32_t               addr,
                                 uint32_t               length,
                                 v68k::function_code_t  fc,
@@ -215,15 +223,15 @@ uint8_t* low_memory::translate( uint32_t               addr,
 	{
 		if ( access == mem_read )
 		{
-			return read_globals( g, addr, length );
+			return read_globals( its_words, its_buffer, g, addr, length );
 		}
 		else if ( access == mem_write )
 		{
-			return write_globals( g, addr, length );
+			return write_globals( its_buffer, g, addr, length );
 		}
 		else  // mem_update
 		{
-			return update_globals( g, addr, length );
+			return update_globals( its_words, its_buffer, g, addr, length );
 		}
 	}
 	
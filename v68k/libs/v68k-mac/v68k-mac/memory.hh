@@ -16,6 +16,30 @@ namespace mac  {
 class low_memory : public v68k::memory
 {
 	public:
+		enum
+		{
+			tag_Ticks,
+			tag_Ticks_low_word,
+			tag_MemErr,
+			tag_ScrnBase,
+			tag_ScrnBase_low_word,
+			tag_last_A_trap,
+			n_words
+		};
+	
+	private:
+		/*
+			The dynamic globals and the scratch buffer for reads of the
+			static ones are per instance, so separate emulators (possibly
+			on separate threads) don't share them.
+		*/
+		
+		mutable uint16_t  its_words[ n_words ];
+		mutable uint8_t   its_buffer[ 7 ];
+	
+	public:
+		low_memory();
+		
 		uint8_t* translate( uint32_t               addr,
 		                    uint32_t               length,
 		                    v68k::function_code_t  fc,
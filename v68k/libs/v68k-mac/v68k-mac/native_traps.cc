@@ -0,0 +1,157 @@
+/*
+	native_traps.cc
+	---------------
+*/
+
+#include "v68k-mac/native_traps.hh"
+
+
+#pragma exceptions off
+
+
+namespace v68k {
+namespace mac  {
+
+const uint32_t os_trap_table_address = 0x0400;
+const uint32_t tb_trap_table_address = 0x0C00;
+
+const uint16_t os_trap_count = 1 <<  8;
+const uint16_t tb_trap_count = 1 << 10;
+
+struct native_trap_entry
+{
+	uint32_t     address;
+	native_trap  f;
+};
+
+static native_trap_entry os_natives[ os_trap_count ];
+static native_trap_entry tb_natives[ tb_trap_count ];
+
+static inline bool is_os_trap( uint16_t trap )
+{
+	return trap < 0xA800;
+}
+
+static inline uint16_t os_trap_index( uint16_t trap )
+{
+	return trap & (os_trap_count - 1);
+}
+
+static inline uint16_t tb_trap_index( uint16_t trap )
+{
+	return trap & (tb_trap_count - 1);
+}
+
+void install_native_trap( uint16_t trap, uint32_t address, native_trap f )
+{
+	native_trap_entry& entry = is_os_trap( trap ) ? os_natives[ os_trap_index( trap ) ]
+	                                              : tb_natives[ tb_trap_index( trap ) ];
+	
+	entry.address = address;
+	entry.f       = f;
+}
+
+static bool call_os_trap( v68k::processor_state& s, uint16_t trap, const native_trap_entry& entry )
+{
+	const uint32_t saved_d1 = s.d(1);
+	const uint32_t saved_d2 = s.d(2);
+	const uint32_t saved_a0 = s.a(0);
+	const uint32_t saved_a1 = s.a(1);
+	const uint32_t saved_a2 = s.a(2);
+	
+	s.d(1) = (saved_d1 & 0xFFFF0000) | trap;
+	
+	if ( !entry.f( s, entry.address ) )
+	{
+		return true;  // abandoned
+	}
+	
+	const bool keep_a0 = trap & 0x0100;
+	
+	if ( !keep_a0 )
+	{
+		s.a(0) = saved_a0;
+	}
+	
+	s.d(1) = saved_d1;
+	s.d(2) = saved_d2;
+	s.a(1) = saved_a1;
+	s.a(2) = saved_a2;
+	
+	// TST.W  D0
+	
+	const uint16_t d0 = s.d(0);
+	
+	const uint16_t N = (d0 >> 15) << 3;
+	const uint16_t Z = (d0 == 0)  << 2;
+	
+	s.set_CCR( (s.get_CCR() & 0x10) | N | Z );
+	
+	return true;
+}
+
+static bool call_tb_trap( v68k::processor_state& s, uint16_t trap, const native_trap_entry& entry )
+{
+	s.d(1) = (s.d(1) & 0xFFFF0000) | trap;
+	
+	if ( !entry.f( s, entry.address ) )
+	{
+		return true;  // abandoned
+	}
+	
+	const bool auto_pop = trap & 0x0400;
+	
+	if ( auto_pop )
+	{
+		// Return to the caller of the glue routine containing the trap.
+		
+		uint32_t& sp = s.a(7);
+		
+		if ( s.get_long( sp, s.pc(), s.data_space() ) )
+		{
+			sp += 4;
+		}
+		else
+		{
+			s.bus_error();
+		}
+	}
+	
+	return true;
+}
+
+bool native_trap_dispatcher( v68k::processor_state& s, uint16_t trap )
+{
+	const bool os = is_os_trap( trap );
+	
+	const uint16_t i = os ? os_trap_index( trap ) : tb_trap_index( trap );
+	
+	const native_trap_entry& entry = os ? os_natives[ i ] : tb_natives[ i ];
+	
+	if ( entry.f == 0 )  // NULL
+	{
+		return false;
+	}
+	
+	const uint32_t table = os ? os_trap_table_address : tb_trap_table_address;
+	
+	uint32_t address;
+	
+	if ( !s.get_long( table + i * 4, address, s.data_space() ) )
+	{
+		return false;
+	}
+	
+	if ( address != entry.address )
+	{
+		return false;  // patched by the guest
+	}
+	
+	s.pc() += 2;
+	
+	return os ? call_os_trap( s, trap, entry )
+	          : call_tb_trap( s, trap, entry );
+}
+
+}  // namespace mac
+}  // namespace v68k
@@ -0,0 +1,48 @@
+/*
+	native_traps.hh
+	---------------
+*/
+
+#ifndef MAC_NATIVETRAPS_HH
+#define MAC_NATIVETRAPS_HH
+
+// v68k
+#include "v68k/state.hh"
+
+
+namespace v68k {
+namespace mac  {
+
+/*
+	A native trap is a host implementation of a Mac trap routine, called
+	directly from the emulator's line A handler instead of by way of the
+	68K trap_dispatcher.  It sees the registers (and for Toolbox traps,
+	the stack) just as the trap routine at address would, except that no
+	return address is pushed.  D1.W holds the trap word.  It returns true
+	on completion, or false if it has abandoned the trap (e.g. by taking an
+	exception or stopping the processor).
+	
+	The registry is shared by all emulators, so install native traps
+	before running any.  A native trap is only used while the guest's trap
+	table entry still holds the address it was installed with, so a guest
+	that patches the trap gets its patch.
+*/
+
+typedef bool (*native_trap)( v68k::processor_state& s, uint32_t address );
+
+void install_native_trap( uint16_t trap, uint32_t address, native_trap f );
+
+/*
+	native_trap_dispatcher() is a line A handler (see v68k::emulator) that
+	performs traps with native implementations, following the 68K trap
+	dispatcher's conventions:  OS traps preserve D1-D2/A1 (and A0, unless
+	bit 8 of the trap word is set) and return with the CCR set from D0.W,
+	and auto-pop Toolbox traps return to the address on top of the stack.
+*/
+
+bool native_trap_dispatcher( v68k::processor_state& s, uint16_t trap );
+
+}  // namespace mac
+}  // namespace v68k
+
+#endif
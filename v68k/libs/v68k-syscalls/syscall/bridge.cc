@@ -10,13 +10,20 @@
 #include <time.h>
 
 // POSIX
+#include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/uio.h>
 
 // v68k
 #include "v68k/endian.hh"
 
+// v68k-alloc
+#include "v68k-alloc/memory.hh"
+
 // v68k-auth
 #include "auth/auth.hh"
 
@@ -30,63 +37,296 @@
 using v68k::auth::fully_authorized;
 
 
-uint32_t errno_ptr_addr;
+/*
+	The guest's (i.e. MacRelix's) values for open() and mmap() flags,
+	some of which differ from the host's.
+*/
+
+enum
+{
+	guest_AT_FDCWD = -100,
+	
+	guest_O_ACCMODE   = 0x0003,
+	guest_O_NONBLOCK  = 0x0004,
+	guest_O_APPEND    = 0x0008,
+	guest_O_NOFOLLOW  = 0x0100,
+	guest_O_CREAT     = 0x0200,
+	guest_O_TRUNC     = 0x0400,
+	guest_O_EXCL      = 0x0800,
+	guest_O_DIRECTORY = 0x4000,
+	guest_O_CLOEXEC   = 0x00080000,
+	
+	guest_PROT_WRITE = 0x0002,
+	
+	guest_MAP_SHARED  = 0x0001,
+	guest_MAP_PRIVATE = 0x0002,
+	guest_MAP_FIXED   = 0x0010,
+	guest_MAP_ANON    = 0x1000,
+};
+
+struct open_flag
+{
+	uint32_t  guest;
+	int       host;
+};
+
+static const open_flag open_flags[] =
+{
+	{ guest_O_NONBLOCK,  O_NONBLOCK  },
+	{ guest_O_APPEND,    O_APPEND    },
+	{ guest_O_NOFOLLOW,  O_NOFOLLOW  },
+	{ guest_O_CREAT,     O_CREAT     },
+	{ guest_O_TRUNC,     O_TRUNC     },
+	{ guest_O_EXCL,      O_EXCL      },
+	{ guest_O_DIRECTORY, O_DIRECTORY },
+	{ guest_O_CLOEXEC,   O_CLOEXEC   },
+};
+
+
+static int32_t emulated_pid( const syscall_context& c )
+{
+	return + c.fake_pid > 0 ? c.fake_pid
+	       : c.fake_pid < 0 ? getpid()
+	       :                  12345;
+}
+
+static inline bool guest_opened( const syscall_context& c, int fd )
+{
+	const uint32_t bit = 1 << (fd & 31);
+	
+	return unsigned( fd ) < c.max_opened_fds  &&  c.opened_fds[ fd >> 5 ] & bit;
+}
 
-int32_t fake_pid = 0;  // fake PID for getpid(), unless 0 or -1
+static inline void set_opened( syscall_context& c, int fd, bool opened )
+{
+	const uint32_t bit = 1 << (fd & 31);
+	
+	if ( opened )
+	{
+		c.opened_fds[ fd >> 5 ] |= bit;
+	}
+	else
+	{
+		c.opened_fds[ fd >> 5 ] &= ~bit;
+	}
+}
 
+/*
+	Map a guest fd to a host fd, or -1 (which the host rejects with EBADF)
+	if the guest has no business with it.  Host fds above 2 are off limits
+	unless the guest opened them:  They could be xv68k's own, or (in batch
+	mode) another job's output.
+*/
 
-static int32_t emulated_pid()
+static inline int host_fd( const syscall_context& c, int fd )
 {
-	return + fake_pid > 0 ? fake_pid
-	       : fake_pid < 0 ? getpid()
-	       :                12345;
+	return unsigned( fd ) < 3    ? c.fds[ fd ]
+	       : guest_opened( c, fd ) ? fd
+	       :                         -1;
+}
+
+/*
+	read() and write() also pass through host fds the guest didn't open,
+	so it can use ones inherited from the shell that ran xv68k -- unless
+	the guest is confined to its own, e.g. in batch mode, where the other
+	fds include the other programs' output files.
+*/
+
+static inline int io_fd( const syscall_context& c, int fd )
+{
+	return unsigned( fd ) < 3  ||  c.own_fds_only ? host_fd( c, fd ) : fd;
+}
+
+/*
+	Take ownership of a host fd from openat().  A guest that closed one of
+	its standard fds gets that number back, as POSIX specifies, but if the
+	number's slot still names some other host fd, move the new one higher.
+*/
+
+static int adopt_fd( syscall_context& c, int fd )
+{
+	if ( fd < 3  &&  c.fds[ fd ] < 0 )
+	{
+		c.fds[ fd ] = fd;
+		
+		return fd;
+	}
+	
+	if ( fd < 3 )
+	{
+		const int moved = fcntl( fd, F_DUPFD, 3 );
+		
+		const int saved_errno = errno;
+		
+		if ( moved >= 0  &&  fcntl( fd, F_GETFD ) & FD_CLOEXEC )
+		{
+			fcntl( moved, F_SETFD, FD_CLOEXEC );
+		}
+		
+		close( fd );
+		
+		errno = saved_errno;
+		
+		if ( moved < 0 )
+		{
+			return -1;
+		}
+		
+		fd = moved;
+	}
+	
+	if ( fd >= c.max_opened_fds )
+	{
+		close( fd );
+		
+		errno = EMFILE;
+		
+		return -1;
+	}
+	
+	set_opened( c, fd, true );
+	
+	return fd;
 }
 
 static bool get_stacked_args( const v68k::processor_state& s, uint32_t* out, int n )
 {
-	uint32_t sp = s.a(7);
+	const uint32_t sp = s.a(7) + 4;  // skip the return address
+	
+	if ( !s.mem.get_bytes( sp, (uint8_t*) out, n * sizeof (uint32_t), s.data_space() ) )
+	{
+		return false;
+	}
 	
-	while ( n > 0 )
+	for ( int i = 0;  i < n;  ++i )
 	{
-		sp += 4;
+		out[ i ] = v68k::longword_from_big( out[ i ] );
+	}
+	
+	return true;
+}
+
+/*
+	Translate a guest buffer into host spans for readv() and friends,
+	appending them to iov.  A buffer within one region is a single span,
+	but one that crosses region boundaries (e.g. from low memory into the
+	heap) takes more.  If iov runs out of room, addr and length are left
+	at the rest of the buffer, for the caller to load in a later batch.
+	Returns false (with errno set) if the buffer doesn't translate.
+*/
+
+/*
+	The number of spans transferred per host call.  This caps only the
+	batch size, not the transfer:  Callers loop over further batches
+	until the request is satisfied (or comes up short).
+*/
+
+const int max_spans = 16;
+
+static bool load_spans( const v68k::processor_state&  s,
+                        uint32_t&                     addr,
+                        uint32_t&                     length,
+                        v68k::memory_access_t         access,
+                        struct iovec*                 iov,
+                        int&                          n,
+                        int                           max_n )
+{
+	while ( length > 0  &&  n < max_n )
+	{
+		uint8_t* p;
+		
+		const uint32_t span = s.mem.translate_span( addr, length, s.data_space(), access, p );
 		
-		if ( !s.mem.get_long( sp, *out, s.data_space() ) )
+		if ( span == 0 )
 		{
+			errno = EFAULT;
+			
 			return false;
 		}
 		
-		++out;
-		--n;
+		iov[ n ].iov_base = p;
+		iov[ n ].iov_len  = span;
+		
+		++n;
+		
+		addr   += span;
+		length -= span;
 	}
 	
 	return true;
 }
 
-static void set_errno( v68k::processor_state& s )
+static size_t total_length( const struct iovec* iov, int n )
+{
+	size_t total = 0;
+	
+	for ( int i = 0;  i < n;  ++i )
+	{
+		total += iov[ i ].iov_len;
+	}
+	
+	return total;
+}
+
+static bool readable( int fd )
+{
+	struct pollfd pfd = { fd, POLLIN };
+	
+	return poll( &pfd, 1, 0 ) > 0;
+}
+
+static ssize_t transfer_spans( int                    fd,
+                               const struct iovec*    iov,
+                               int                    n,
+                               v68k::memory_access_t  access,
+                               size_t                 n_done )
+{
+	if ( access == v68k::mem_write )
+	{
+		/*
+			Once a batch has been read in full, only read more if it's
+			there -- a single read() from a pipe or terminal doesn't wait
+			for the rest of the buffer, so neither should we.
+		*/
+		
+		if ( n_done > 0  &&  ! readable( fd ) )
+		{
+			return 0;
+		}
+		
+		return readv( fd, iov, n );
+	}
+	
+	return writev( fd, iov, n );
+}
+
+static void set_errno( v68k::processor_state& s, const syscall_context& c )
 {
 	s.d(1) = errno;
 	
 	uint32_t errno_ptr;
 	
-	if ( s.mem.get_long( errno_ptr_addr, errno_ptr, s.data_space() )  &&  errno_ptr != 0 )
+	if ( s.mem.get_long( c.errno_ptr_addr, errno_ptr, s.data_space() )  &&  errno_ptr != 0 )
 	{
 		s.mem.put_long( errno_ptr, errno, s.data_space() );
 	}
 }
 
-static inline bool set_result( v68k::processor_state& s, int result )
+static inline bool set_result( v68k::processor_state&   s,
+                               const syscall_context&  c,
+                               int                     result )
 {
 	s.d(0) = result;
 	
 	if ( result < 0 )
 	{
-		set_errno( s );
+		set_errno( s, c );
 	}
 	
 	return true;
 }
 
-static bool emu_exit( v68k::processor_state& s )
+static bool emu_exit( v68k::processor_state& s, syscall_context& c )
 {
 	uint32_t args[1];  // status
 	
@@ -97,13 +337,25 @@ static bool emu_exit( v68k::processor_state& s )
 	
 	const int status = int32_t( args[0] );
 	
+	if ( c.exit_in_place )
+	{
+		c.exited      = true;
+		c.exit_status = status;
+		
+		s.condition = v68k::finished;
+		
+		return true;
+	}
+	
 	exit( status );
 	
 	// Not reached
 	return false;
 }
 
-static bool emu_read( v68k::processor_state& s )
+static bool emu_read_write( v68k::processor_state&  s,
+                            syscall_context&        c,
+                            v68k::memory_access_t   access )
 {
 	uint32_t args[3];  // fd, buffer, length
 	
@@ -112,71 +364,226 @@ static bool emu_read( v68k::processor_state& s )
 		return s.bus_error();
 	}
 	
-	const int fd = int32_t( args[0] );
+	const int fd = io_fd( c, int32_t( args[0] ) );
 	
 	const uint32_t buffer = args[1];
 	
 	const size_t length = args[2];
 	
-	uint8_t* p = s.mem.translate( buffer, length, s.data_space(), v68k::mem_write );
+	struct iovec iov[ max_spans ];
 	
-	int result;
+	uint32_t addr      = buffer;
+	uint32_t remaining = length;
 	
-	if ( p == NULL )
+	int result = 0;
+	
+	do
 	{
-		result = -1;
+		int n = 0;
 		
-		errno = EFAULT;
+		if ( !load_spans( s, addr, remaining, access, iov, n, max_spans ) )
+		{
+			result = result ? result : -1;
+			break;
+		}
+		
+		const ssize_t n_transferred = transfer_spans( fd, iov, n, access, result );
+		
+		if ( n_transferred < 0 )
+		{
+			result = result ? result : -1;
+			break;
+		}
+		
+		result += n_transferred;
+		
+		if ( n_transferred < total_length( iov, n ) )
+		{
+			break;
+		}
 	}
-	else
+	while ( remaining > 0 );
+	
+	if ( access == v68k::mem_write  &&  result > 0 )
 	{
-		result = read( fd, p, length );
+		s.mem.update( buffer, result, s.data_space() );
 	}
 	
-	return set_result( s, result );
+	return set_result( s, c, result );
 }
 
-static bool emu_write( v68k::processor_state& s )
+static bool emu_read( v68k::processor_state& s, syscall_context& c )
 {
-	uint32_t args[3];  // fd, buffer, length
+	return emu_read_write( s, c, v68k::mem_write );
+}
+
+static bool emu_write( v68k::processor_state& s, syscall_context& c )
+{
+	return emu_read_write( s, c, v68k::mem_read );
+}
+
+static int host_open_flags( uint32_t flags )
+{
+	// The guest's access modes are the host's plus one (O_RDONLY is 1).
 	
-	if ( !get_stacked_args( s, args, 3 ) )
+	const uint32_t accmode = flags & guest_O_ACCMODE;
+	
+	int result = accmode ? accmode - 1 : O_RDONLY;
+	
+	for ( int i = 0;  i < sizeof open_flags / sizeof open_flags[0];  ++i )
+	{
+		if ( flags & open_flags[ i ].guest )
+		{
+			result |= open_flags[ i ].host;
+		}
+	}
+	
+	return result;
+}
+
+static bool get_path( const v68k::processor_state& s, uint32_t addr, char* path, size_t size )
+{
+	for ( size_t i = 0;  i < size;  ++i )
+	{
+		uint8_t c;
+		
+		if ( !s.mem.get_byte( addr + i, c, s.data_space() ) )
+		{
+			errno = EFAULT;
+			
+			return false;
+		}
+		
+		if ( (path[ i ] = c) == '\0' )
+		{
+			return true;
+		}
+	}
+	
+	errno = ENAMETOOLONG;
+	
+	return false;
+}
+
+static bool emu_openat( v68k::processor_state& s, syscall_context& c )
+{
+	uint32_t args[4];  // dirfd, path, flags, mode
+	
+	if ( !get_stacked_args( s, args, 4 ) )
 	{
 		return s.bus_error();
 	}
 	
-	const int fd = int32_t( args[0] );
+	const int dirfd = int32_t( args[0] );
 	
-	const uint32_t buffer = args[1];
+	const uint32_t flags = args[2];
+	const uint32_t mode  = args[3];
 	
-	const size_t length = args[2];
+	char path[ 1024 ];
 	
-	const uint8_t* p = s.mem.translate( buffer, length, s.data_space(), v68k::mem_read );
+	int result = -1;
 	
-	int result;
+	if ( !fully_authorized )
+	{
+		// Like load(), opening host files requires authorization.
+		
+		errno = EPERM;
+	}
+	else if ( get_path( s, args[1], path, sizeof path ) )
+	{
+		const int host_dirfd = dirfd == guest_AT_FDCWD ? AT_FDCWD : host_fd( c, dirfd );
+		
+		result = openat( host_dirfd, path, host_open_flags( flags ), mode );
+		
+		if ( result >= 0 )
+		{
+			result = adopt_fd( c, result );
+		}
+	}
+	
+	return set_result( s, c, result );
+}
+
+static bool emu_close( v68k::processor_state& s, syscall_context& c )
+{
+	uint32_t args[1];  // fd
+	
+	if ( !get_stacked_args( s, args, 1 ) )
+	{
+		return s.bus_error();
+	}
+	
+	const int fd = int32_t( args[0] );
 	
-	if ( p == NULL )
+	const int host = host_fd( c, fd );
+	
+	int result = 0;
+	
+	if ( host < 0 )
 	{
+		errno = EBADF;
+		
 		result = -1;
+	}
+	else if ( unsigned( fd ) < 3 )
+	{
+		/*
+			Forget the standard fd.  A redirected one belongs to the host,
+			so only close it if it isn't redirected.
+		*/
 		
-		errno = EFAULT;
+		c.fds[ fd ] = -1;
+		
+		if ( host == fd )
+		{
+			result = close( fd );
+		}
 	}
 	else
 	{
-		result = write( fd, p, length );
+		set_opened( c, fd, false );
+		
+		result = close( fd );
+	}
+	
+	return set_result( s, c, result );
+}
+
+static bool emu_lseek( v68k::processor_state& s, syscall_context& c )
+{
+	uint32_t args[3];  // fd, offset, whence
+	
+	if ( !get_stacked_args( s, args, 3 ) )
+	{
+		return s.bus_error();
+	}
+	
+	const int fd = int32_t( args[0] );
+	
+	const off_t offset = int32_t( args[1] );
+	
+	const int whence = int32_t( args[2] );
+	
+	off_t result = lseek( host_fd( c, fd ), offset, whence );
+	
+	if ( result > 0x7FFFFFFF )
+	{
+		errno = EOVERFLOW;
+		
+		result = -1;
 	}
 	
-	return set_result( s, result );
+	return set_result( s, c, result );
 }
 
-static bool emu_getpid( v68k::processor_state& s )
+static bool emu_getpid( v68k::processor_state& s, syscall_context& c )
 {
-	int32_t result = emulated_pid();
+	int32_t result = emulated_pid( c );
 	
-	return set_result( s, result );
+	return set_result( s, c, result );
 }
 
-static bool emu_kill( v68k::processor_state& s )
+static bool emu_kill( v68k::processor_state& s, syscall_context& c )
 {
 	uint32_t args[2];  // pid, sig
 	
@@ -190,9 +597,9 @@ static bool emu_kill( v68k::processor_state& s )
 	
 	int result;
 	
-	if ( fully_authorized  ||  pid == emulated_pid() )
+	if ( fully_authorized  ||  pid == emulated_pid( c ) )
 	{
-		if ( fake_pid > 0  &&  pid == fake_pid )
+		if ( c.fake_pid > 0  &&  pid == c.fake_pid )
 		{
 			pid = getpid();
 		}
@@ -206,10 +613,10 @@ static bool emu_kill( v68k::processor_state& s )
 		errno = EPERM;
 	}
 	
-	return set_result( s, result );
+	return set_result( s, c, result );
 }
 
-static bool emu_gettimeofday( v68k::processor_state& s )
+static bool emu_gettimeofday( v68k::processor_state& s, syscall_context& c )
 {
 	uint32_t args[2];  // tv, tz
 	
@@ -237,7 +644,7 @@ static bool emu_gettimeofday( v68k::processor_state& s )
 		}
 	}
 	
-	return set_result( s, result );
+	return set_result( s, c, result );
 }
 
 static void load_fdset( fd_set& native, const uint32_t* emulated, int n )
@@ -324,7 +731,7 @@ static int store_fdset( v68k::processor_state&  s,
 	return 1;
 }
 
-static bool emu_select( v68k::processor_state& s )
+static bool emu_select( v68k::processor_state& s, syscall_context& c )
 {
 	fd_set read_fds;
 	fd_set write_fds;
@@ -357,17 +764,17 @@ static bool emu_select( v68k::processor_state& s )
 	{
 		result = load_fdset( s, n, n_fdset_bytes, rfd_addr, read_fds );
 		
-		if ( result < 0 )  return set_result( s, result );
+		if ( result < 0 )  return set_result( s, c, result );
 		if ( result > 0 )  r = &read_fds;
 		
 		result = load_fdset( s, n, n_fdset_bytes, wfd_addr, write_fds );
 		
-		if ( result < 0 )  return set_result( s, result );
+		if ( result < 0 )  return set_result( s, c, result );
 		if ( result > 0 )  w = &write_fds;
 		
 		result = load_fdset( s, n, n_fdset_bytes, xfd_addr, except_fds );
 		
-		if ( result < 0 )  return set_result( s, result );
+		if ( result < 0 )  return set_result( s, c, result );
 		if ( result > 0 )  x = &except_fds;
 	}
 	
@@ -383,7 +790,7 @@ static bool emu_select( v68k::processor_state& s )
 		{
 			errno = EFAULT;
 			
-			return set_result( s, -1 );
+			return set_result( s, c, -1 );
 		}
 		
 		timeval tv;
@@ -403,83 +810,330 @@ static bool emu_select( v68k::processor_state& s )
 		store_fdset( s, n, n_fdset_bytes, xfd_addr, x );
 	}
 	
-	return set_result( s, result );
+	return set_result( s, c, result );
 }
 
-struct iovec_68k
+static uint32_t map_host_pages( syscall_context&  c,
+                                uint32_t          size,
+                                uint32_t          flags,
+                                int               fd,
+                                off_t             offset )
 {
-	uint32_t ptr;
-	uint32_t len;
-};
+	using v68k::alloc::page_size;
+	
+	const uint32_t n = (size + page_size - 1) / page_size;  // round up
+	
+	/*
+		Reserve whole alloc pages of zeroed memory first, and map the file
+		over as much of it as the file covers, so the guest can't provoke
+		SIGBUS by touching past the end of the file.
+	*/
+	
+	const uint32_t addr = c.alloc->allocate_host_mapping( n );
+	
+	if ( addr == 0 )
+	{
+		errno = ENOMEM;
+		
+		return 0;
+	}
+	
+	if ( !(flags & guest_MAP_ANON) )
+	{
+		uint8_t* base = c.alloc->translate( addr,
+		                                    n * page_size,
+		                                    v68k::user_data_space,
+		                                    v68k::mem_write );
+		
+		struct stat st;
+		
+		void* mapped = MAP_FAILED;
+		
+		if ( fstat( fd, &st ) == 0 )
+		{
+			const off_t file_size = st.st_size > offset ? st.st_size - offset : 0;
+			
+			const size_t length = file_size < size ? file_size : size;
+			
+			/*
+				The guest's memory isn't write-protected, so a read-only
+				mapping has to be private to survive the guest storing to it.
+			*/
+			
+			const int sharing = flags & guest_MAP_SHARED ? MAP_SHARED : MAP_PRIVATE;
+			
+			mapped = length == 0 ? base
+			                     : mmap( base,
+			                             length,
+			                             PROT_READ | PROT_WRITE,
+			                             sharing | MAP_FIXED,
+			                             fd,
+			                             offset );
+		}
+		
+		if ( mapped == MAP_FAILED )
+		{
+			const int saved_errno = errno;
+			
+			c.alloc->deallocate( addr );
+			
+			errno = saved_errno;
+			
+			return 0;
+		}
+	}
+	
+	return addr;
+}
 
-static bool emu_writev( v68k::processor_state& s )
+static bool emu_mmap( v68k::processor_state& s, syscall_context& c )
 {
-	uint32_t args[3];  // fd, iov, n
+	uint32_t args[6];  // addr, len, prot, flags, fd, offset
 	
-	if ( !get_stacked_args( s, args, 3 ) )
+	if ( !get_stacked_args( s, args, 6 ) )
 	{
 		return s.bus_error();
 	}
 	
+	const uint32_t len   = args[1];
+	const uint32_t prot  = args[2];
+	const uint32_t flags = args[3];
+	
+	const int fd = int32_t( args[4] );
+	
+	const off_t offset = int32_t( args[5] );
+	
+	const uint32_t sharing = flags & (guest_MAP_SHARED | guest_MAP_PRIVATE);
+	
 	int result = -1;
 	
-	const int fd = int32_t( args[0] );
+	if ( c.alloc == NULL )
+	{
+		errno = ENODEV;
+	}
+	else if ( len == 0  ||  flags & guest_MAP_FIXED  ||  sharing == 0  ||  sharing == guest_MAP_SHARED + guest_MAP_PRIVATE )
+	{
+		errno = EINVAL;
+	}
+	else if ( len > c.alloc->window_limit() - c.alloc->window_start() )
+	{
+		errno = ENOMEM;
+	}
+	else
+	{
+		// Writes to a read-only shared mapping stay private.
+		
+		const uint32_t host_flags = prot & guest_PROT_WRITE ? flags : flags & ~guest_MAP_SHARED;
+		
+		if ( uint32_t addr = map_host_pages( c, len, host_flags, host_fd( c, fd ), offset ) )
+		{
+			result = addr;
+			
+			s.tlb.flush();  // the new pages may have been cached as unmapped
+		}
+	}
 	
-	const uint32_t iov_addr = args[1];
+	return set_result( s, c, result );
+}
+
+static bool emu_munmap( v68k::processor_state& s, syscall_context& c )
+{
+	uint32_t args[2];  // addr, len
 	
-	const size_t n = args[2];
+	if ( !get_stacked_args( s, args, 2 ) )
+	{
+		return s.bus_error();
+	}
 	
-	const size_t size = n * sizeof (iovec_68k);
+	const uint32_t addr = args[0];
 	
-	struct iovec* iov = (struct iovec*) malloc( sizeof (struct iovec) * n );
+	int result = -1;
 	
-	const iovec_68k* iov_mem = (iovec_68k*) s.mem.translate( iov_addr,
-	                                                         size,
-	                                                         s.data_space(),
-	                                                         v68k::mem_read );
+	// Only whole mappings made by mmap() can be unmapped.
 	
-	if ( iov == NULL )
+	if ( c.alloc == NULL  ||  !c.alloc->is_host_mapping( addr ) )
 	{
-		errno = ENOMEM;
+		errno = EINVAL;
+	}
+	else
+	{
+		c.alloc->deallocate( addr );
 		
-		goto end;
+		s.tlb.flush();  // don't leave cached pointers to unmapped memory
+		
+		result = 0;
 	}
 	
-	if ( iov_mem == NULL )
+	return set_result( s, c, result );
+}
+
+struct iovec_68k
+{
+	uint32_t ptr;
+	uint32_t len;
+};
+
+static bool get_iovec_entry( const v68k::processor_state&  s,
+                             uint32_t                      iov_addr,
+                             int                           i,
+                             uint32_t&                     ptr,
+                             uint32_t&                     len )
+{
+	iovec_68k entry;
+	
+	if ( !s.mem.get_bytes( iov_addr + i * sizeof entry,
+	                       (uint8_t*) &entry,
+	                       sizeof entry,
+	                       s.data_space() ) )
 	{
-		errno = EFAULT;
-		
-		goto end;
+		return false;
 	}
 	
-	for ( int i = 0;  i < n;  ++i )
+	ptr = v68k::longword_from_big( entry.ptr );
+	len = v68k::longword_from_big( entry.len );
+	
+	return true;
+}
+
+/*
+	Load the next batch of spans from the guest's iovec array.  i is the
+	index of the next entry to read, and ptr and len are what's left of
+	the previous one; all three start at zero.  Loading is finished when
+	i reaches n with len at zero.
+*/
+
+static bool load_iovec( v68k::processor_state&  s,
+                        uint32_t                iov_addr,
+                        size_t                  n,
+                        size_t&                 i,
+                        uint32_t&               ptr,
+                        uint32_t&               len,
+                        v68k::memory_access_t   access,
+                        struct iovec*           iov,
+                        int&                    n_spans,
+                        int                     max_spans )
+{
+	while ( n_spans < max_spans )
 	{
-		const uint32_t ptr = v68k::longword_from_big( iov_mem[i].ptr );
-		const uint32_t len = v68k::longword_from_big( iov_mem[i].len );
+		if ( len == 0 )
+		{
+			if ( i == n )
+			{
+				break;
+			}
+			
+			if ( !get_iovec_entry( s, iov_addr, i++, ptr, len ) )
+			{
+				errno = EFAULT;
+				
+				return false;
+			}
+		}
+		else if ( !load_spans( s, ptr, len, access, iov, n_spans, max_spans ) )
+		{
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+static void update_iovec( v68k::processor_state&  s,
+                          uint32_t                iov_addr,
+                          size_t                  n,
+                          uint32_t                n_stored )
+{
+	// Tell the memory (e.g. the screen) about what readv() stored.
+	
+	for ( int i = 0;  i < n  &&  n_stored > 0;  ++i )
+	{
+		uint32_t ptr;
+		uint32_t len;
 		
-		const uint8_t* p = s.mem.translate( ptr, len, s.data_space(), v68k::mem_read );
+		get_iovec_entry( s, iov_addr, i, ptr, len );
 		
-		if ( p == NULL )
+		if ( len > n_stored )
 		{
-			errno = EFAULT;
-			
-			goto end;
+			len = n_stored;
 		}
 		
-		iov[i].iov_base = (void*) p;
-		iov[i].iov_len  = len;
+		s.mem.update( ptr, len, s.data_space() );
+		
+		n_stored -= len;
+	}
+}
+
+static bool emu_readv_writev( v68k::processor_state&  s,
+                              syscall_context&        c,
+                              v68k::memory_access_t   access )
+{
+	uint32_t args[3];  // fd, iov, n
+	
+	if ( !get_stacked_args( s, args, 3 ) )
+	{
+		return s.bus_error();
 	}
 	
-	result = writev( fd, iov, n );
+	const int fd = host_fd( c, int32_t( args[0] ) );
+	
+	const uint32_t iov_addr = args[1];
+	
+	const size_t n = args[2];
+	
+	struct iovec iov[ max_spans ];
 	
-end:
+	size_t   i   = 0;
+	uint32_t ptr = 0;
+	uint32_t len = 0;
 	
-	free( iov );
+	int result = 0;
 	
-	return set_result( s, result );
+	do
+	{
+		int n_spans = 0;
+		
+		if ( !load_iovec( s, iov_addr, n, i, ptr, len, access, iov, n_spans, max_spans ) )
+		{
+			result = result ? result : -1;
+			break;
+		}
+		
+		const ssize_t n_transferred = transfer_spans( fd, iov, n_spans, access, result );
+		
+		if ( n_transferred < 0 )
+		{
+			result = result ? result : -1;
+			break;
+		}
+		
+		result += n_transferred;
+		
+		if ( n_transferred < total_length( iov, n_spans ) )
+		{
+			break;
+		}
+	}
+	while ( i < n  ||  len > 0 );
+	
+	if ( access == v68k::mem_write  &&  result > 0 )
+	{
+		update_iovec( s, iov_addr, n, result );
+	}
+	
+	return set_result( s, c, result );
+}
+
+static bool emu_readv( v68k::processor_state& s, syscall_context& c )
+{
+	return emu_readv_writev( s, c, v68k::mem_write );
+}
+
+static bool emu_writev( v68k::processor_state& s, syscall_context& c )
+{
+	return emu_readv_writev( s, c, v68k::mem_read );
 }
 
-static bool emu_nanosleep( v68k::processor_state& s )
+static bool emu_nanosleep( v68k::processor_state& s, syscall_context& c )
 {
 	uint32_t args[2];  // requested, remaining
 	
@@ -500,14 +1154,14 @@ static bool emu_nanosleep( v68k::processor_state& s )
 	{
 		errno = EFAULT;
 		
-		return set_result( s, -1 );
+		return set_result( s, c, -1 );
 	}
 	
 	if ( requested_nanoseconds >= 1000 * 1000 * 1000 )
 	{
 		errno = EINVAL;
 		
-		return set_result( s, -1 );
+		return set_result( s, c, -1 );
 	}
 	
 	const timespec request_ts = { requested_seconds, requested_nanoseconds };
@@ -531,26 +1185,271 @@ static bool emu_nanosleep( v68k::processor_state& s )
 		}
 	}
 	
-	return set_result( s, result );
+	return set_result( s, c, result );
+}
+
+static bool emu_pread_pwrite( v68k::processor_state&  s,
+                              syscall_context&        c,
+                              v68k::memory_access_t   access )
+{
+	uint32_t args[4];  // fd, buffer, length, offset
+	
+	if ( !get_stacked_args( s, args, 4 ) )
+	{
+		return s.bus_error();
+	}
+	
+	const int fd = host_fd( c, int32_t( args[0] ) );
+	
+	const uint32_t buffer = args[1];
+	
+	const size_t length = args[2];
+	
+	const off_t offset = int32_t( args[3] );
+	
+	if ( fd < 0 )
+	{
+		errno = EBADF;
+		
+		return set_result( s, c, -1 );
+	}
+	
+	struct iovec iov[ max_spans ];
+	
+	uint32_t addr      = buffer;
+	uint32_t remaining = length;
+	
+	/*
+		preadv() and pwritev() aren't universal, so transfer one span
+		at a time, stopping at the first short count (or error, unless
+		something was transferred already).
+	*/
+	
+	int result = 0;
+	
+	bool short_count = false;
+	
+	do
+	{
+		int n = 0;
+		
+		if ( !load_spans( s, addr, remaining, access, iov, n, max_spans ) )
+		{
+			result = result ? result : -1;
+			break;
+		}
+		
+		for ( int i = 0;  i < n;  ++i )
+		{
+			void*        base = iov[ i ].iov_base;
+			const size_t len  = iov[ i ].iov_len;
+			
+			const ssize_t n_transferred = access == v68k::mem_write
+			                            ? pread ( fd, base, len, offset + result )
+			                            : pwrite( fd, base, len, offset + result );
+			
+			if ( n_transferred < 0 )
+			{
+				result = result ? result : -1;
+				short_count = true;
+				break;
+			}
+			
+			result += n_transferred;
+			
+			if ( n_transferred < len )
+			{
+				short_count = true;
+				break;
+			}
+		}
+	}
+	while ( remaining > 0  &&  ! short_count );
+	
+	if ( access == v68k::mem_write  &&  result > 0 )
+	{
+		s.mem.update( buffer, result, s.data_space() );
+	}
+	
+	return set_result( s, c, result );
+}
+
+static bool emu_pread( v68k::processor_state& s, syscall_context& c )
+{
+	return emu_pread_pwrite( s, c, v68k::mem_write );
+}
+
+static bool emu_pwrite( v68k::processor_state& s, syscall_context& c )
+{
+	return emu_pread_pwrite( s, c, v68k::mem_read );
+}
+
+static ssize_t write_all( int fd, const char* p, size_t n, off_t* offset )
+{
+	size_t n_written = 0;
+	
+	while ( n_written < n )
+	{
+		const ssize_t result = offset ? pwrite( fd, p + n_written, n - n_written, *offset + n_written )
+		                              : write ( fd, p + n_written, n - n_written );
+		
+		if ( result < 0 )
+		{
+			return result;
+		}
+		
+		n_written += result;
+	}
+	
+	return n_written;
+}
+
+static bool emu_pump( v68k::processor_state& s, syscall_context& c )
+{
+	uint32_t args[6];  // fd_in, off_in, fd_out, off_out, count, flags
+	
+	if ( !get_stacked_args( s, args, 6 ) )
+	{
+		return s.bus_error();
+	}
+	
+	const int fd_in  = host_fd( c, int32_t( args[0] ) );
+	const int fd_out = host_fd( c, int32_t( args[2] ) );
+	
+	if ( fd_in < 0  ||  fd_out < 0 )
+	{
+		// Don't consume any input if there's nowhere for it to go.
+		
+		errno = EBADF;
+		
+		return set_result( s, c, -1 );
+	}
+	
+	const uint32_t off_in_addr  = args[1];
+	const uint32_t off_out_addr = args[3];
+	
+	const size_t count = args[4];  // 0 means until EOF
+	
+	off_t offsets[ 2 ];
+	
+	off_t* off_in  = NULL;
+	off_t* off_out = NULL;
+	
+	uint32_t offset;
+	
+	if ( off_in_addr != 0 )
+	{
+		if ( !s.mem.get_long( off_in_addr, offset, s.data_space() ) )
+		{
+			errno = EFAULT;
+			
+			return set_result( s, c, -1 );
+		}
+		
+		off_in = &(offsets[ 0 ] = int32_t( offset ));
+	}
+	
+	if ( off_out_addr != 0 )
+	{
+		if ( !s.mem.get_long( off_out_addr, offset, s.data_space() ) )
+		{
+			errno = EFAULT;
+			
+			return set_result( s, c, -1 );
+		}
+		
+		off_out = &(offsets[ 1 ] = int32_t( offset ));
+	}
+	
+	/*
+		The whole transfer happens here in the host, rather than in a
+		guest loop of read() and write() calls through the bridge.
+	*/
+	
+	const size_t buffer_size = 64 * 1024;
+	
+	char* buffer = (char*) malloc( buffer_size );
+	
+	if ( buffer == NULL )
+	{
+		errno = ENOMEM;
+		
+		return set_result( s, c, -1 );
+	}
+	
+	size_t n_pumped = 0;
+	
+	int result = 0;
+	
+	while ( count == 0  ||  n_pumped < count )
+	{
+		const size_t n = count == 0  ||  count - n_pumped > buffer_size ? buffer_size
+		                                                                : count - n_pumped;
+		
+		const ssize_t n_read = off_in ? pread( fd_in, buffer, n, *off_in + n_pumped )
+		                              : read ( fd_in, buffer, n );
+		
+		if ( n_read <= 0 )
+		{
+			result = n_read;
+			break;
+		}
+		
+		if ( write_all( fd_out, buffer, n_read, off_out ) < 0 )
+		{
+			result = -1;
+			break;
+		}
+		
+		if ( off_out )
+		{
+			*off_out += n_read;
+		}
+		
+		n_pumped += n_read;
+	}
+	
+	free( buffer );
+	
+	if ( off_in )
+	{
+		s.mem.put_long( off_in_addr, *off_in + n_pumped, s.data_space() );
+	}
+	
+	if ( off_out )
+	{
+		s.mem.put_long( off_out_addr, *off_out, s.data_space() );
+	}
+	
+	return set_result( s, c, n_pumped ? n_pumped : result );
 }
 
-bool bridge_call( v68k::processor_state& s )
+bool bridge_call( v68k::processor_state& s, syscall_context& c )
 {
 	const uint16_t call_number = s.d(0);
 	
 	switch ( call_number )
 	{
-		case 1:  return emu_exit ( s );
-		case 3:  return emu_read ( s );
-		case 4:  return emu_write( s );
+		case 1:  return emu_exit  ( s, c );
+		case 3:  return emu_read  ( s, c );
+		case 4:  return emu_write ( s, c );
+		case 5:  return emu_openat( s, c );
+		case 6:  return emu_close ( s, c );
 		
-		case 20:  return emu_getpid( s );
-		case 37:  return emu_kill  ( s );
-		case 78:  return emu_gettimeofday( s );
-		case 82:  return emu_select( s );
+		case 19:  return emu_lseek ( s, c );
+		case 20:  return emu_getpid( s, c );
+		case 37:  return emu_kill  ( s, c );
+		case 78:  return emu_gettimeofday( s, c );
+		case 82:  return emu_select( s, c );
+		case 90:  return emu_mmap  ( s, c );
+		case 91:  return emu_munmap( s, c );
 		
-		case 146:  return emu_writev( s );
-		case 162:  return emu_nanosleep( s );
+		case 145:  return emu_readv ( s, c );
+		case 146:  return emu_writev( s, c );
+		case 162:  return emu_nanosleep( s, c );
+		case 180:  return emu_pread ( s, c );
+		case 181:  return emu_pwrite( s, c );
+		case 187:  return emu_pump  ( s, c );
 		
 		default:
 			return false;
@@ -10,12 +10,65 @@
 #include "v68k/state.hh"
 
 
-extern uint32_t errno_ptr_addr;
+namespace v68k  {
+namespace alloc {
 
-extern int32_t fake_pid;
+class memory;
 
-bool bridge_call( v68k::processor_state& s );
+}  // namespace alloc
+}  // namespace v68k
 
 
-#endif
+/*
+	Per-program state for the system call bridge.  Each emulated program
+	gets its own, so several can run in one host process.
+	
+	Guest file descriptors 0-2 are mapped to fds[] (-1 once closed).
+	Others are host fds, but only those the guest opened itself (marked
+	in opened_fds) are honored; the rest are EBADF, except that read()
+	and write() pass them through (e.g. for fds inherited from a shell)
+	unless own_fds_only is set, as when several programs share a host.
+	mmap() places host mappings in alloc, and fails if it's NULL.
+	If exit_in_place is set, exit() sets exited and exit_status and
+	finishes the processor instead of exiting the host process.
+*/
+
+struct syscall_context
+{
+	enum
+	{
+		max_opened_fds = 1024,
+	};
+	
+	v68k::alloc::memory*  alloc;
+	
+	uint32_t  errno_ptr_addr;
+	int32_t   fake_pid;  // fake PID for getpid(), unless 0 or -1
+	int       fds[ 3 ];
+	uint32_t  opened_fds[ max_opened_fds / 32 ];  // bitmap of host fds
+	bool      own_fds_only;
+	bool      exit_in_place;
+	bool      exited;
+	int       exit_status;
+	
+	syscall_context()
+	:
+		alloc(),
+		errno_ptr_addr(),
+		fake_pid(),
+		opened_fds(),
+		own_fds_only(),
+		exit_in_place(),
+		exited(),
+		exit_status()
+	{
+		fds[ 0 ] = 0;
+		fds[ 1 ] = 1;
+		fds[ 2 ] = 2;
+	}
+};
 
+bool bridge_call( v68k::processor_state& s, syscall_context& context );
+
+
+#endif
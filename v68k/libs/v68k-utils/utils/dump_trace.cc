@@ -0,0 +1,160 @@
+/*
+	dump_trace.cc
+	-------------
+*/
+
+#include "dump_trace.hh"
+
+// POSIX
+#include <string.h>
+#include <unistd.h>
+
+// v68k
+#include "v68k/endian.hh"
+#include "v68k/memory.hh"
+
+
+#pragma exceptions off
+
+
+namespace v68k  {
+namespace utils {
+
+
+static char hexify( unsigned x )
+{
+	x &= 0x0F;
+	
+	return (x <= 9 ? '0' : 'a' - 10) + x;
+}
+
+static void inscribe_16( char* p, uint16_t x )
+{
+	p[0] = hexify( x >> 12 );
+	p[1] = hexify( x >>  8 );
+	p[2] = hexify( x >>  4 );
+	p[3] = hexify( x >>  0 );
+}
+
+static void inscribe_32( char* p, uint32_t x )
+{
+	inscribe_16( p,     x >> 16 );
+	inscribe_16( p + 4, x       );
+}
+
+#define LINE_TEMPLATE  "12345678:  1234  "
+
+static const char register_names[] = "D0D1D2D3D4D5D6D7A0A1A2A3A4A5A6A7";
+
+void print_trace_dump( const trace_buffer& trace, unsigned n )
+{
+	const unsigned size = trace.size();
+	
+	if ( n > size )
+	{
+		n = size;
+	}
+	
+	for ( unsigned i = size - n;  i < size;  ++i )
+	{
+		const trace_entry& entry = trace[ i ];
+		
+		char line[] = LINE_TEMPLATE "[12345678] = 12345678" "\n";
+		
+		char* p = line;
+		
+		inscribe_32( p, entry.pc );
+		
+		p += sizeof "12345678:  " - 1;
+		
+		inscribe_16( p, entry.opcode );
+		
+		p += sizeof "1234  " - 1;
+		
+		if ( entry.target == trace_memory )
+		{
+			p[ 0 ] = '[';
+			
+			inscribe_32( p + 1, entry.value );
+			
+			p += sizeof "[12345678]" - 1;
+		}
+		else if ( uint16_t( entry.target ) < 16 )
+		{
+			p[ 0 ] = register_names[ entry.target * 2     ];
+			p[ 1 ] = register_names[ entry.target * 2 + 1 ];
+			
+			p += 2;
+			
+			memcpy( p, " = ", 3 );
+			
+			inscribe_32( p + 3, entry.value );
+			
+			p += sizeof " = 12345678" - 1;
+		}
+		
+		*p++ = '\n';
+		
+		write( STDERR_FILENO, line, p - line );
+	}
+}
+
+static void get_code( const memory& mem, uint32_t pc, uint16_t* code )
+{
+	/*
+		The first word is the opcode as executed.  The rest is read back
+		from memory as it is now; any word that can't be read is zero.
+	*/
+	
+	for ( uint32_t i = 1;  i < trace_code_words;  ++i )
+	{
+		const uint32_t addr = pc + 2 * i;
+		
+		const uint8_t* p = mem.translate( addr, 2, supervisor_program_space, mem_exec );
+		
+		code[ i ] = p ? *(const uint16_t*) p : 0;  // already big-endian
+	}
+}
+
+bool write_trace_dump( int fd, const memory& mem, const trace_buffer& trace )
+{
+	const unsigned size = trace.size();
+	
+	const uint32_t header[] =
+	{
+		big_longword( 0x7636386B ),  // 'v68k'
+		big_longword( 0x54726163 ),  // 'Trac'
+		big_longword( size ),
+		big_longword( trace_record_size ),
+	};
+	
+	if ( write( fd, header, sizeof header ) != sizeof header )
+	{
+		return false;
+	}
+	
+	for ( unsigned i = 0;  i < size;  ++i )
+	{
+		const trace_entry& entry = trace[ i ];
+		
+		uint16_t record[ trace_record_size / 2 ];
+		
+		*(uint32_t*) &record[ 0 ] = big_longword( entry.pc    );
+		*(uint32_t*) &record[ 2 ] = big_longword( entry.value );
+		
+		record[ 4 ] = big_word( entry.target );
+		record[ 5 ] = big_word( entry.opcode );
+		
+		get_code( mem, entry.pc, &record[ 5 ] );
+		
+		if ( write( fd, record, sizeof record ) != sizeof record )
+		{
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+}  // namespace utils
+}  // namespace v68k
@@ -0,0 +1,50 @@
+/*
+	dump_trace.hh
+	-------------
+*/
+
+#ifndef UTILS_DUMPTRACE_HH
+#define UTILS_DUMPTRACE_HH
+
+// v68k
+#include "v68k/trace_buffer.hh"
+
+
+namespace v68k
+{
+	class memory;
+}
+
+namespace v68k  {
+namespace utils {
+
+/*
+	Trace file format
+	-----------------
+	
+	All fields are big-endian.  The header is four longwords:
+	
+		'v68k', 'Trac', record count, record size (32)
+	
+	followed by the records, oldest first:
+	
+		 0  pc      longword
+		 4  value   longword  (see trace_buffer.hh)
+		 8  target  word      (register number, -1 for memory, -2 for none)
+		10  code    11 words  (the opcode and the code following it)
+	
+	The code is read back from memory when the trace is written, so it
+	includes any extension words.  `d68k --trace` disassembles the file.
+*/
+
+const uint32_t trace_record_size = 32;
+const uint32_t trace_code_words  = 11;
+
+void print_trace_dump( const trace_buffer& trace, unsigned n );
+
+bool write_trace_dump( int fd, const memory& mem, const trace_buffer& trace );
+
+}  // namespace utils
+}  // namespace v68k
+
+#endif
@@ -174,6 +174,18 @@ namespace v68k
 			return &storage;
 		}
 		
+		if ( (opcode & 0xF9C0) == 0x08C0  &&  ea_is_memory_alterable( mode, n ) )
+		{
+			// CAS (but not CAS2, whose mode 7 / n 4 isn't memory alterable)
+			
+			storage.size  = op_size_t( opcode >> 9 & 0x3 );
+			storage.fetch = fetches_CAS;
+			storage.code  = microcode_CAS;
+			storage.flags = loads_and | stores_data | CCR_update_sub | not_before_68020;
+			
+			return &storage;
+		}
+		
 		return 0;  // NULL
 	}
 	
@@ -526,10 +538,53 @@ namespace v68k
 		&microcode_ROL
 	};
 	
+	static const microcode bit_field_microcodes[] =
+	{
+		&microcode_BFTST,
+		&microcode_BFEXTU,
+		&microcode_BFCHG,
+		&microcode_BFEXTS,
+		&microcode_BFCLR,
+		&microcode_BFFFO,
+		&microcode_BFSET,
+		&microcode_BFINS
+	};
+	
+	static const instruction* decode_bit_field( uint16_t opcode, instruction& storage )
+	{
+		const uint16_t mode = opcode >> 3 & 0x7;
+		const uint16_t n    = opcode >> 0 & 0x7;
+		
+		const int i = (opcode & 0x0700) >> 8;
+		
+		// BFTST, BFEXTU, BFEXTS, and BFFFO only read the field
+		
+		const bool read_only = i == 0  ||  i == 1  ||  i == 3  ||  i == 5;
+		
+		const bool valid = ea_is_data_register( mode )  ||  (ea_is_control( mode, n )  &&  (read_only  ||  ea_is_alterable( mode, n )));
+		
+		if ( !valid )
+		{
+			return 0;  // NULL
+		}
+		
+		storage.size  = byte_sized;  // fields are byte-addressed
+		storage.fetch = fetches_bit_field;
+		storage.code  = bit_field_microcodes[ i ];
+		storage.flags = not_before_68020;
+		
+		return &storage;
+	}
+	
 	static const instruction* decode_line_E( uint16_t opcode, instruction& storage )
 	{
 		const uint16_t size_code = opcode >> 6 & 0x3;
 		
+		if ( size_code == 3  &&  opcode & 0x0800 )
+		{
+			return decode_bit_field( opcode, storage );
+		}
+		
 		int i;
 		
 		if ( size_code != 3 )
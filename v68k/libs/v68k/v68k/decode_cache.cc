@@ -0,0 +1,104 @@
+/*
+	decode_cache.cc
+	---------------
+*/
+
+#include "v68k/decode_cache.hh"
+
+// v68k
+#include "v68k/decode.hh"
+#include "v68k/specialized_fetches.hh"
+
+
+#pragma exceptions off
+
+
+namespace v68k
+{
+	
+	void decode_cache::flush()
+	{
+		for ( int i = 0;  i < n_entries;  ++i )
+		{
+			// Instructions are never fetched from odd addresses.
+			
+			its_entries[ i ].pc = 1;
+		}
+	}
+	
+	static op_size_t resolved_size( op_size_t size, uint16_t opcode )
+	{
+		if ( size > max_actual_size )
+		{
+			const uint16_t size_mask = size;
+			
+			const int bit_offset = size & op_size_shift_mask;
+			
+			// 1 if 0 means byte-sized, 2 if 0 means word-sized
+			const uint32_t index_of_zero = 1 + (size & 1);
+			
+			size = op_size_t( ((opcode & size_mask) >> bit_offset) + index_of_zero );
+		}
+		
+		return size;
+	}
+	
+	static CCR_updater bound_CCR_updater( instruction_flags_t flags )
+	{
+		typedef instruction_flags_t flags_t;
+		
+		if ( const flags_t ccr_flags = flags_t( flags & CCR_update_mask ) )
+		{
+			return the_CCR_updaters[ ccr_flags >> CCR_update_shift ];
+		}
+		
+		return 0;  // NULL
+	}
+	
+	static bool CCR_updater_reads_nzvc( instruction_flags_t flags )
+	{
+		const int index = (flags & CCR_update_mask) >> CCR_update_shift;
+		
+		const int ADDX = ADDX_CCR_update >> CCR_update_shift;
+		const int SUBX = SUBX_CCR_update >> CCR_update_shift;
+		const int BTST = BTST_CCR_update >> CCR_update_shift;
+		
+		return index == ADDX  ||  index == SUBX  ||  index == BTST;
+	}
+	
+	const decode_cache_entry& decode_cache::miss( decode_cache_entry&  entry,
+	                                              uint32_t             pc,
+	                                              uint16_t             opcode )
+	{
+		instruction storage = { 0 };
+		
+		const instruction* decoded = v68k::decode( opcode, storage );
+		
+		entry.pc     = pc;
+		entry.opcode = opcode;
+		
+		if ( decoded == 0 )  // NULL
+		{
+			entry.decoded = storage;
+			
+			entry.decoded.code = 0;  // NULL
+			entry.fetch        = 0;  // NULL
+			entry.update_CCR   = 0;  // NULL
+			
+			return entry;
+		}
+		
+		entry.decoded = *decoded;
+		
+		entry.decoded.size = resolved_size( decoded->size, opcode );
+		
+		entry.fetch = specialized_fetcher( entry.decoded, opcode );
+		
+		entry.update_CCR = bound_CCR_updater( decoded->flags );
+		
+		entry.update_CCR_reads_nzvc = CCR_updater_reads_nzvc( decoded->flags );
+		
+		return entry;
+	}
+	
+}
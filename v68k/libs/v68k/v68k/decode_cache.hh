@@ -0,0 +1,81 @@
+/*
+	decode_cache.hh
+	---------------
+*/
+
+#ifndef V68K_DECODECACHE_HH
+#define V68K_DECODECACHE_HH
+
+// C99
+#include <stdint.h>
+
+// v68k
+#include "v68k/instruction.hh"
+#include "v68k/update_CCR.hh"
+
+
+namespace v68k
+{
+	
+	/*
+		A direct-mapped cache of decoded instructions, keyed by guest PC.
+		
+		decode() is a pure function of the opcode word, and step() always
+		has the current opcode in hand (it was prefetched), so each entry is
+		tagged with both the PC and the opcode it was decoded from.  A store
+		into the code (from the guest or from the host) changes the opcode
+		and simply causes a miss -- no write notification is needed.
+		
+		Entries whose code is NULL record opcodes that failed to decode,
+		so that line-A and line-F traps are cached as well.
+		
+		Entries are pre-bound:  The operand size is resolved from the opcode
+		(so decoded.size is always an actual size or unsized), and the CCR
+		updater is looked up once, on a miss, rather than per instruction.
+		For the most frequent instructions, fetch is a single fetcher that
+		replaces the decoded.fetch sequence (see specialized_fetches.hh).
+	*/
+	
+	struct decode_cache_entry
+	{
+		uint32_t     pc;
+		uint16_t     opcode;
+		instruction  decoded;
+		fetcher      fetch;       // NULL if decoded.fetch must be walked
+		CCR_updater  update_CCR;  // NULL if the instruction doesn't touch CCR
+		bool         update_CCR_reads_nzvc;  // ADDX, SUBX, and BTST
+	};
+	
+	class decode_cache
+	{
+		private:
+			enum
+			{
+				n_entries = 2048,  // covers 4K of contiguous code
+			};
+			
+			decode_cache_entry its_entries[ n_entries ];
+			
+			const decode_cache_entry& miss( decode_cache_entry& entry, uint32_t pc, uint16_t opcode );
+		
+		public:
+			decode_cache()  { flush(); }
+			
+			void flush();
+			
+			const decode_cache_entry& lookup( uint32_t pc, uint16_t opcode )
+			{
+				decode_cache_entry& entry = its_entries[ pc >> 1 & (n_entries - 1) ];
+				
+				if ( entry.pc != pc  ||  entry.opcode != opcode )
+				{
+					return miss( entry, pc, opcode );
+				}
+				
+				return entry;
+			}
+	};
+	
+}
+
+#endif
@@ -75,9 +75,14 @@ namespace v68k
 		
 		const bool base_suppress  = extension & 0x80;
 		
+		if ( base_suppress )
+		{
+			address = 0;  // suppress the base register (An or PC)
+		}
+		
 		const uint16_t bd_size = extension >> 4 & 0x3;
 		
-		base_displacement = read_extended_displacement( s, bd_size ) & -!base_suppress;
+		base_displacement = read_extended_displacement( s, bd_size );
 		
 		const bool index_suppress = extension & 0x40;
 		
@@ -102,7 +107,7 @@ namespace v68k
 				for misaligned data accesses.
 			*/
 			
-			if ( !s.mem.get_long( address, address, s.data_space() ) )
+			if ( !s.get_long( address, address, s.data_space() ) )
 			{
 				return s.bus_error();
 			}
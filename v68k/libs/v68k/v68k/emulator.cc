@@ -6,11 +6,9 @@
 #include "v68k/emulator.hh"
 
 // v68k
-#include "v68k/decode.hh"
 #include "v68k/endian.hh"
 #include "v68k/instruction.hh"
 #include "v68k/load_store.hh"
-#include "v68k/update_CCR.hh"
 
 
 #pragma exceptions off
@@ -26,11 +24,95 @@ namespace v68k
 	};
 	
 	
+	static inline void atomic_set_bits( volatile uint16_t& x, uint16_t bits )
+	{
+	#ifdef __GNUC__
+		
+		__sync_fetch_and_or( &x, bits );
+		
+	#else
+		
+		x |= bits;  // no preemptive threads
+		
+	#endif
+	}
+	
+	static inline void atomic_clear_bits( volatile uint16_t& x, uint16_t bits )
+	{
+	#ifdef __GNUC__
+		
+		__sync_fetch_and_and( &x, ~bits );
+		
+	#else
+		
+		x &= ~bits;  // no preemptive threads
+		
+	#endif
+	}
+	
+	static inline uint16_t interrupt_level_bits( int level )
+	{
+		return level == 7 ? 0x0180 : 1 << level;
+	}
+	
+	
 	emulator::emulator( processor_model model, const memory& mem, bkpt_handler bkpt )
 	:
 		processor_state( model, mem, bkpt ),
-		its_instruction_counter()
+		its_instruction_counter(),
+		its_line_A_handler(),
+		its_interrupt_levels(),
+		its_interrupt_vectors()
+	{
+	}
+	
+	void emulator::post_interrupt( int level, uint8_t vector )
+	{
+		if ( level < 1  ||  level > 7 )
+		{
+			return;
+		}
+		
+		// Store the vector first, so it's there when the level is seen.
+		
+		its_interrupt_vectors[ level ] = vector;
+		
+		atomic_set_bits( its_interrupt_levels, interrupt_level_bits( level ) );
+	}
+	
+	void emulator::acknowledge_interrupt()
 	{
+		if ( condition != normal  &&  condition != stopped )
+		{
+			return;
+		}
+		
+		int level = 7;
+		
+		while ( !(its_interrupt_levels & 1 << level) )
+		{
+			--level;
+		}
+		
+		/*
+			Clear the request before reading the vector.  If the level is
+			posted again meanwhile, its bit is set again and it's taken
+			again -- but no request is lost.
+		*/
+		
+		atomic_clear_bits( its_interrupt_levels, interrupt_level_bits( level ) );
+		
+		const uint8_t vector = its_interrupt_vectors[ level ];
+		
+		if ( condition == stopped )
+		{
+			condition = normal;
+		}
+		
+		if ( take_exception_format_0( vector * sizeof (uint32_t) ) )
+		{
+			sr.iii = level;
+		}
 	}
 	
 	void emulator::double_bus_fault()
@@ -42,6 +124,14 @@ namespace v68k
 	{
 		condition = normal;
 		
+		its_decode_cache.flush();
+		
+		its_trace.clear();
+		
+		tlb.flush();
+		
+		its_interrupt_levels = 0;
+		
 		regs[ VBR ] = 0;
 		
 		/*
@@ -69,6 +159,8 @@ namespace v68k
 			sr.   x = 0;  // clear CCR
 			sr.nzvc = 0;
 			
+			pending_CCR_update = 0;  // NULL
+			
 			const reset_vector* v = (const reset_vector*) zero;
 			
 			a(7) = longword_from_big( v->isp );
@@ -79,8 +171,13 @@ namespace v68k
 		}
 	}
 	
-	bool emulator::step()
+	inline bool emulator::execute_instruction()
 	{
+		if ( interrupt_pending() )
+		{
+			acknowledge_interrupt();
+		}
+		
 	bkpt_acknowledge:
 		
 		if ( condition != normal )
@@ -89,15 +186,27 @@ namespace v68k
 		}
 		
 		// decode (prefetched)
-		instruction storage = { 0 };
+		const decode_cache_entry& cached = its_decode_cache.lookup( pc(), opcode );
 		
-		const instruction* decoded = decode( opcode, storage );
+		const instruction* decoded = &cached.decoded;
 		
-		if ( !decoded )
+		if ( !decoded->code )
 		{
 			switch ( opcode >> 12 )
 			{
 				case 0xA:
+					if ( its_line_A_handler  &&  (sr.ttsm >> 2) == 0 )
+					{
+						if ( its_line_A_handler( *this, opcode ) )
+						{
+							++its_instruction_counter;
+							
+							prefetch_instruction_word();
+							
+							return condition == normal;
+						}
+					}
+					
 					return line_A_emulator();
 				
 				case 0xF:
@@ -120,40 +229,45 @@ namespace v68k
 		
 		const uint32_t instruction_address = pc();
 		
+		trace_entry& traced = its_trace.next();
+		
+		traced.pc     = instruction_address;
+		traced.opcode = opcode;
+		traced.target = trace_none;
+		
 		// advance pc
 		pc() += 2;
 		
 		// fetch
-		fetcher* fetch = decoded->fetch;
-		
 		op_params pb;
 		
-		pb.size = decoded->size;
-		
-		if ( pb.size > max_actual_size )
-		{
-			const uint16_t size_mask = pb.size;
-			
-			const int bit_offset = pb.size & op_size_shift_mask;
-			
-			// 1 if 0 means byte-sized, 2 if 0 means word-sized
-			const uint32_t index_of_zero = 1 + (pb.size & 1);
-			
-			pb.size = op_size_t( ((opcode & size_mask) >> bit_offset) + index_of_zero );
-		}
-		
+		pb.size    = decoded->size;  // already resolved by the decode cache
 		pb.target  = uint32_t( -1 );
 		pb.address = pc();
 		
-		while ( *fetch != 0 )  // NULL
+		if ( const fetcher specialized = cached.fetch )
 		{
-			(*fetch++)( *this, pb );
+			specialized( *this, pb );
 			
 			if ( condition != normal )
 			{
 				return false;
 			}
 		}
+		else
+		{
+			fetcher* fetch = decoded->fetch;
+			
+			while ( *fetch != 0 )  // NULL
+			{
+				(*fetch++)( *this, pb );
+				
+				if ( condition != normal )
+				{
+					return false;
+				}
+			}
+		}
 		
 		// load/store prep
 		
@@ -215,22 +329,16 @@ namespace v68k
 		
 		// update CCR
 		
-		typedef instruction_flags_t flags_t;
-		
-		if ( const flags_t ccr_flags = flags_t( decoded->flags & CCR_update_mask ) )
+		if ( const CCR_updater update_CCR = cached.update_CCR )
 		{
 			if ( int32_t( pb.target ) <= 7  ||  decoded->flags & CCR_update_An )
 			{
 				// Don't update CCR targeting address registers unless requested
 				
-				const int index = ccr_flags >> CCR_update_shift;
-				
-				the_CCR_updaters[ index ]( *this, pb );
-				
-				if ( decoded->flags & CCR_update_set_X )
-				{
-					sr.x = sr.nzvc & 0x1;
-				}
+				defer_CCR_update( update_CCR,
+				                  decoded->flags & CCR_update_set_X,
+				                  cached.update_CCR_reads_nzvc,
+				                  pb );
 			}
 		}
 		
@@ -241,6 +349,14 @@ namespace v68k
 			return bus_error();
 		}
 		
+		if ( decoded->flags & stores_data )
+		{
+			const bool to_register = int32_t( pb.target ) >= 0;
+			
+			traced.target = to_register ? int16_t( pb.target ) : int16_t( trace_memory );
+			traced.value  = to_register ? regs[ pb.target ]    : pb.address;
+		}
+		
 		++its_instruction_counter;
 		
 		if ( (saved_ttsm >> 2) - 1 > 0  &&  condition >= normal )
@@ -259,13 +375,45 @@ namespace v68k
 		return condition == normal;
 	}
 	
+	bool emulator::step()
+	{
+		const bool ok = execute_instruction();
+		
+		flush_CCR();
+		
+		return ok;
+	}
+	
+	bool emulator::run( unsigned long n_instructions )
+	{
+		/*
+			Execute up to n_instructions back to back, without returning to
+			the caller in between.  Stop early (returning false) as soon as
+			the processor leaves the normal condition, just as step() would.
+		*/
+		
+		bool ok = true;
+		
+		while ( n_instructions-- > 0 )
+		{
+			if ( !(ok = execute_instruction()) )
+			{
+				break;
+			}
+		}
+		
+		flush_CCR();
+		
+		return ok  &&  condition == normal;
+	}
+	
 	void emulator::prefetch_instruction_word()
 	{
 		if ( pc() & 1 )
 		{
 			address_error();
 		}
-		else if ( !mem.get_instruction_word( pc(), opcode, program_space() ) )
+		else if ( !get_instruction_word( pc(), opcode, program_space() ) )
 		{
 			bus_error();
 		}
@@ -290,9 +438,9 @@ namespace v68k
 		
 		const uint32_t format_and_offset = 0 << 12 | vector_offset;
 		
-		const bool ok = mem.put_word( sp + 0, saved_sr,          supervisor_data_space )
-		              & mem.put_long( sp + 2, pc(),              supervisor_data_space )
-		              & mem.put_word( sp + 6, format_and_offset, supervisor_data_space );
+		const bool ok = put_word( sp + 0, saved_sr,          supervisor_data_space )
+		              & put_long( sp + 2, pc(),              supervisor_data_space )
+		              & put_word( sp + 6, format_and_offset, supervisor_data_space );
 		
 		if ( !ok )
 		{
@@ -304,7 +452,7 @@ namespace v68k
 			return address_error();
 		}
 		
-		if ( !mem.get_long( regs[ VBR ] + vector_offset, pc(), supervisor_data_space ) )
+		if ( !get_long( regs[ VBR ] + vector_offset, pc(), supervisor_data_space ) )
 		{
 			return bus_error();
 		}
@@ -333,10 +481,10 @@ namespace v68k
 		
 		const uint32_t format_and_offset = 2 << 12 | vector_offset;
 		
-		const bool ok = mem.put_word( sp + 0, saved_sr,            supervisor_data_space )
-		              & mem.put_long( sp + 2, pc(),                supervisor_data_space )
-		              & mem.put_word( sp + 6, format_and_offset,   supervisor_data_space )
-		              & mem.put_long( sp + 8, instruction_address, supervisor_data_space );
+		const bool ok = put_word( sp + 0, saved_sr,            supervisor_data_space )
+		              & put_long( sp + 2, pc(),                supervisor_data_space )
+		              & put_word( sp + 6, format_and_offset,   supervisor_data_space )
+		              & put_long( sp + 8, instruction_address, supervisor_data_space );
 		
 		if ( !ok )
 		{
@@ -348,7 +496,7 @@ namespace v68k
 			return address_error();
 		}
 		
-		if ( !mem.get_long( regs[ VBR ] + vector_offset, pc(), supervisor_data_space ) )
+		if ( !get_long( regs[ VBR ] + vector_offset, pc(), supervisor_data_space ) )
 		{
 			return bus_error();
 		}
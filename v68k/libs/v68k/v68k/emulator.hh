@@ -10,28 +10,85 @@
 #include <stdint.h>
 
 // v68k
+#include "v68k/decode_cache.hh"
 #include "v68k/state.hh"
+#include "v68k/trace_buffer.hh"
 
 
 namespace v68k
 {
 	
+	/*
+		A line A handler gets the first look at each A-line instruction,
+		with the PC still at the trap word.  If it performs the trap itself,
+		it leaves the PC at the next instruction to execute and returns
+		true.  Otherwise it returns false (having changed nothing), and the
+		Line A Emulator exception is taken as usual.  It's not called while
+		tracing, so the trace exception sees every instruction.
+	*/
+	
+	typedef bool (*line_A_handler)( processor_state& s, uint16_t trap );
+	
 	class emulator : public processor_state
 	{
 		private:
 			unsigned long its_instruction_counter;
 			
+			decode_cache its_decode_cache;
+			
+			trace_buffer its_trace;
+			
+			line_A_handler its_line_A_handler;
+			
+			/*
+				Interrupt requests may be posted from any thread.  Bit N of
+				its_interrupt_levels is set while level N is requested, with
+				its vector number in its_interrupt_vectors[ N ].  Level 7 is
+				non-maskable, so it also sets bit 8.  That way, shifting out
+				the masked levels leaves a nonzero value exactly when there's
+				an interrupt to take.
+			*/
+			
+			volatile uint16_t its_interrupt_levels;
+			volatile uint8_t  its_interrupt_vectors[ 8 ];
+			
+			void acknowledge_interrupt();
+			
 			void double_bus_fault();
+			
+			bool execute_instruction();
 		
 		public:
 			emulator( processor_model model, const memory& mem, bkpt_handler bkpt = 0 );  // NULL
 			
 			unsigned long instruction_count() const  { return its_instruction_counter; }
 			
+			const trace_buffer& trace() const  { return its_trace; }
+			
+			void set_line_A_handler( line_A_handler handler )
+			{
+				its_line_A_handler = handler;
+			}
+			
+			// Thread-safe.  Taking the interrupt ends the stopped condition.
+			void post_interrupt( int level, uint8_t vector );
+			
+			void post_autovector_interrupt( int level )
+			{
+				post_interrupt( level, 24 + level );
+			}
+			
+			bool interrupt_pending() const
+			{
+				return its_interrupt_levels >> (sr.iii + 1);
+			}
+			
 			void reset();
 			
 			bool step();
 			
+			bool run( unsigned long n_instructions );
+			
 			void prefetch_instruction_word();
 			
 			bool take_exception_format_0( uint16_t vector_offset );
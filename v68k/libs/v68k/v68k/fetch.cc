@@ -27,7 +27,7 @@ namespace v68k
 		
 		uint16_t word;
 		
-		if ( !s.mem.get_instruction_word( s.pc(), word, s.program_space() ) )
+		if ( !s.get_instruction_word( s.pc(), word, s.program_space() ) )
 		{
 			return s.bus_error();
 		}
@@ -302,6 +302,8 @@ namespace v68k
 	
 	void add_X_to_first( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		pb.first += s.sr.x & 0x1;
 	}
 	
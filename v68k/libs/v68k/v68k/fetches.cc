@@ -101,6 +101,14 @@ namespace v68k
 	};
 	
 	
+	fetcher fetches_CAS[] =
+	{
+		&fetch_unsigned_word,
+		&fetch_effective_address,
+		0  // NULL
+	};
+	
+	
 	fetcher fetches_MOVE[] =
 	{
 		&fetch_sized_data_at_effective_address,
@@ -132,6 +140,15 @@ namespace v68k
 	};
 	
 	
+	fetcher fetches_MULL_DIVL[] =
+	{
+		&fetch_unsigned_word,
+		&assign_first_to_second,  // extension word
+		&fetch_sized_data_at_effective_address,
+		0  // NULL
+	};
+	
+	
 	fetcher fetches_TRAP[] =
 	{
 		&fetch_data_at_000F,
@@ -319,5 +336,12 @@ namespace v68k
 		0  // NULL
 	};
 	
+	fetcher fetches_bit_field[] =
+	{
+		&fetch_unsigned_word,
+		&fetch_effective_address,
+		0  // NULL
+	};
+	
 }
 
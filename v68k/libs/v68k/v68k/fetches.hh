@@ -35,6 +35,8 @@ namespace v68k
 	
 	extern fetcher fetches_MOVES[];
 	
+	extern fetcher fetches_CAS[];
+	
 	extern fetcher fetches_MOVE[];
 	
 	extern fetcher fetches_LEA[];
@@ -43,6 +45,8 @@ namespace v68k
 	
 	extern fetcher fetches_MOVEM[];
 	
+	extern fetcher fetches_MULL_DIVL[];
+	
 	extern fetcher fetches_TRAP[];
 	
 	extern fetcher fetches_LINK[];
@@ -88,6 +92,8 @@ namespace v68k
 	extern fetcher fetches_bit_shift_Dn [];
 	extern fetcher fetches_bit_shift_mem[];
 	
+	extern fetcher fetches_bit_field[];
+	
 }
 
 #endif
@@ -279,6 +279,25 @@ namespace v68k
 		return 0;  // NULL
 	}
 	
+	static const instruction* decode_MULL_DIVL( uint16_t opcode, instruction& storage )
+	{
+		const uint16_t mode = opcode >> 3 & 0x7;
+		const uint16_t n    = opcode >> 0 & 0x7;
+		
+		if ( (opcode & 0x0080)  ||  !ea_is_data( mode, n ) )
+		{
+			return 0;  // NULL
+		}
+		
+		storage.size  = long_sized;
+		storage.fetch = fetches_MULL_DIVL;
+		storage.code  = opcode & 0x0040 ? microcode_DIVL
+		                                : microcode_MULL;
+		storage.flags = not_before_68020;
+		
+		return &storage;
+	}
+	
 	const instruction* decode_line_4( uint16_t opcode, instruction& storage )
 	{
 		if ( opcode & 0x0100 )
@@ -353,7 +372,7 @@ namespace v68k
 			
 			case 0x4c00:
 				// MULL, DIVL (MOVEM handled above)
-				return 0;  // NULL
+				return decode_MULL_DIVL( opcode, storage );
 			
 			case 0x4e00:
 				return decode_4e( opcode, storage );
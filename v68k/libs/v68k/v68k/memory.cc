@@ -5,8 +5,11 @@
 
 #include "v68k/memory.hh"
 
+// Standard C
+#include <string.h>
+
 // v68k
-#include "v68k/endian.hh"
+#include "v68k/memory_access.hh"
 
 
 #pragma exceptions off
@@ -15,86 +18,9 @@
 namespace v68k
 {
 	
-	static inline uint8_t read_byte( const uint8_t* addr )
-	{
-		return *addr;
-	}
-	
-	static inline void write_byte( uint8_t* addr, uint8_t x )
-	{
-		*addr = x;
-	}
-	
-	
-	static inline uint16_t read_word_aligned( const uint8_t* addr )
-	{
-		return *(const uint16_t*) addr;
-	}
-	
-	static inline void write_word_aligned( uint8_t* addr, uint16_t x )
-	{
-		*(uint16_t*) addr = x;
-	}
-	
-	static inline uint32_t read_long_aligned( const uint8_t* addr )
-	{
-		return *(const uint32_t*) addr;
-	}
-	
-	static inline void write_long_aligned( uint8_t* addr, uint32_t x )
-	{
-		*(uint32_t*) addr = x;
-	}
-	
-	
-	static inline uint16_t read_big_word_aligned( const uint8_t* addr )
-	{
-		return word_from_big( read_word_aligned( addr ) );
-	}
-	
-	static inline void write_big_word_aligned( uint8_t* addr, uint16_t x )
-	{
-		write_word_aligned( addr, big_word( x ) );
-	}
-	
-	static inline uint32_t read_big_longword_aligned( const uint8_t* addr )
-	{
-		return longword_from_big( read_long_aligned( addr ) );
-	}
-	
-	static inline void write_big_long_aligned( uint8_t* addr, uint32_t x )
-	{
-		write_long_aligned( addr, big_longword( x ) );
-	}
-	
-	
-	static inline uint16_t read_big_word_unaligned( const uint8_t* addr )
-	{
-		return addr[0] << 8 | addr[1];
-	}
-	
-	static inline void write_big_word_unaligned( uint8_t* addr, uint16_t x )
+	uint8_t* memory::translate_page( uint32_t page_addr, function_code_t fc, memory_access_t access ) const
 	{
-		addr[0] = x >> 8;
-		addr[1] = x & 0xFF;
-	}
-	
-	static inline uint32_t read_big_long_unaligned( const uint8_t* addr )
-	{
-		const uint32_t big_endian = addr[0] << 24
-		                          | addr[1] << 16
-		                          | addr[2] <<  8
-		                          | addr[3];
-		
-		return big_endian;
-	}
-	
-	static inline void write_big_long_unaligned( uint8_t* addr, uint32_t x )
-	{
-		addr[0] = x >> 24;
-		addr[1] = x >> 16 & 0xFF;
-		addr[2] = x >>  8 & 0xFF;
-		addr[3] = x       & 0xFF;
+		return 0;  // NULL
 	}
 	
 	
@@ -191,6 +117,176 @@ namespace v68k
 	}
 	
 	
+	uint32_t memory::translate_span( uint32_t          addr,
+	                                 uint32_t          length,
+	                                 function_code_t   fc,
+	                                 memory_access_t   access,
+	                                 uint8_t*&         p ) const
+	{
+		if ( (p = translate( addr, length, fc, access )) )
+		{
+			return length;  // The usual case:  all in one region
+		}
+		
+		/*
+			If a range translates, so does every leading part of it, so
+			binary search for the longest one.  (Region boundaries aren't
+			necessarily page-aligned -- e.g. Mac low memory in xv68k.)
+		*/
+		
+		uint32_t good = 0;
+		uint32_t bad  = length;
+		
+		while ( bad - good > 1 )
+		{
+			const uint32_t mid = good + (bad - good) / 2;
+			
+			if ( uint8_t* q = translate( addr, mid, fc, access ) )
+			{
+				p    = q;
+				good = mid;
+			}
+			else
+			{
+				bad = mid;
+			}
+		}
+		
+		return good;
+	}
+	
+	void memory::update( uint32_t addr, uint32_t length, function_code_t fc ) const
+	{
+		while ( length > 0 )
+		{
+			uint8_t* p;
+			
+			const uint32_t n = translate_span( addr, length, fc, mem_write, p );
+			
+			if ( n == 0 )
+			{
+				break;
+			}
+			
+			translate( addr, n, fc, mem_update );
+			
+			addr   += n;
+			length -= n;
+		}
+	}
+	
+	bool memory::get_bytes( uint32_t addr, uint8_t* x, uint32_t n, function_code_t fc ) const
+	{
+		while ( n > 0 )
+		{
+			uint8_t* p;
+			
+			const uint32_t span = translate_span( addr, n, fc, mem_read, p );
+			
+			if ( span == 0 )
+			{
+				return false;
+			}
+			
+			memcpy( x, p, span );
+			
+			addr += span;
+			x    += span;
+			n    -= span;
+		}
+		
+		return true;
+	}
+	
+	bool memory::put_bytes( uint32_t addr, const uint8_t* x, uint32_t n, function_code_t fc ) const
+	{
+		while ( n > 0 )
+		{
+			uint8_t* p;
+			
+			const uint32_t span = translate_span( addr, n, fc, mem_write, p );
+			
+			if ( span == 0 )
+			{
+				return false;
+			}
+			
+			memcpy( p, x, span );
+			
+			translate( addr, span, fc, mem_update );
+			
+			addr += span;
+			x    += span;
+			n    -= span;
+		}
+		
+		return true;
+	}
+	
+	bool memory::copy( uint32_t dst, uint32_t src, uint32_t n, function_code_t fc ) const
+	{
+		if ( dst - src < n )
+		{
+			/*
+				The destination overlaps the end of the source, so copy
+				backward.  Spans are found going forward, so bounce each
+				chunk through a buffer instead.
+			*/
+			
+			uint8_t buffer[ 4096 ];
+			
+			while ( n > 0 )
+			{
+				const uint32_t chunk = n < sizeof buffer ? n : sizeof buffer;
+				
+				n -= chunk;
+				
+				if ( !get_bytes( src + n, buffer, chunk, fc )  ||
+				     !put_bytes( dst + n, buffer, chunk, fc ) )
+				{
+					return false;
+				}
+			}
+			
+			return true;
+		}
+		
+		while ( n > 0 )
+		{
+			uint8_t* p;
+			uint8_t* q;
+			
+			/*
+				Translate the destination first:  Translating for write may
+				replace a shared page with a private copy and release what
+				it was shared from, which the source could have been in.
+			*/
+			
+			uint32_t span = translate_span( dst, n, fc, mem_write, q );
+			
+			if ( span != 0 )
+			{
+				span = translate_span( src, span, fc, mem_read, p );
+			}
+			
+			if ( span == 0 )
+			{
+				return false;
+			}
+			
+			memmove( q, p, span );
+			
+			translate( dst, span, fc, mem_update );
+			
+			dst += span;
+			src += span;
+			n   -= span;
+		}
+		
+		return true;
+	}
+	
+	
 	memory_region::memory_region( uint8_t* mem_base, uint32_t mem_size )
 	:
 		base( mem_base ),
@@ -208,6 +304,16 @@ namespace v68k
 		return base + addr;
 	}
 	
+	uint8_t* memory_region::translate_page( uint32_t page_addr, function_code_t fc, memory_access_t access ) const
+	{
+		if ( translation_page_size > size  ||  page_addr > size - translation_page_size )
+		{
+			return 0;  // NULL
+		}
+		
+		return base + page_addr;
+	}
+	
 	
 	low_memory_region::low_memory_region( uint8_t* mem_base, uint32_t mem_size )
 	:
@@ -237,5 +343,19 @@ namespace v68k
 		return memory_region::translate( addr, length, fc, access );
 	}
 	
+	uint8_t* low_memory_region::translate_page( uint32_t page_addr, function_code_t fc, memory_access_t access ) const
+	{
+		if ( page_addr < 1024 )
+		{
+			if ( fc <= user_program_space  ||  access == mem_exec )
+			{
+				// The system vectors are off limits, as in translate() above
+				
+				return 0;  // NULL
+			}
+		}
+		
+		return memory_region::translate_page( page_addr, fc, access );
+	}
+	
 }
-
@@ -33,6 +33,10 @@ namespace v68k
 		mem_update = 0x3
 	};
 	
+	const int translation_page_size_bits = 12;
+	
+	const uint32_t translation_page_size = 1 << translation_page_size_bits;  // 4K
+	
 	class memory
 	{
 		public:
@@ -45,6 +49,17 @@ namespace v68k
 			
 			virtual uint8_t* translate( uint32_t addr, uint32_t length, function_code_t fc, memory_access_t access ) const = 0;
 			
+			/*
+				Return the host address of a whole translation page, if (and
+				only if) every address in the page translates linearly for the
+				given function code and access type.  For mem_write, this also
+				means that stores don't need a mem_update notification.  Such
+				translations may be cached (see v68k/tlb.hh).  The default is
+				to return NULL, which means the page can't be cached.
+			*/
+			
+			virtual uint8_t* translate_page( uint32_t page_addr, function_code_t fc, memory_access_t access ) const;
+			
 			bool get_byte( uint32_t addr, uint8_t & x, function_code_t fc ) const;
 			bool get_word( uint32_t addr, uint16_t& x, function_code_t fc ) const;
 			bool get_long( uint32_t addr, uint32_t& x, function_code_t fc ) const;
@@ -54,6 +69,38 @@ namespace v68k
 			bool put_long( uint32_t addr, uint32_t x, function_code_t fc ) const;
 			
 			bool get_instruction_word( uint32_t addr, uint16_t& x, function_code_t fc ) const;
+			
+			/*
+				Return the length of the longest leading part of the range
+				(up to length bytes) that translates as a single contiguous
+				host span, and set p to its host address.  If addr itself
+				doesn't translate, return 0.  A range within one region costs
+				one translate() call; one that crosses a region boundary is
+				split there.
+			*/
+			
+			uint32_t translate_span( uint32_t          addr,
+			                         uint32_t          length,
+			                         function_code_t   fc,
+			                         memory_access_t   access,
+			                         uint8_t*&         p ) const;
+			
+			// Send mem_update for a stored range, once per span.
+			void update( uint32_t addr, uint32_t length, function_code_t fc ) const;
+			
+			/*
+				Bulk transfers of ranges that may cross region boundaries,
+				with one translate() and memcpy() per span.  A false return
+				means that part of the range doesn't translate, although a
+				leading part of it may have been copied already.  copy()
+				handles overlapping ranges, like memmove().
+			*/
+			
+			bool get_bytes( uint32_t addr, uint8_t* x, uint32_t n, function_code_t fc ) const;
+			
+			bool put_bytes( uint32_t addr, const uint8_t* x, uint32_t n, function_code_t fc ) const;
+			
+			bool copy( uint32_t dst, uint32_t src, uint32_t n, function_code_t fc ) const;
 	};
 	
 	class memory_region : public memory
@@ -66,6 +113,8 @@ namespace v68k
 			memory_region( uint8_t* mem_base, uint32_t mem_size );
 			
 			uint8_t* translate( uint32_t addr, uint32_t length, function_code_t fc, memory_access_t access ) const;
+			
+			uint8_t* translate_page( uint32_t page_addr, function_code_t fc, memory_access_t access ) const;
 	};
 	
 	class low_memory_region : public memory_region
@@ -74,6 +123,8 @@ namespace v68k
 			low_memory_region( uint8_t* mem_base, uint32_t mem_size );
 			
 			uint8_t* translate( uint32_t addr, uint32_t length, function_code_t fc, memory_access_t access ) const;
+			
+			uint8_t* translate_page( uint32_t page_addr, function_code_t fc, memory_access_t access ) const;
 	};
 	
 }
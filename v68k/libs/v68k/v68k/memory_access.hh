@@ -0,0 +1,103 @@
+/*
+	memory_access.hh
+	----------------
+*/
+
+#ifndef V68K_MEMORYACCESS_HH
+#define V68K_MEMORYACCESS_HH
+
+// C99
+#include <stdint.h>
+
+// v68k
+#include "v68k/endian.hh"
+
+
+namespace v68k
+{
+	
+	inline uint8_t read_byte( const uint8_t* addr )
+	{
+		return *addr;
+	}
+	
+	inline void write_byte( uint8_t* addr, uint8_t x )
+	{
+		*addr = x;
+	}
+	
+	
+	inline uint16_t read_word_aligned( const uint8_t* addr )
+	{
+		return *(const uint16_t*) addr;
+	}
+	
+	inline void write_word_aligned( uint8_t* addr, uint16_t x )
+	{
+		*(uint16_t*) addr = x;
+	}
+	
+	inline uint32_t read_long_aligned( const uint8_t* addr )
+	{
+		return *(const uint32_t*) addr;
+	}
+	
+	inline void write_long_aligned( uint8_t* addr, uint32_t x )
+	{
+		*(uint32_t*) addr = x;
+	}
+	
+	
+	inline uint16_t read_big_word_aligned( const uint8_t* addr )
+	{
+		return word_from_big( read_word_aligned( addr ) );
+	}
+	
+	inline void write_big_word_aligned( uint8_t* addr, uint16_t x )
+	{
+		write_word_aligned( addr, big_word( x ) );
+	}
+	
+	inline uint32_t read_big_longword_aligned( const uint8_t* addr )
+	{
+		return longword_from_big( read_long_aligned( addr ) );
+	}
+	
+	inline void write_big_long_aligned( uint8_t* addr, uint32_t x )
+	{
+		write_long_aligned( addr, big_longword( x ) );
+	}
+	
+	
+	inline uint16_t read_big_word_unaligned( const uint8_t* addr )
+	{
+		return addr[0] << 8 | addr[1];
+	}
+	
+	inline void write_big_word_unaligned( uint8_t* addr, uint16_t x )
+	{
+		addr[0] = x >> 8;
+		addr[1] = x & 0xFF;
+	}
+	
+	inline uint32_t read_big_long_unaligned( const uint8_t* addr )
+	{
+		const uint32_t big_endian = addr[0] << 24
+		                          | addr[1] << 16
+		                          | addr[2] <<  8
+		                          | addr[3];
+		
+		return big_endian;
+	}
+	
+	inline void write_big_long_unaligned( uint8_t* addr, uint32_t x )
+	{
+		addr[0] = x >> 24;
+		addr[1] = x >> 16 & 0xFF;
+		addr[2] = x >>  8 & 0xFF;
+		addr[3] = x       & 0xFF;
+	}
+	
+}
+
+#endif
@@ -238,6 +238,38 @@ namespace v68k
 		return Ok;
 	}
 	
+	op_result microcode_CAS( processor_state& s, op_params& pb )
+	{
+		const uint32_t more = pb.first;
+		
+		const uint16_t c = more >> 0 & 0x7;  // Dc
+		const uint16_t u = more >> 6 & 0x7;  // Du
+		
+		const int32_t operand = pb.second;
+		const int32_t compare = sign_extend( s.d(c), pb.size );
+		
+		pb.first = compare;  // The CCR is updated as for CMP Dc,<ea>
+		
+		if ( compare == operand )
+		{
+			pb.result = s.d(u);
+		}
+		else
+		{
+			/*
+				The operand is loaded into Dc.  Memory is left as it was,
+				although we store its old value back rather than skip the
+				store -- the bus cycle is read-modify-write either way.
+			*/
+			
+			s.d(c) = update( s.d(c), operand, pb.size );
+			
+			pb.result = operand;
+		}
+		
+		return Ok;
+	}
+	
 	#pragma mark -
 	#pragma mark Lines 1-3
 	
@@ -253,6 +285,8 @@ namespace v68k
 	
 	op_result microcode_CHK( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		const int32_t bound = pb.first;
 		const int32_t value = pb.second;
 		
@@ -336,6 +370,8 @@ namespace v68k
 		
 		s.opcode = 0x4AFC;  // ILLEGAL
 		
+		s.flush_CCR();  // the handler may access the CCR directly
+		
 		if ( bkpt_handler f = s.bkpt )
 		{
 			s.opcode = f( s, data );
@@ -355,7 +391,7 @@ namespace v68k
 		
 		sp -= 4;
 		
-		if ( !s.mem.put_long( sp, pb.address, s.data_space() ) )
+		if ( !s.put_long( sp, pb.address, s.data_space() ) )
 		{
 			return Bus_error;
 		}
@@ -416,6 +452,8 @@ namespace v68k
 	
 	op_result microcode_TAS( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		const int32_t data = sign_extend( pb.second, byte_sized );
 		
 		s.sr.nzvc = N( data <  0 )
@@ -428,6 +466,26 @@ namespace v68k
 		return Ok;
 	}
 	
+	/*
+		MOVEM transfers the whole register list as one block of memory,
+		with registers in ascending order (D0-D7/A0-A7) from the lowest
+		address -- even for -(An), whose mask is reversed.  So we convert
+		the registers to or from big-endian in a local buffer and copy it
+		with a single bulk transfer.
+	*/
+	
+	static inline uint16_t reversed_MOVEM_mask( uint16_t mask )
+	{
+		uint16_t result = 0;
+		
+		for ( int i = 0;  i < 16;  ++i, mask >>= 1 )
+		{
+			result = result << 1 | (mask & 0x1);
+		}
+		
+		return result;
+	}
+	
 	op_result microcode_MOVEM_to( processor_state& s, op_params& pb )
 	{
 		uint16_t mask = pb.first;
@@ -437,34 +495,53 @@ namespace v68k
 		
 		const bool longword_sized = pb.size == long_sized;
 		
-		int32_t increment = 2 << longword_sized;
+		const uint32_t size = 2 << longword_sized;
 		
 		if ( update_register )
 		{
-			increment = -increment;
+			mask = reversed_MOVEM_mask( mask );
 		}
 		
+		uint8_t buffer[ 16 * sizeof (uint32_t) ];
+		
+		uint8_t* p = buffer;
+		
 		for ( int r = 0;  mask != 0;  ++r, mask >>= 1 )
 		{
 			if ( mask & 0x1 )
 			{
-				const uint32_t data = s.regs[ update_register ? 15 - r : r ];
+				const uint32_t data = s.regs[ r ];
 				
-				const bool ok = longword_sized ? s.mem.put_long( addr, data, s.data_space() )
-											   : s.mem.put_word( addr, data, s.data_space() );
-				
-				if ( !ok )
+				if ( longword_sized )
 				{
-					return Bus_error;
+					write_big_long_unaligned( p, data );
+				}
+				else
+				{
+					write_big_word_unaligned( p, data );
 				}
 				
-				addr += increment;
+				p += size;
 			}
 		}
 		
+		const uint32_t n = p - buffer;
+		
+		if ( update_register )
+		{
+			// addr is where the first (i.e. highest) register goes
+			
+			addr -= n - size;
+		}
+		
+		if ( !s.put_bytes( addr, buffer, n, s.data_space() ) )
+		{
+			return Bus_error;
+		}
+		
 		if ( update_register )
 		{
-			s.regs[ update_register ] = addr - increment;
+			s.regs[ update_register ] = addr;
 		}
 		
 		return Ok;
@@ -479,45 +556,171 @@ namespace v68k
 		
 		const bool longword_sized = pb.size == long_sized;
 		
-		const int32_t increment = 2 << longword_sized;
+		const uint32_t size = 2 << longword_sized;
+		
+		uint32_t n = 0;
+		
+		for ( uint16_t m = mask;  m != 0;  m >>= 1 )
+		{
+			n += m & 0x1;
+		}
+		
+		n *= size;
+		
+		uint8_t buffer[ 16 * sizeof (uint32_t) ];
+		
+		if ( !s.get_bytes( addr, buffer, n, s.data_space() ) )
+		{
+			return Bus_error;
+		}
+		
+		const uint8_t* p = buffer;
 		
 		for ( int r = 0;  mask != 0;  ++r, mask >>= 1 )
 		{
 			if ( mask & 0x1 )
 			{
-				uint32_t data;
-				
-				bool ok;
+				s.regs[ r ] = longword_sized ? read_big_long_unaligned( p )
+				                             : int32_t( int16_t( read_big_word_unaligned( p ) ) );
 				
-				if ( longword_sized )
-				{
-					ok = s.mem.get_long( addr, data, s.data_space() );
-				}
-				else
-				{
-					uint16_t word;
-					
-					ok = s.mem.get_word( addr, word, s.data_space() );
-					
-					data = int32_t( int16_t( word ) );
-				}
-				
-				if ( !ok )
-				{
-					return Bus_error;
-				}
-				
-				s.regs[ r ] = data;
-				
-				addr += increment;
+				p += size;
 			}
 		}
 		
 		if ( update_register )
 		{
-			s.regs[ update_register ] = addr;
+			s.regs[ update_register ] = addr + n;
+		}
+		
+		return Ok;
+	}
+	
+	op_result microcode_MULL( processor_state& s, op_params& pb )
+	{
+		const uint32_t more = pb.second;
+		
+		const uint16_t l = more >> 12 & 0x7;  // Dl
+		const uint16_t h = more >>  0 & 0x7;  // Dh
+		
+		const bool is_signed = more & 0x0800;
+		const bool quad      = more & 0x0400;  // 64-bit product in Dh:Dl
+		
+		const uint64_t product = is_signed ? int64_t( int32_t( pb.first ) ) * int32_t( s.d(l) )
+		                                   : uint64_t( pb.first ) * s.d(l);
+		
+		const uint32_t low  = product;
+		const uint32_t high = product >> 32;
+		
+		s.flush_CCR();
+		
+		if ( quad )
+		{
+			s.d(h) = high;
+			s.d(l) = low;
+			
+			s.sr.nzvc = N( int32_t( high ) < 0 )
+			          | Z( product == 0 )
+			          | V( 0 )
+			          | C( 0 );
+		}
+		else
+		{
+			const bool overflow = is_signed ? high != uint32_t( int32_t( low ) >> 31 )
+			                                : high != 0;
+			
+			s.d(l) = low;
+			
+			s.sr.nzvc = N( int32_t( low ) < 0 )
+			          | Z( low == 0 )
+			          | V( overflow )
+			          | C( 0 );
+		}
+		
+		return Ok;
+	}
+	
+	op_result microcode_DIVL( processor_state& s, op_params& pb )
+	{
+		const uint32_t more = pb.second;
+		
+		const uint16_t q = more >> 12 & 0x7;  // Dq
+		const uint16_t r = more >>  0 & 0x7;  // Dr
+		
+		const bool is_signed = more & 0x0800;
+		const bool quad      = more & 0x0400;  // 64-bit dividend in Dr:Dq
+		
+		const uint32_t divisor = pb.first;
+		
+		s.flush_CCR();
+		
+		/*
+			On division by zero or overflow, the registers are unchanged.
+			C is cleared and V is set (as for DIVS.W and DIVU.W, where V is
+			undefined after division by zero).
+		*/
+		
+		s.sr.nzvc = 0x2;
+		
+		if ( divisor == 0 )
+		{
+			return Division_by_zero;
+		}
+		
+		uint32_t quotient;
+		uint32_t remainder;
+		
+		if ( is_signed )
+		{
+			const int64_t dividend = quad ? int64_t( uint64_t( s.d(r) ) << 32 | s.d(q) )
+			                              : int32_t( s.d(q) );
+			
+			const int32_t signed_divisor = divisor;
+			
+			const int64_t min_int64 = int64_t( uint64_t( 1 ) << 63 );
+			
+			if ( signed_divisor == -1  &&  dividend == min_int64 )
+			{
+				return Ok;  // overflow (which would trap on the host)
+			}
+			
+			const int64_t quotient_64 = dividend / signed_divisor;
+			
+			if ( quotient_64 != int32_t( quotient_64 ) )
+			{
+				return Ok;  // overflow
+			}
+			
+			quotient  = quotient_64;
+			remainder = dividend % signed_divisor;
+		}
+		else
+		{
+			const uint64_t dividend = quad ? uint64_t( s.d(r) ) << 32 | s.d(q)
+			                               : s.d(q);
+			
+			const uint64_t quotient_64 = dividend / divisor;
+			
+			if ( quotient_64 >> 32 )
+			{
+				return Ok;  // overflow
+			}
+			
+			quotient  = quotient_64;
+			remainder = dividend % divisor;
 		}
 		
+		if ( r != q )
+		{
+			s.d(r) = remainder;
+		}
+		
+		s.d(q) = quotient;
+		
+		s.sr.nzvc = N( int32_t( quotient ) < 0 )
+		          | Z( quotient == 0 )
+		          | V( 0 )
+		          | C( 0 );
+		
 		return Ok;
 	}
 	
@@ -543,7 +746,7 @@ namespace v68k
 		
 		sp -= 4;
 		
-		if ( !s.mem.put_long( sp, An, s.data_space() ) )
+		if ( !s.put_long( sp, An, s.data_space() ) )
 		{
 			return Bus_error;
 		}
@@ -569,7 +772,7 @@ namespace v68k
 			return Address_error;
 		}
 		
-		if ( !s.mem.get_long( sp, An, s.data_space() ) )
+		if ( !s.get_long( sp, An, s.data_space() ) )
 		{
 			return Bus_error;
 		}
@@ -635,7 +838,7 @@ namespace v68k
 		
 		uint16_t id;
 		
-		if ( !s.mem.get_word( sp + 6, id, supervisor_data_space ) )
+		if ( !s.get_word( sp + 6, id, supervisor_data_space ) )
 		{
 			return Bus_error;
 		}
@@ -651,14 +854,14 @@ namespace v68k
 			return Format_error;
 		}
 		
-		if ( !s.mem.get_long( sp + 2, s.pc(), supervisor_data_space ) )
+		if ( !s.get_long( sp + 2, s.pc(), supervisor_data_space ) )
 		{
 			return Bus_error;
 		}
 		
 		uint16_t saved_sr;
 		
-		if ( !s.mem.get_word( sp, saved_sr, supervisor_data_space ) )
+		if ( !s.get_word( sp, saved_sr, supervisor_data_space ) )
 		{
 			return Bus_error;
 		}
@@ -688,7 +891,7 @@ namespace v68k
 			return Address_error;
 		}
 		
-		if ( !s.mem.get_long( sp, s.pc(), s.data_space() ) )
+		if ( !s.get_long( sp, s.pc(), s.data_space() ) )
 		{
 			return Bus_error;
 		}
@@ -719,7 +922,7 @@ namespace v68k
 		
 		uint16_t ccr;
 		
-		if ( !s.mem.get_word( sp, ccr, s.data_space() ) )
+		if ( !s.get_word( sp, ccr, s.data_space() ) )
 		{
 			return Bus_error;
 		}
@@ -728,7 +931,7 @@ namespace v68k
 		
 		sp += 2;
 		
-		if ( !s.mem.get_long( sp, s.pc(), s.data_space() ) )
+		if ( !s.get_long( sp, s.pc(), s.data_space() ) )
 		{
 			return Bus_error;
 		}
@@ -849,6 +1052,8 @@ namespace v68k
 	
 	op_result microcode_DBcc( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		const uint16_t cc = pb.second;
 		
 		if ( test_conditional( cc, s.sr.nzvc ) )
@@ -878,6 +1083,8 @@ namespace v68k
 	
 	op_result microcode_Scc( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		const uint16_t cc = pb.second;
 		
 		pb.result = int32_t() - test_conditional( cc, s.sr.nzvc );
@@ -906,7 +1113,7 @@ namespace v68k
 		
 		sp -= 4;
 		
-		if ( !s.mem.put_long( sp, s.pc(), s.data_space() ) )
+		if ( !s.put_long( sp, s.pc(), s.data_space() ) )
 		{
 			return Bus_error;
 		}
@@ -918,6 +1125,8 @@ namespace v68k
 	
 	op_result microcode_Bcc( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		const uint16_t cc = pb.second;
 		
 		if ( test_conditional( cc, s.sr.nzvc ) )
@@ -1128,6 +1337,8 @@ namespace v68k
 	
 	op_result microcode_ASR( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		int32_t data = pb.second;
 		
 		const uint16_t count = pb.first;
@@ -1164,6 +1375,8 @@ namespace v68k
 	
 	op_result microcode_ASL( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		const uint16_t count = pb.first;
 		
 		int32_t data = pb.second;
@@ -1220,6 +1433,8 @@ namespace v68k
 	
 	op_result microcode_LSR( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		const uint16_t count = pb.first;
 		
 		int32_t data = pb.second;
@@ -1260,6 +1475,8 @@ namespace v68k
 	
 	op_result microcode_LSL( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		const uint16_t count = pb.first;
 		
 		int32_t data = pb.second;
@@ -1300,6 +1517,8 @@ namespace v68k
 	
 	op_result microcode_ROXR( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		const uint32_t count = pb.first;
 		
 		int32_t data = pb.second;
@@ -1337,6 +1556,8 @@ namespace v68k
 	
 	op_result microcode_ROXL( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		const uint32_t count = pb.first;
 		
 		int32_t data = pb.second;
@@ -1374,6 +1595,8 @@ namespace v68k
 	
 	op_result microcode_ROR( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		const uint32_t count = pb.first;
 		
 		int32_t data = pb.second;
@@ -1413,6 +1636,8 @@ namespace v68k
 	
 	op_result microcode_ROL( processor_state& s, op_params& pb )
 	{
+		s.flush_CCR();
+		
 		const uint32_t count = pb.first;
 		
 		int32_t data = pb.second;
@@ -1450,5 +1675,208 @@ namespace v68k
 		return Ok;
 	}
 	
+	
+	/*
+		Bit field operations.  The extension word gives the field's offset
+		(counting from the most significant bit of the data register, or of
+		the byte at the effective address) and width, each either immediate
+		or from a data register.  A field in a register wraps around from
+		bit 0 to bit 31; one in memory may span as many as five bytes, and
+		a register offset may be negative.
+	*/
+	
+	enum bit_field_op
+	{
+		BFTST,
+		BFEXTU,
+		BFCHG,
+		BFEXTS,
+		BFCLR,
+		BFFFO,
+		BFSET,
+		BFINS,
+	};
+	
+	static inline uint32_t rotate_left( uint32_t x, int n )
+	{
+		return n ? x << n | x >> (32 - n) : x;
+	}
+	
+	static op_result bit_field( processor_state& s, op_params& pb, bit_field_op op )
+	{
+		const uint32_t more = pb.first;
+		
+		const uint16_t n = more >> 12 & 0x7;  // Dn, for BFEXTx, BFFFO, BFINS
+		
+		const int32_t offset = more & 0x0800 ? s.d( more >> 6 & 0x7 )
+		                                     : more >> 6 & 0x1F;
+		
+		int width = (more & 0x0020 ? s.d( more & 0x7 ) : more) & 0x1F;
+		
+		if ( width == 0 )
+		{
+			width = 32;
+		}
+		
+		const uint32_t mask = 0xFFFFFFFF >> (32 - width);
+		
+		const int32_t target = pb.target;
+		
+		/*
+			Load the enclosing data -- the register rotated so the field
+			starts at bit 31, or the bytes spanned by the field -- and find
+			how far the field's least significant bit is from bit 0.
+		*/
+		
+		uint64_t data;
+		int      shift;
+		uint32_t addr    = 0;
+		int      n_bytes = 0;
+		
+		if ( target >= 0 )
+		{
+			data  = rotate_left( s.d( target ), offset & 31 );
+			shift = 32 - width;
+		}
+		else
+		{
+			addr = pb.address + (offset >> 3);  // rounds down if negative
+			
+			const int bit = offset & 7;
+			
+			n_bytes = (bit + width + 7) >> 3;
+			
+			uint8_t bytes[ 5 ];
+			
+			if ( !s.get_bytes( addr, bytes, n_bytes, s.data_space() ) )
+			{
+				return Bus_error;
+			}
+			
+			data = 0;
+			
+			for ( int i = 0;  i < n_bytes;  ++i )
+			{
+				data = data << 8 | bytes[ i ];
+			}
+			
+			shift = n_bytes * 8 - bit - width;
+		}
+		
+		const uint32_t field = data >> shift & mask;
+		
+		const uint32_t value = op == BFINS ? s.d(n) & mask : field;
+		
+		s.flush_CCR();
+		
+		s.sr.nzvc = N( value >> (width - 1) )
+		          | Z( value == 0 )
+		          | V( 0 )
+		          | C( 0 );
+		
+		uint32_t new_field;
+		
+		switch ( op )
+		{
+			case BFEXTU:
+				s.d(n) = field;
+				
+				return Ok;
+			
+			case BFEXTS:
+				s.d(n) = int32_t( field << (32 - width) ) >> (32 - width);
+				
+				return Ok;
+			
+			case BFFFO:
+				{
+					int i = 0;
+					
+					while ( i < width  &&  !(field >> (width - 1 - i) & 0x1) )
+					{
+						++i;
+					}
+					
+					s.d(n) = offset + i;
+				}
+				
+				return Ok;
+			
+			case BFCHG:  new_field = ~field & mask;  break;
+			case BFCLR:  new_field = 0;              break;
+			case BFSET:  new_field = mask;           break;
+			case BFINS:  new_field = value;          break;
+			
+			case BFTST:
+			default:
+				return Ok;
+		}
+		
+		data &= ~(uint64_t( mask ) << shift);
+		data |=   uint64_t( new_field ) << shift;
+		
+		if ( target >= 0 )
+		{
+			s.d( target ) = rotate_left( data, -offset & 31 );
+			
+			return Ok;
+		}
+		
+		uint8_t bytes[ 5 ];
+		
+		for ( int i = n_bytes;  --i >= 0;  data >>= 8 )
+		{
+			bytes[ i ] = data;
+		}
+		
+		if ( !s.put_bytes( addr, bytes, n_bytes, s.data_space() ) )
+		{
+			return Bus_error;
+		}
+		
+		return Ok;
+	}
+	
+	op_result microcode_BFTST( processor_state& s, op_params& pb )
+	{
+		return bit_field( s, pb, BFTST );
+	}
+	
+	op_result microcode_BFEXTU( processor_state& s, op_params& pb )
+	{
+		return bit_field( s, pb, BFEXTU );
+	}
+	
+	op_result microcode_BFCHG( processor_state& s, op_params& pb )
+	{
+		return bit_field( s, pb, BFCHG );
+	}
+	
+	op_result microcode_BFEXTS( processor_state& s, op_params& pb )
+	{
+		return bit_field( s, pb, BFEXTS );
+	}
+	
+	op_result microcode_BFCLR( processor_state& s, op_params& pb )
+	{
+		return bit_field( s, pb, BFCLR );
+	}
+	
+	op_result microcode_BFFFO( processor_state& s, op_params& pb )
+	{
+		return bit_field( s, pb, BFFFO );
+	}
+	
+	op_result microcode_BFSET( processor_state& s, op_params& pb )
+	{
+		return bit_field( s, pb, BFSET );
+	}
+	
+	op_result microcode_BFINS( processor_state& s, op_params& pb )
+	{
+		return bit_field( s, pb, BFINS );
+	}
+	
+
 }
 
@@ -44,6 +44,8 @@ namespace v68k
 	
 	op_result microcode_MOVES( processor_state& state, op_params& pb );
 	
+	op_result microcode_CAS( processor_state& state, op_params& pb );
+	
 	#pragma mark -
 	#pragma mark Lines 1-3
 	
@@ -80,6 +82,9 @@ namespace v68k
 	op_result microcode_MOVEM_to  ( processor_state& state, op_params& pb );
 	op_result microcode_MOVEM_from( processor_state& state, op_params& pb );
 	
+	op_result microcode_MULL( processor_state& state, op_params& pb );
+	op_result microcode_DIVL( processor_state& state, op_params& pb );
+	
 	op_result microcode_TRAP( processor_state& state, op_params& pb );
 	
 	op_result microcode_LINK( processor_state& state, op_params& pb );
@@ -173,6 +178,15 @@ namespace v68k
 	op_result microcode_ROR( processor_state& state, op_params& pb );
 	op_result microcode_ROL( processor_state& state, op_params& pb );
 	
+	op_result microcode_BFTST ( processor_state& state, op_params& pb );
+	op_result microcode_BFEXTU( processor_state& state, op_params& pb );
+	op_result microcode_BFCHG ( processor_state& state, op_params& pb );
+	op_result microcode_BFEXTS( processor_state& state, op_params& pb );
+	op_result microcode_BFCLR ( processor_state& state, op_params& pb );
+	op_result microcode_BFFFO ( processor_state& state, op_params& pb );
+	op_result microcode_BFSET ( processor_state& state, op_params& pb );
+	op_result microcode_BFINS ( processor_state& state, op_params& pb );
+	
 }
 
 #endif
@@ -0,0 +1,354 @@
+/*
+	specialized_fetches.cc
+	----------------------
+*/
+
+#include "v68k/specialized_fetches.hh"
+
+// v68k
+#include "v68k/effective_address.hh"
+#include "v68k/fetch.hh"
+#include "v68k/fetches.hh"
+#include "v68k/instruction.hh"
+#include "v68k/macros.hh"
+#include "v68k/op_params.hh"
+#include "v68k/state.hh"
+
+
+#pragma exceptions off
+
+
+namespace v68k
+{
+	
+	/*
+		Each template below is equivalent to the fetch sequence it replaces,
+		with the size and addressing mode known at compile time.  Modes 0-5
+		are specialized.  Modes 6 and 7 (indexed, absolute, PC-relative, and
+		immediate) are rarer and need further decoding of the register field
+		or an extension word anyway, so they share the general fetchers.
+	*/
+	
+	const int general_mode = 7;
+	
+	template < op_size_t size >
+	static inline int32_t extended( uint32_t data )
+	{
+		return size == byte_sized ? int32_t( int8_t ( data ) )
+		     : size == word_sized ? int32_t( int16_t( data ) )
+		     :                      int32_t(          data   );
+	}
+	
+	template < op_size_t size >
+	static inline uint32_t read_data( processor_state& s, uint32_t addr )
+	{
+		// Same as s.read_mem( addr, size )
+		
+		if ( size != byte_sized  &&  s.badly_aligned_data( addr ) )
+		{
+			return s.address_error();
+		}
+		
+		uint32_t result;
+		
+		bool ok;
+		
+		if ( size == byte_sized )
+		{
+			uint8_t byte;
+			
+			ok = s.get_byte( addr, byte, s.data_space() );
+			
+			result = byte;
+		}
+		else if ( size == word_sized )
+		{
+			uint16_t word;
+			
+			ok = s.get_word( addr, word, s.data_space() );
+			
+			result = word;
+		}
+		else
+		{
+			ok = s.get_long( addr, result, s.data_space() );
+		}
+		
+		return ok ? result : s.bus_error();
+	}
+	
+	template < int mode, op_size_t size >
+	static inline uint32_t effective_address( processor_state& s, uint16_t n )
+	{
+		// Same as fetch_effective_address( s, mode, n, byte_count( size ) )
+		
+		if ( mode <= 1 )
+		{
+			return mode << 3 | n;
+		}
+		
+		uint32_t& An = s.a(n);
+		
+		if ( mode == 3  ||  mode == 4 )
+		{
+			// SP is kept word-aligned
+			
+			const int k = size == byte_sized  &&  n == 7 ? 2 : byte_count( size );
+			
+			return mode == 3 ? (An += k) - k
+			                 :  An -= k;
+		}
+		
+		if ( mode == 5 )
+		{
+			return An + fetch_instruction_word_signed( s );
+		}
+		
+		return An;  // mode 2
+	}
+	
+	template < int mode, op_size_t size >
+	static inline void set_effective_address( processor_state& s, uint16_t n, op_params& pb )
+	{
+		const uint32_t ea = effective_address< mode, size >( s, n );
+		
+		(mode <= 1 ? pb.target : pb.address) = ea;
+	}
+	
+	template < op_size_t size, int mode >
+	static void specialized_sized_data( processor_state& s, op_params& pb )
+	{
+		if ( mode == general_mode )
+		{
+			fetch_sized_data_at_effective_address( s, pb );
+			
+			return;
+		}
+		
+		const uint16_t n = s.opcode & 0x7;
+		
+		const uint32_t addr = effective_address< mode, size >( s, n );
+		
+		const uint32_t data = mode <= 1 ? s.regs[ addr ]
+		                                : read_data< size >( s, addr );
+		
+		pb.first = extended< size >( data );
+	}
+	
+	template < op_size_t size, int src, int dst >
+	static void specialized_MOVE( processor_state& s, op_params& pb )
+	{
+		specialized_sized_data< size, src >( s, pb );
+		
+		if ( s.condition != normal )
+		{
+			return;
+		}
+		
+		if ( dst == general_mode )
+		{
+			fetch_2nd_effective_address( s, pb );
+			
+			return;
+		}
+		
+		set_effective_address< dst, size >( s, s.opcode >> 9 & 0x7, pb );
+	}
+	
+	template < op_size_t size, int mode >
+	static void specialized_CMP( processor_state& s, op_params& pb )
+	{
+		pb.second = extended< size >( s.d( s.opcode >> 9 & 0x7 ) );
+		
+		specialized_sized_data< size, mode >( s, pb );
+	}
+	
+	template < op_size_t size, int mode >
+	static void specialized_ADDQ( processor_state& s, op_params& pb )
+	{
+		pb.first = ((s.opcode >> 9) - 1 & 0x0007) + 1;
+		
+		if ( mode == general_mode )
+		{
+			fetch_effective_address( s, pb );
+			
+			return;
+		}
+		
+		set_effective_address< mode, size >( s, s.opcode & 0x7, pb );
+	}
+	
+	template < int mode >
+	static void specialized_LEA( processor_state& s, op_params& pb )
+	{
+		if ( mode == general_mode )
+		{
+			fetch_effective_address( s, pb );
+		}
+		else
+		{
+			pb.address = effective_address< mode, long_sized >( s, s.opcode & 0x7 );
+		}
+		
+		pb.target = s.opcode >> 9 & 0x7;
+	}
+	
+	static void specialized_branch_short( processor_state& s, op_params& pb )
+	{
+		pb.first  = int32_t( int8_t( s.opcode & 0x00FF ) );
+		pb.second = s.opcode >> 8 & 0x0F;
+		
+		pb.address += int32_t( pb.first );
+	}
+	
+	template < op_size_t size >
+	static void specialized_branch( processor_state& s, op_params& pb )
+	{
+		pb.first = size == long_sized ? fetch_longword               ( s )
+		                              : fetch_instruction_word_signed( s );
+		
+		pb.second = s.opcode >> 8 & 0x0F;
+		
+		pb.address += int32_t( pb.first );
+	}
+	
+	static void specialized_DBcc( processor_state& s, op_params& pb )
+	{
+		specialized_branch< word_sized >( s, pb );
+		
+		pb.target = s.opcode & 0x0007;
+	}
+	
+	
+	/*
+		Tables indexed by [size - 1][mode], and for MOVE by [size - 1][source
+		mode][destination mode].  Modes 6 and 7 are both the general case.
+	*/
+	
+	#define BY_MODE( f, size )                              \
+		{                                                   \
+			&f< size, 0 >,                                  \
+			&f< size, 1 >,                                  \
+			&f< size, 2 >,                                  \
+			&f< size, 3 >,                                  \
+			&f< size, 4 >,                                  \
+			&f< size, 5 >,                                  \
+			&f< size, general_mode >,                       \
+			&f< size, general_mode >                        \
+		}
+	
+	#define BY_SIZE_AND_MODE( f )                           \
+		{                                                   \
+			BY_MODE( f, byte_sized ),                       \
+			BY_MODE( f, word_sized ),                       \
+			BY_MODE( f, long_sized )                        \
+		}
+	
+	#define MOVE_BY_DST( size, src )                        \
+		{                                                   \
+			&specialized_MOVE< size, src, 0 >,              \
+			&specialized_MOVE< size, src, 1 >,              \
+			&specialized_MOVE< size, src, 2 >,              \
+			&specialized_MOVE< size, src, 3 >,              \
+			&specialized_MOVE< size, src, 4 >,              \
+			&specialized_MOVE< size, src, 5 >,              \
+			&specialized_MOVE< size, src, general_mode >,   \
+			&specialized_MOVE< size, src, general_mode >    \
+		}
+	
+	#define MOVE_BY_SRC_AND_DST( size )                     \
+		{                                                   \
+			MOVE_BY_DST( size, 0 ),                         \
+			MOVE_BY_DST( size, 1 ),                         \
+			MOVE_BY_DST( size, 2 ),                         \
+			MOVE_BY_DST( size, 3 ),                         \
+			MOVE_BY_DST( size, 4 ),                         \
+			MOVE_BY_DST( size, 5 ),                         \
+			MOVE_BY_DST( size, general_mode ),              \
+			MOVE_BY_DST( size, general_mode )               \
+		}
+	
+	static const fetcher MOVE_fetchers[ 3 ][ 8 ][ 8 ] =
+	{
+		MOVE_BY_SRC_AND_DST( byte_sized ),
+		MOVE_BY_SRC_AND_DST( word_sized ),
+		MOVE_BY_SRC_AND_DST( long_sized )
+	};
+	
+	static const fetcher TST_fetchers [ 3 ][ 8 ] = BY_SIZE_AND_MODE( specialized_sized_data );
+	static const fetcher CMP_fetchers [ 3 ][ 8 ] = BY_SIZE_AND_MODE( specialized_CMP        );
+	static const fetcher ADDQ_fetchers[ 3 ][ 8 ] = BY_SIZE_AND_MODE( specialized_ADDQ       );
+	
+	// LEA allows only modes 2, 5, 6, and 7.
+	
+	static const fetcher LEA_fetchers[ 8 ] =
+	{
+		&specialized_LEA< general_mode >,
+		&specialized_LEA< general_mode >,
+		&specialized_LEA< 2            >,
+		&specialized_LEA< general_mode >,
+		&specialized_LEA< general_mode >,
+		&specialized_LEA< 5            >,
+		&specialized_LEA< general_mode >,
+		&specialized_LEA< general_mode >
+	};
+	
+	
+	fetcher specialized_fetcher( const instruction& decoded, uint16_t opcode )
+	{
+		const fetcher* fetch = decoded.fetch;
+		
+		const uint16_t mode = opcode >> 3 & 0x7;
+		
+		if ( fetch == fetches_LEA )
+		{
+			return LEA_fetchers[ mode ];
+		}
+		
+		if ( fetch == fetches_branch_short )
+		{
+			return &specialized_branch_short;
+		}
+		
+		if ( fetch == fetches_branch )
+		{
+			return decoded.size == long_sized ? &specialized_branch< long_sized >
+			                                  : &specialized_branch< word_sized >;
+		}
+		
+		if ( fetch == fetches_DBcc )
+		{
+			return &specialized_DBcc;
+		}
+		
+		if ( decoded.size == unsized  ||  decoded.size > max_actual_size )
+		{
+			return 0;  // NULL
+		}
+		
+		const int i = decoded.size - 1;
+		
+		if ( fetch == fetches_MOVE )
+		{
+			return MOVE_fetchers[ i ][ mode ][ opcode >> 6 & 0x7 ];
+		}
+		
+		if ( fetch == fetches_TST )
+		{
+			return TST_fetchers[ i ][ mode ];
+		}
+		
+		if ( fetch == fetches_CMP )
+		{
+			return CMP_fetchers[ i ][ mode ];
+		}
+		
+		if ( fetch == fetches_ADDQ )
+		{
+			return ADDQ_fetchers[ i ][ mode ];
+		}
+		
+		return 0;  // NULL
+	}
+	
+}
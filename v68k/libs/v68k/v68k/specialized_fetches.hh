@@ -0,0 +1,35 @@
+/*
+	specialized_fetches.hh
+	----------------------
+*/
+
+#ifndef V68K_SPECIALIZEDFETCHES_HH
+#define V68K_SPECIALIZEDFETCHES_HH
+
+// C99
+#include <stdint.h>
+
+// v68k
+#include "v68k/fetcher.hh"
+
+
+namespace v68k
+{
+	
+	struct instruction;
+	
+	/*
+		Return a fetcher that does the work of decoded.fetch's whole
+		sequence in one call, compiled for the operand size and addressing
+		modes of opcode, or NULL if there isn't one.  decoded.size must be
+		resolved already (as in the decode cache).
+		
+		Only the most frequent families are covered:  MOVE (and MOVEA),
+		ADDQ/SUBQ, Bcc/BRA/BSR, DBcc, CMP (and CHK), TST, and LEA.
+	*/
+	
+	fetcher specialized_fetcher( const instruction& decoded, uint16_t opcode );
+	
+}
+
+#endif
@@ -20,7 +20,9 @@ namespace v68k
 		mem( mem ),
 		bkpt( bkpt ),
 		model( model ),
-		condition()
+		condition(),
+		pending_CCR_update(),
+		pending_CCR_sets_X()
 	{
 		uint32_t* p   = (uint32_t*)  &regs;
 		uint32_t* end = (uint32_t*) (&regs + 1);
@@ -47,7 +49,7 @@ namespace v68k
 			case byte_sized:
 				uint8_t byte;
 				
-				ok = mem.get_byte( addr, byte, data_space() );
+				ok = get_byte( addr, byte, data_space() );
 				
 				result = byte;
 				
@@ -56,14 +58,14 @@ namespace v68k
 			case word_sized:
 				uint16_t word;
 				
-				ok = mem.get_word( addr, word, data_space() );
+				ok = get_word( addr, word, data_space() );
 				
 				result = word;
 				
 				break;
 			
 			case long_sized:
-				ok = mem.get_long( addr, result, data_space() );
+				ok = get_long( addr, result, data_space() );
 				
 				break;
 			
@@ -81,20 +83,34 @@ namespace v68k
 		return result;
 	}
 	
-	uint16_t processor_state::get_CCR() const
+	static uint16_t current_CCR( const processor_state& s )
 	{
-		const uint16_t ccr = sr.   x <<  4
-		                   | sr.nzvc <<  0;
+		uint8_t x    = s.sr.x;
+		uint8_t nzvc = s.sr.nzvc;
+		
+		if ( s.pending_CCR_update )
+		{
+			nzvc = s.pending_CCR_update( nzvc, s.pending_CCR_params );
+			
+			if ( s.pending_CCR_sets_X )
+			{
+				x = nzvc & 0x1;
+			}
+		}
 		
-		return ccr;
+		return x << 4 | nzvc;
+	}
+	
+	uint16_t processor_state::get_CCR() const
+	{
+		return current_CCR( *this );
 	}
 	
 	uint16_t processor_state::get_SR() const
 	{
 		const uint16_t result = sr.ttsm << 12
 		                      | sr. iii <<  8
-		                      | sr.   x <<  4
-		                      | sr.nzvc <<  0;
+		                      | current_CCR( *this );
 		
 		return result;
 	}
@@ -103,6 +119,8 @@ namespace v68k
 	{
 		// ...X NZVC  (all processors)
 		
+		pending_CCR_update = 0;  // NULL
+		
 		sr.   x = new_ccr >>  4 & 0x1;
 		sr.nzvc = new_ccr >>  0 & 0xF;
 	}
@@ -118,6 +136,8 @@ namespace v68k
 		
 		new_sr &= sr_mask;
 		
+		pending_CCR_update = 0;  // NULL
+		
 		save_sp();
 		
 		sr.ttsm = new_sr >> 12;
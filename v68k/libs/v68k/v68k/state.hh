@@ -9,10 +9,16 @@
 // C99
 #include <stdint.h>
 
+// Standard C
+#include <string.h>
+
 // v68k
 #include "v68k/memory.hh"
+#include "v68k/memory_access.hh"
 #include "v68k/op_params.hh"
 #include "v68k/registers.hh"
+#include "v68k/tlb.hh"
+#include "v68k/update_CCR.hh"
 
 
 namespace v68k
@@ -51,6 +57,8 @@ namespace v68k
 		
 		const memory& mem;
 		
+		translation_lookaside_buffer tlb;
+		
 		const bkpt_handler bkpt;
 		
 		const processor_model model;
@@ -59,6 +67,19 @@ namespace v68k
 		
 		uint16_t opcode;  // current instruction opcode
 		
+		/*
+			Condition codes are evaluated lazily.  If pending_CCR_update is
+			non-NULL, then sr.nzvc (and sr.x, if pending_CCR_sets_X) are
+			stale until flush_CCR() is called.  Code that reads or modifies
+			sr.nzvc or sr.x directly must call flush_CCR() first.  get_CCR()
+			and get_SR() account for pending updates, and set_CCR() and
+			set_SR() discard them.
+		*/
+		
+		CCR_updater  pending_CCR_update;
+		bool         pending_CCR_sets_X;
+		op_params    pending_CCR_params;
+		
 		processor_state( processor_model model, const memory& mem, bkpt_handler bkpt );
 		
 		uint32_t& d( int i )  { return regs[ D0 + i ]; }
@@ -91,6 +112,63 @@ namespace v68k
 		
 		uint32_t read_mem( uint32_t addr, op_size_t size );
 		
+		/*
+			These have the same semantics as their counterparts in memory,
+			but try the TLB first and only call mem.translate() on a miss.
+		*/
+		
+		bool get_byte( uint32_t addr, uint8_t & x, function_code_t fc );
+		bool get_word( uint32_t addr, uint16_t& x, function_code_t fc );
+		bool get_long( uint32_t addr, uint32_t& x, function_code_t fc );
+		
+		bool put_byte( uint32_t addr, uint8_t  x, function_code_t fc );
+		bool put_word( uint32_t addr, uint16_t x, function_code_t fc );
+		bool put_long( uint32_t addr, uint32_t x, function_code_t fc );
+		
+		bool get_instruction_word( uint32_t addr, uint16_t& x, function_code_t fc );
+		
+		// Bulk transfers (see memory), with a TLB fast path within a page
+		
+		bool get_bytes( uint32_t addr, uint8_t* x, uint32_t n, function_code_t fc );
+		
+		bool put_bytes( uint32_t addr, const uint8_t* x, uint32_t n, function_code_t fc );
+		
+		void flush_CCR()
+		{
+			if ( pending_CCR_update )
+			{
+				sr.nzvc = pending_CCR_update( sr.nzvc, pending_CCR_params );
+				
+				if ( pending_CCR_sets_X )
+				{
+					sr.x = sr.nzvc & 0x1;
+				}
+				
+				pending_CCR_update = 0;  // NULL
+			}
+		}
+		
+		void defer_CCR_update( CCR_updater    update,
+		                       bool           sets_X,
+		                       bool           reads_nzvc,
+		                       const op_params&  pb )
+		{
+			/*
+				A pending update can simply be superseded, unless the new one
+				depends on its result (ADDX, SUBX, BTST), or it sets X and the
+				new one doesn't.
+			*/
+			
+			if ( reads_nzvc  ||  (pending_CCR_sets_X  &&  !sets_X) )
+			{
+				flush_CCR();
+			}
+			
+			pending_CCR_update = update;
+			pending_CCR_sets_X = sets_X;
+			pending_CCR_params = pb;
+		}
+		
 		uint16_t get_CCR() const;
 		
 		uint16_t get_SR() const;
@@ -125,6 +203,114 @@ namespace v68k
 		uint32_t address_error()  { condition = halted;  return 0; }
 	};
 	
+	inline bool processor_state::get_byte( uint32_t addr, uint8_t& x, function_code_t fc )
+	{
+		if ( const uint8_t* p = tlb.translate( mem, addr, sizeof x, fc, mem_read ) )
+		{
+			x = read_byte( p );
+			
+			return true;
+		}
+		
+		return mem.get_byte( addr, x, fc );
+	}
+	
+	inline bool processor_state::get_word( uint32_t addr, uint16_t& x, function_code_t fc )
+	{
+		if ( const uint8_t* p = tlb.translate( mem, addr, sizeof x, fc, mem_read ) )
+		{
+			x = read_big_word_unaligned( p );
+			
+			return true;
+		}
+		
+		return mem.get_word( addr, x, fc );
+	}
+	
+	inline bool processor_state::get_long( uint32_t addr, uint32_t& x, function_code_t fc )
+	{
+		if ( const uint8_t* p = tlb.translate( mem, addr, sizeof x, fc, mem_read ) )
+		{
+			x = read_big_long_unaligned( p );
+			
+			return true;
+		}
+		
+		return mem.get_long( addr, x, fc );
+	}
+	
+	inline bool processor_state::put_byte( uint32_t addr, uint8_t x, function_code_t fc )
+	{
+		if ( uint8_t* p = tlb.translate( mem, addr, sizeof x, fc, mem_write ) )
+		{
+			write_byte( p, x );
+			
+			return true;
+		}
+		
+		return mem.put_byte( addr, x, fc );
+	}
+	
+	inline bool processor_state::put_word( uint32_t addr, uint16_t x, function_code_t fc )
+	{
+		if ( uint8_t* p = tlb.translate( mem, addr, sizeof x, fc, mem_write ) )
+		{
+			write_big_word_unaligned( p, x );
+			
+			return true;
+		}
+		
+		return mem.put_word( addr, x, fc );
+	}
+	
+	inline bool processor_state::put_long( uint32_t addr, uint32_t x, function_code_t fc )
+	{
+		if ( uint8_t* p = tlb.translate( mem, addr, sizeof x, fc, mem_write ) )
+		{
+			write_big_long_unaligned( p, x );
+			
+			return true;
+		}
+		
+		return mem.put_long( addr, x, fc );
+	}
+	
+	inline bool processor_state::get_bytes( uint32_t addr, uint8_t* x, uint32_t n, function_code_t fc )
+	{
+		if ( const uint8_t* p = tlb.translate( mem, addr, n, fc, mem_read ) )
+		{
+			memcpy( x, p, n );
+			
+			return true;
+		}
+		
+		return mem.get_bytes( addr, x, n, fc );
+	}
+	
+	inline bool processor_state::put_bytes( uint32_t addr, const uint8_t* x, uint32_t n, function_code_t fc )
+	{
+		if ( uint8_t* p = tlb.translate( mem, addr, n, fc, mem_write ) )
+		{
+			memcpy( p, x, n );
+			
+			return true;
+		}
+		
+		return mem.put_bytes( addr, x, n, fc );
+	}
+	
+	inline bool processor_state::get_instruction_word( uint32_t addr, uint16_t& x, function_code_t fc )
+	{
+		if ( const uint8_t* p = tlb.translate( mem, addr, sizeof x, fc, mem_exec ) )
+		{
+			x = read_big_word_aligned( p );
+			
+			return true;
+		}
+		
+		return mem.get_instruction_word( addr, x, fc );
+	}
+	
 }
 
 #endif
@@ -0,0 +1,39 @@
+/*
+	tlb.cc
+	------
+*/
+
+#include "v68k/tlb.hh"
+
+
+#pragma exceptions off
+
+
+namespace v68k
+{
+	
+	void translation_lookaside_buffer::flush()
+	{
+		entry* it  = &its_entries[ 0 ][ 0 ][ 0 ];
+		entry* end = it + sizeof its_entries / sizeof (entry);
+		
+		for ( ;  it < end;  ++it )
+		{
+			// Translation pages are aligned, so 1 never matches.
+			
+			it->page_addr = 1;
+		}
+	}
+	
+	uint8_t* translation_lookaside_buffer::fill( entry&                 e,
+	                                             const memory&          mem,
+	                                             uint32_t               page_addr,
+	                                             function_code_t        fc,
+	                                             memory_access_t        access )
+	{
+		e.page_addr = page_addr;
+		
+		return e.base = mem.translate_page( page_addr, fc, access );
+	}
+	
+}
@@ -0,0 +1,95 @@
+/*
+	tlb.hh
+	------
+*/
+
+#ifndef V68K_TLB_HH
+#define V68K_TLB_HH
+
+// C99
+#include <stdint.h>
+
+// v68k
+#include "v68k/memory.hh"
+
+
+namespace v68k
+{
+	
+	/*
+		A direct-mapped software TLB in front of memory::translate().
+		
+		Each entry caches the host address of one translation page for one
+		function code and access type (exec, read, or write), as reported by
+		memory::translate_page().  Pages that can't be cached are recorded
+		too (with a NULL base), so they cost only one extra virtual call per
+		miss rather than one per access.
+		
+		mem_update is never cached:  A cached write translation means that
+		no update notification is needed.
+		
+		Call flush() whenever the guest address space mappings change.
+	*/
+	
+	class translation_lookaside_buffer
+	{
+		private:
+			enum
+			{
+				n_access_types = mem_write + 1,
+				n_entries      = 32,
+			};
+			
+			struct entry
+			{
+				uint32_t  page_addr;
+				uint8_t*  base;
+			};
+			
+			entry its_entries[ 8 ][ n_access_types ][ n_entries ];
+			
+			uint8_t* fill( entry&                 e,
+			               const memory&          mem,
+			               uint32_t               page_addr,
+			               function_code_t        fc,
+			               memory_access_t        access );
+		
+		public:
+			translation_lookaside_buffer()  { flush(); }
+			
+			void flush();
+			
+			/*
+				Returns the host address for the guest access, or NULL if the
+				access must take the slow path through mem.translate().
+			*/
+			
+			uint8_t* translate( const memory&    mem,
+			                    uint32_t         addr,
+			                    uint32_t         length,
+			                    function_code_t  fc,
+			                    memory_access_t  access )
+			{
+				const uint32_t offset = addr & (translation_page_size - 1);
+				
+				if ( offset + length > translation_page_size )
+				{
+					return 0;  // NULL
+				}
+				
+				const uint32_t page_addr = addr - offset;
+				
+				const uint32_t index = page_addr >> translation_page_size_bits;
+				
+				entry& e = its_entries[ fc & 7 ][ access ][ index & (n_entries - 1) ];
+				
+				uint8_t* base = e.page_addr == page_addr ? e.base
+				                                         : fill( e, mem, page_addr, fc, access );
+				
+				return base ? base + offset : 0;  // NULL
+			}
+	};
+	
+}
+
+#endif
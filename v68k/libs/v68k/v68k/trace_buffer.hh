@@ -0,0 +1,81 @@
+/*
+	trace_buffer.hh
+	---------------
+*/
+
+#ifndef V68K_TRACEBUFFER_HH
+#define V68K_TRACEBUFFER_HH
+
+// C99
+#include <stdint.h>
+
+
+namespace v68k
+{
+	
+	/*
+		A ring buffer of the most recently executed instructions, so that
+		a crash can be explained after the fact.  It's always on, so each
+		entry is just what the emulator already has in hand:  the PC and
+		opcode, and where the instruction stored its result.
+		
+		For instructions that store a result through the common store path,
+		target is the register number (0-15, i.e. D0-D7/A0-A7) whose new
+		contents are in value, or trace_memory if the result was stored to
+		the address in value.  Otherwise (e.g. branches, LEA, or anything
+		that trapped before completing) it's trace_none.
+	*/
+	
+	enum
+	{
+		trace_memory = -1,
+		trace_none   = -2,
+	};
+	
+	struct trace_entry
+	{
+		uint32_t  pc;
+		uint32_t  value;
+		uint16_t  opcode;
+		int16_t   target;
+	};
+	
+	class trace_buffer
+	{
+		public:
+			enum
+			{
+				capacity = 256,  // must be a power of two
+			};
+		
+		private:
+			trace_entry  its_entries[ capacity ];
+			unsigned     its_count;
+		
+		public:
+			trace_buffer() : its_count()
+			{
+			}
+			
+			void clear()  { its_count = 0; }
+			
+			trace_entry& next()
+			{
+				return its_entries[ its_count++ & (capacity - 1) ];
+			}
+			
+			unsigned size() const
+			{
+				return its_count < capacity ? its_count : capacity;
+			}
+			
+			// 0 is the oldest entry, size() - 1 the most recent
+			const trace_entry& operator[]( unsigned i ) const
+			{
+				return its_entries[ (its_count - size() + i) & (capacity - 1) ];
+			}
+	};
+	
+}
+
+#endif
@@ -8,7 +8,6 @@
 // v68k
 #include "v68k/macros.hh"
 #include "v68k/op_params.hh"
-#include "v68k/state.hh"
 
 
 #pragma exceptions off
@@ -45,64 +44,63 @@ namespace v68k
 		       | C( S & D | !R & D | S & !R );
 	}
 	
-	static void update_CCR_ADD( processor_state& s, const op_params& pb )
+	static uint8_t update_CCR_ADD( uint8_t nzvc, const op_params& pb )
 	{
 		const int32_t a = sign_extend( pb.first,  pb.size );
 		const int32_t b = sign_extend( pb.second, pb.size );
 		const int32_t c = sign_extend( pb.result, pb.size );
 		
-		s.sr.nzvc = common_NZ( c )
-		          | additive_VC( a, b, c );
+		return common_NZ( c )
+		       | additive_VC( a, b, c );
 	}
 	
-	static void update_CCR_SUB( processor_state& s, const op_params& pb )
+	static uint8_t update_CCR_SUB( uint8_t nzvc, const op_params& pb )
 	{
 		const int32_t a = sign_extend( pb.first,  pb.size );
 		const int32_t b = sign_extend( pb.second, pb.size );
 		
 		const int32_t d = b - a;
 		
-		s.sr.nzvc = common_NZ( d )
-		          | additive_VC( a, d, b );  // b is the sum
+		return common_NZ( d )
+		       | additive_VC( a, d, b );  // b is the sum
 	}
 	
-	static void update_CCR_ADDX( processor_state& s, const op_params& pb )
+	static uint8_t update_CCR_ADDX( uint8_t nzvc, const op_params& pb )
 	{
 		const int32_t a = sign_extend( pb.first,  pb.size );
 		const int32_t b = sign_extend( pb.second, pb.size );
 		const int32_t c = sign_extend( pb.result, pb.size );
 		
-		s.sr.nzvc = ADDX_NZ( c, s.sr.nzvc )
-		          | additive_VC( a, b, c );
+		return ADDX_NZ( c, nzvc )
+		       | additive_VC( a, b, c );
 	}
 	
-	static void update_CCR_SUBX( processor_state& s, const op_params& pb )
+	static uint8_t update_CCR_SUBX( uint8_t nzvc, const op_params& pb )
 	{
 		const int32_t a = pb.first;
 		const int32_t b = pb.second;
 		
 		const int32_t d = b - a;
 		
-		s.sr.nzvc = ADDX_NZ( d, s.sr.nzvc )
-		          | additive_VC( a, d, b );  // b is the sum
+		return ADDX_NZ( d, nzvc )
+		       | additive_VC( a, d, b );  // b is the sum
 	}
 	
-	static void update_CCR_TST( processor_state& s, const op_params& pb )
+	static uint8_t update_CCR_TST( uint8_t nzvc, const op_params& pb )
 	{
 		const int32_t data = sign_extend( pb.result, pb.size );
 		
-		s.sr.nzvc = common_NZ( data );
+		return common_NZ( data );
 	}
 	
-	static void update_CCR_BTST( processor_state& s, const op_params& pb )
+	static uint8_t update_CCR_BTST( uint8_t nzvc, const op_params& pb )
 	{
 		const uint32_t bit = pb.first;
 		
-		s.sr.nzvc &= ~0x4;
-		s.sr.nzvc |= (~pb.second >> bit & 0x1) << 2;
+		return (nzvc & ~0x4) | (~pb.second >> bit & 0x1) << 2;
 	}
 	
-	static void update_CCR_DIV( processor_state& s, const op_params& pb )
+	static uint8_t update_CCR_DIV( uint8_t nzvc, const op_params& pb )
 	{
 		if ( pb.size == unsized )
 		{
@@ -113,7 +111,7 @@ namespace v68k
 				So set V and clear N, Z, and C.
 			*/
 			
-			s.sr.nzvc = 0x2;
+			return 0x2;
 		}
 		else
 		{
@@ -127,7 +125,7 @@ namespace v68k
 			
 			const int32_t data = sign_extend( pb.result, word_sized );
 			
-			s.sr.nzvc = common_NZ( data );
+			return common_NZ( data );
 		}
 	}
 	
@@ -1,20 +1,28 @@
 /*
 	update_CCR.hh
-	----------
+	------------
 */
 
 #ifndef V68K_UPDATECCR_HH
 #define V68K_UPDATECCR_HH
 
 
+// C99
+#include <stdint.h>
+
+
 namespace v68k
 {
 	
-	struct processor_state;
 	struct op_params;
 	
 	
-	typedef void (*CCR_updater)( processor_state& s, const op_params& pb );
+	/*
+		A CCR updater takes the previous NZVC bits (which only ADDX, SUBX,
+		and BTST consult) and returns the new ones.
+	*/
+	
+	typedef uint8_t (*CCR_updater)( uint8_t nzvc, const op_params& pb );
 	
 	extern CCR_updater the_CCR_updaters[];
 	
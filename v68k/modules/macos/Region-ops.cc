@@ -13,6 +13,7 @@
 // quickdraw
 #include "qd/regions.hh"
 #include "qd/region_detail.hh"
+#include "qd/xor_region.hh"
 
 // macos
 #include "Rect-utils.hh"
@@ -21,6 +22,13 @@
 using quickdraw::Region_end;
 using quickdraw::region_geometry;
 using quickdraw::set_region_bbox;
+using quickdraw::xor_region;
+using quickdraw::combine_regions;
+using quickdraw::region_op_scratch_size;
+using quickdraw::region_op;
+using quickdraw::region_op_diff;
+using quickdraw::region_op_sect;
+using quickdraw::region_op_xor;
 
 typedef quickdraw::region_geometry_t geometry_t;
 
@@ -113,22 +121,38 @@ static short region_size( MacRegion* region, const short* end )
 	return rgn_size;
 }
 
-void binary_region_op( MacRegion**  a,
-                       MacRegion**  b,
-                       MacRegion**  dst,
-                       region_op_2  f )
+static bool empty_region_op( MacRegion**  a,
+                             MacRegion**  b,
+                             MacRegion**  dst,
+                             region_op    op )
 {
-	if ( empty_rect( a[0]->rgnBBox ) )
+	const bool a_empty = empty_rect( a[0]->rgnBBox );
+	const bool b_empty = empty_rect( b[0]->rgnBBox );
+	
+	if ( !a_empty  &&  !b_empty )
 	{
-		CopyRgn( b, dst );
-		
-		return;
+		return false;
 	}
 	
-	if ( empty_rect( b[0]->rgnBBox ) )
+	if ( op == region_op_sect  ||  (a_empty  &&  op == region_op_diff) )
+	{
+		SetEmptyRgn( dst );
+	}
+	else
+	{
+		CopyRgn( a_empty ? b : a, dst );
+	}
+	
+	return true;
+}
+
+void binary_region_op( MacRegion**  a,
+                       MacRegion**  b,
+                       MacRegion**  dst,
+                       region_op    op )
+{
+	if ( empty_region_op( a, b, dst, op ) )
 	{
-		CopyRgn( a, dst );
-		
 		return;
 	}
 	
@@ -144,13 +168,65 @@ void binary_region_op( MacRegion**  a,
 	const geometry_t g_a = region_geometry( *a );
 	const geometry_t g_b = region_geometry( *b );
 	
-	const size_t size = max_new_region_size( g_a, g_b );
+	/*
+		XOR just merges inversion points, so its size is bounded by the
+		operands' geometry.  The other operations sweep both regions,
+		which needs scratch space -- and they measure the result first,
+		since it can be much larger than either operand.
+	*/
+	
+	Handle scratch = NULL;
+	
+	size_t size = max_new_region_size( g_a, g_b );
+	
+	if ( op != region_op_xor )
+	{
+		const size_t scratch_size = region_op_scratch_size( g_a, g_b );
+		
+		scratch = NewHandle( scratch_size * sizeof (short) );
+		
+		if ( scratch == NULL )
+		{
+			return;
+		}
+		
+		const size_t n = combine_regions( op,
+		                                  rgn_extent( *a ),
+		                                  rgn_extent( *b ),
+		                                  NULL,
+		                                  (short*) *scratch );
+		
+		size = sizeof (MacRegion) + n * sizeof (short);
+	}
 	
 	Handle h = NewHandle( size );
 	
+	if ( h == NULL )
+	{
+		if ( scratch != NULL )
+		{
+			DisposeHandle( scratch );
+		}
+		
+		return;
+	}
+	
 	RgnHandle r = (RgnHandle) h;
 	
-	f( rgn_extent( *a ), rgn_extent( *b ), rgn_extent( *r ) );
+	if ( op == region_op_xor )
+	{
+		xor_region( rgn_extent( *a ), rgn_extent( *b ), rgn_extent( *r ) );
+	}
+	else
+	{
+		combine_regions( op,
+		                 rgn_extent( *a ),
+		                 rgn_extent( *b ),
+		                 rgn_extent( *r ),
+		                 (short*) *scratch );
+		
+		DisposeHandle( scratch );
+	}
 	
 	if ( *rgn_extent( *r ) == Region_end )
 	{
@@ -6,13 +6,14 @@
 #ifndef REGIONOPS_HH
 #define REGIONOPS_HH
 
-struct MacRegion;
+// quickdraw
+#include "qd/combine_regions.hh"
 
-typedef void (*region_op_2)( const short*, const short*, short* );
+struct MacRegion;
 
-void binary_region_op( MacRegion**  a,
-                       MacRegion**  b,
-                       MacRegion**  dst,
-                       region_op_2  f );
+void binary_region_op( MacRegion**           a,
+                       MacRegion**           b,
+                       MacRegion**           dst,
+                       quickdraw::region_op  op );
 
 #endif
@@ -14,16 +14,20 @@
 #include <string.h>
 
 // quickdraw
+#include "qd/draw_region.hh"
 #include "qd/regions.hh"
-#include "qd/xor_region.hh"
 
 // macos
+#include "QDGlobals.hh"
 #include "Rect-utils.hh"
+#include "Rects.hh"
 #include "Region-ops.hh"
 
 
+using quickdraw::draw_region;
+using quickdraw::draw_region_scratch_size;
 using quickdraw::offset_region;
-using quickdraw::xor_region;
+using quickdraw::raster_op;
 
 
 static const Rect emptyRect = { 0, 0, 0, 0 };
@@ -127,9 +131,24 @@ pascal void OffsetRgn_patch( MacRegion** rgn, short dh, short dv )
 	}
 }
 
+pascal void SectRgn_patch( MacRegion** a, MacRegion** b, MacRegion** dst )
+{
+	binary_region_op( a, b, dst, quickdraw::region_op_sect );
+}
+
+pascal void UnionRgn_patch( MacRegion** a, MacRegion** b, MacRegion** dst )
+{
+	binary_region_op( a, b, dst, quickdraw::region_op_union );
+}
+
+pascal void DiffRgn_patch( MacRegion** a, MacRegion** b, MacRegion** dst )
+{
+	binary_region_op( a, b, dst, quickdraw::region_op_diff );
+}
+
 pascal void XOrRgn_patch( MacRegion** a, MacRegion** b, MacRegion** dst )
 {
-	binary_region_op( a, b, dst, &xor_region );
+	binary_region_op( a, b, dst, quickdraw::region_op_xor );
 }
 
 pascal unsigned char EmptyRgn_patch( MacRegion** rgn )
@@ -142,3 +161,75 @@ pascal unsigned char EmptyRgn_patch( MacRegion** rgn )
 	
 	return empty_rect( rgn[0]->rgnBBox );
 }
+
+static bool is_rectangular( const MacRegion* rgn )
+{
+	return rgn->rgnSize <= sizeof (MacRegion);
+}
+
+static void draw_region( MacRegion** rgn, raster_op op )
+{
+	GrafPtr thePort = *get_addrof_thePort();
+	
+	const BitMap& portBits = thePort->portBits;
+	
+	const Rect& bounds = portBits.bounds;
+	
+	const quickdraw::bitmap_t bits =
+	{
+		portBits.baseAddr,
+		portBits.rowBytes,
+		{ bounds.top, bounds.left, bounds.bottom, bounds.right },
+	};
+	
+	const short* extent = rgn_extent( *rgn );
+	
+	const quickdraw::region_geometry_t g = quickdraw::region_geometry( extent );
+	
+	Handle scratch = NewHandle( draw_region_scratch_size( g ) * sizeof (short) );
+	
+	if ( scratch == NULL )
+	{
+		return;
+	}
+	
+	draw_region( extent, op, bits, NULL, (short*) *scratch );
+	
+	DisposeHandle( scratch );
+}
+
+pascal void PaintRgn_patch( MacRegion** rgn )
+{
+	if ( is_rectangular( *rgn ) )
+	{
+		PaintRect_patch( &rgn[0]->rgnBBox );
+	}
+	else
+	{
+		draw_region( rgn, quickdraw::raster_paint );
+	}
+}
+
+pascal void EraseRgn_patch( MacRegion** rgn )
+{
+	if ( is_rectangular( *rgn ) )
+	{
+		EraseRect_patch( &rgn[0]->rgnBBox );
+	}
+	else
+	{
+		draw_region( rgn, quickdraw::raster_erase );
+	}
+}
+
+pascal void InverRgn_patch( MacRegion** rgn )
+{
+	if ( is_rectangular( *rgn ) )
+	{
+		InverRect_patch( &rgn[0]->rgnBBox );
+	}
+	else
+	{
+		draw_region( rgn, quickdraw::raster_invert );
+	}
+}
@@ -27,8 +27,18 @@ pascal void RectRgn_patch( MacRegion** rgn, const Rect* r );
 
 pascal void OffsetRgn_patch( MacRegion** rgn, short dh, short dv );
 
+pascal void SectRgn_patch( MacRegion** a, MacRegion** b, MacRegion** dst );
+
+pascal void UnionRgn_patch( MacRegion** a, MacRegion** b, MacRegion** dst );
+
+pascal void DiffRgn_patch( MacRegion** a, MacRegion** b, MacRegion** dst );
+
 pascal void XOrRgn_patch( MacRegion** a, MacRegion** b, MacRegion** dst );
 
 pascal unsigned char EmptyRgn_patch( MacRegion** rgn );
 
+pascal void PaintRgn_patch( MacRegion** rgn );
+pascal void EraseRgn_patch( MacRegion** rgn );
+pascal void InverRgn_patch( MacRegion** rgn );
+
 #endif
@@ -92,6 +92,10 @@ static void install_QuickDraw()
 	TBTRAP( PtInRect   );  // A8AD
 	TBTRAP( EmptyRect  );  // A8AE
 	
+	TBTRAP( PaintRgn    );  // A8D3
+	TBTRAP( EraseRgn    );  // A8D4
+	TBTRAP( InverRgn    );  // A8D5
+	
 	TBTRAP( NewRgn      );  // A8D8
 	TBTRAP( DisposeRgn  );  // A8D9
 	TBTRAP( CopyRgn     );  // A8DC
@@ -100,6 +104,9 @@ static void install_QuickDraw()
 	TBTRAP( RectRgn     );  // A8DF
 	TBTRAP( OffsetRgn   );  // A8E0
 	TBTRAP( EmptyRgn    );  // A8E2
+	TBTRAP( SectRgn     );  // A8E4
+	TBTRAP( UnionRgn    );  // A8E5
+	TBTRAP( DiffRgn     );  // A8E6
 	TBTRAP( XOrRgn      );  // A8E7
 }
 
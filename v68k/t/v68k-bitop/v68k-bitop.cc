@@ -17,7 +17,7 @@
 #pragma exceptions off
 
 
-static const unsigned n_tests = 4 + 12 + 4;
+static const unsigned n_tests = 4 + 12 + 4 + 10;
 
 
 using v68k::big_word;
@@ -221,6 +221,85 @@ static void modulo()
 	EXPECT( emu.d(0) == 0x00000401 );
 }
 
+static void bit_field()
+{
+	using namespace v68k;
+	
+	uint8_t mem[ 4096 ];
+	
+	memset( mem, 0xFF, sizeof mem );  // spike memory with bad addresses
+	
+	uint32_t* vectors = (uint32_t*) mem;
+	
+	vectors[0] = big_longword( 4096 );  // isp
+	vectors[1] = big_longword( 1024 );  // pc
+	
+	uint16_t* code = (uint16_t*) (mem + 1024);
+	
+	code[ 0 ] = big_word( 0xE9C0 );  // BFEXTU  D0{4:8},D1
+	code[ 1 ] = big_word( 0x1108 );
+	code[ 2 ] = big_word( 0xEBC0 );  // BFEXTS  D0{28:8},D1
+	code[ 3 ] = big_word( 0x1708 );
+	code[ 4 ] = big_word( 0xEFD0 );  // BFINS   D1,(A0){12:12}
+	code[ 5 ] = big_word( 0x130C );
+	code[ 6 ] = big_word( 0xEDD0 );  // BFFFO   (A0){8:16},D2
+	code[ 7 ] = big_word( 0x2210 );
+	code[ 8 ] = big_word( 0xEAC0 );  // BFCHG   D0{0:0}
+	code[ 9 ] = big_word( 0x0000 );
+	
+	uint8_t* data = mem + 2048;
+	
+	memset( data, 0, 4 );
+	
+	const memory_region memory( mem, sizeof mem );
+	
+	emulator emu( mc68020, memory );
+	
+	emu.reset();
+	
+	emu.sr.nzvc = 0;
+	
+	emu.d(0) = 0x12345678;
+	emu.a(0) = 2048;
+	
+	
+	emu.step();
+	
+	EXPECT( emu.d(1) == 0x23 );
+	
+	EXPECT( emu.sr.nzvc == 0x0 );
+	
+	
+	emu.step();
+	
+	EXPECT( emu.d(1) == 0xFFFFFF81 );  // wrapped around from bit 0 to 31
+	
+	EXPECT( emu.sr.nzvc == 0x8 );
+	
+	emu.d(1) = 0x12345ABC;
+	
+	
+	emu.step();
+	
+	EXPECT( data[0] == 0x00  &&  data[1] == 0x0A  &&  data[2] == 0xBC  &&  data[3] == 0x00 );
+	
+	EXPECT( emu.sr.nzvc == 0x8 );
+	
+	
+	emu.step();
+	
+	EXPECT( emu.d(2) == 8 + 4 );
+	
+	EXPECT( emu.sr.nzvc == 0x0 );
+	
+	
+	emu.step();
+	
+	EXPECT( emu.d(0) == ~0x12345678u );
+	
+	EXPECT( emu.sr.nzvc == 0x0 );
+}
+
 int main( int argc, char** argv )
 {
 	tap::start( "v68k-bitop", n_tests );
@@ -231,5 +310,7 @@ int main( int argc, char** argv )
 	
 	modulo();
 	
+	bit_field();
+	
 	return 0;
 }
@@ -17,7 +17,7 @@
 #pragma exceptions off
 
 
-static const unsigned n_tests = 6 + 2 + 4;
+static const unsigned n_tests = 6 + 2 + 4 + 6;
 
 
 using v68k::big_word;
@@ -171,6 +171,61 @@ static void cmpm()
 	EXPECT( emu.sr.nzvc == 0x0 );
 }
 
+static void cas()
+{
+	using namespace v68k;
+	
+	uint8_t mem[ 4096 ];
+	
+	memset( mem, 0xFF, sizeof mem );  // spike memory with bad addresses
+	
+	uint32_t* vectors = (uint32_t*) mem;
+	
+	vectors[0] = big_longword( 4096 );  // isp
+	vectors[1] = big_longword( 1024 );  // pc
+	
+	uint16_t* code = (uint16_t*) (mem + 1024);
+	
+	code[ 0 ] = big_word( 0x0ED0 );  // CAS.L  D0,D1,(A0)
+	code[ 1 ] = big_word( 0x0040 );
+	code[ 2 ] = big_word( 0x0ED0 );  // CAS.L  D0,D1,(A0)
+	code[ 3 ] = big_word( 0x0040 );
+	
+	uint32_t* data = (uint32_t*) (mem + 2048);
+	
+	*data = big_longword( 5 );
+	
+	const memory_region memory( mem, sizeof mem );
+	
+	emulator emu( mc68020, memory );
+	
+	emu.reset();
+	
+	emu.sr.nzvc = 0;
+	
+	emu.d(0) = 5;
+	emu.d(1) = 9;
+	emu.a(0) = 2048;
+	
+	
+	emu.step();
+	
+	EXPECT( *data == big_longword( 9 ) );
+	
+	EXPECT( emu.d(0) == 5 );
+	
+	EXPECT( emu.sr.nzvc == 0x4 );
+	
+	
+	emu.step();
+	
+	EXPECT( *data == big_longword( 9 ) );
+	
+	EXPECT( emu.d(0) == 9 );  // loaded from memory
+	
+	EXPECT( emu.sr.nzvc == 0x0 );
+}
+
 int main( int argc, char** argv )
 {
 	tap::start( "v68k-cmp", n_tests );
@@ -181,5 +236,7 @@ int main( int argc, char** argv )
 	
 	cmpm();
 	
+	cas();
+	
 	return 0;
 }
@@ -17,7 +17,7 @@
 #pragma exceptions off
 
 
-static const unsigned n_tests = 15 + 15;
+static const unsigned n_tests = 15 + 15 + 9;
 
 
 using v68k::big_word;
@@ -266,6 +266,80 @@ static void divs()
 	
 }
 
+static void divl()
+{
+	using namespace v68k;
+	
+	uint8_t mem[ 4096 ];
+	
+	memset( mem, 0xFF, sizeof mem );  // spike memory with bad addresses
+	
+	uint32_t* vectors = (uint32_t*) mem;
+	
+	vectors[0] = big_longword( 4096 );  // isp
+	vectors[1] = big_longword( 1024 );  // pc
+	
+	uint16_t* code = (uint16_t*) (mem + 1024);
+	
+	code[ 0 ] = big_word( 0x4C40 );  // DIVU.L   D0,D1
+	code[ 1 ] = big_word( 0x1001 );
+	code[ 2 ] = big_word( 0x4C40 );  // DIVUL.L  D0,D2:D1
+	code[ 3 ] = big_word( 0x1002 );
+	code[ 4 ] = big_word( 0x4C40 );  // DIVS.L   D0,D2:D1
+	code[ 5 ] = big_word( 0x1C02 );
+	code[ 6 ] = big_word( 0x4C40 );  // DIVU.L   D0,D2:D1
+	code[ 7 ] = big_word( 0x1402 );
+	
+	const memory_region memory( mem, sizeof mem );
+	
+	emulator emu( mc68020, memory );
+	
+	emu.reset();
+	
+	emu.sr.nzvc = 0;
+	
+	emu.d(0) = 7;
+	emu.d(1) = 100;
+	
+	
+	emu.step();
+	
+	EXPECT( emu.d(1) == 14 );
+	
+	EXPECT( emu.sr.nzvc == 0x0 );
+	
+	emu.d(1) = 100;
+	
+	
+	emu.step();
+	
+	EXPECT( emu.d(1) == 14  &&  emu.d(2) == 2 );
+	
+	emu.d(1) = 0xFFFFFF9C;  // -100
+	emu.d(2) = 0xFFFFFFFF;
+	
+	
+	emu.step();
+	
+	EXPECT( emu.d(1) == 0xFFFFFFF2 );  // -14
+	EXPECT( emu.d(2) == 0xFFFFFFFE );  // -2
+	
+	EXPECT( emu.sr.nzvc == 0x8 );
+	
+	emu.d(0) = 1;
+	emu.d(1) = 0;
+	emu.d(2) = 1;  // 2^32
+	
+	
+	emu.step();
+	
+	EXPECT( emu.d(1) == 0  &&  emu.d(2) == 1 );
+	
+	EXPECT( emu.sr.nzvc == 0x2 );  // overflow
+	
+	EXPECT( emu.pc() == 1024 + 16 );
+}
+
 int main( int argc, char** argv )
 {
 	tap::start( "v68k-div", n_tests );
@@ -274,5 +348,7 @@ int main( int argc, char** argv )
 	
 	divs();
 	
+	divl();
+	
 	return 0;
 }
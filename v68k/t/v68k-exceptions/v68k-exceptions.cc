@@ -17,7 +17,7 @@
 #pragma exceptions off
 
 
-static const unsigned n_tests = 4 + 6 + 4 + 4 + 2 + 2;
+static const unsigned n_tests = 4 + 6 + 4 + 4 + 2 + 5 + 2;
 
 
 using v68k::big_word;
@@ -198,6 +198,20 @@ static void trap()
 	EXPECT( emu.pc() == 2048 );
 }
 
+static bool decline_trap( v68k::processor_state& s, uint16_t trap )
+{
+	return false;
+}
+
+static bool native_trap( v68k::processor_state& s, uint16_t trap )
+{
+	s.d(0) = trap;
+	
+	s.pc() += 2;
+	
+	return true;
+}
+
 static void line_A_emulator()
 {
 	using namespace v68k;
@@ -226,6 +240,24 @@ static void line_A_emulator()
 	EXPECT( emu.step() );  // unimplemented A-line trap
 	
 	EXPECT( emu.pc() == 2048 );
+	
+	emu.set_line_A_handler( &decline_trap );
+	
+	emu.reset();
+	
+	EXPECT( emu.step() );  // declined by the handler
+	
+	EXPECT( emu.pc() == 2048 );
+	
+	emu.set_line_A_handler( &native_trap );
+	
+	emu.reset();
+	
+	EXPECT( emu.step() );  // performed by the handler
+	
+	EXPECT( emu.pc() == 1026 );
+	
+	EXPECT( emu.d(0) == 0xA000 );
 }
 
 static void line_F_emulator()
@@ -0,0 +1,251 @@
+/*
+	v68k-fetches.cc
+	---------------
+*/
+
+// Standard C
+#include <stdio.h>
+#include <string.h>
+
+// v68k
+#include "v68k/decode_cache.hh"
+#include "v68k/fetches.hh"
+#include "v68k/memory.hh"
+#include "v68k/state.hh"
+
+// tap-out
+#include "tap/test.hh"
+
+
+#pragma exceptions off
+
+
+static const unsigned n_tests = 8;
+
+
+/*
+	For every opcode that the decode cache binds to a specialized fetcher,
+	run both it and the decoded fetch sequence it replaces from the same
+	state, and compare the resulting registers, PC, and processor
+	condition, and (unless the fetch faulted) op_params.
+	
+	Memory and registers are filled with pseudo-random values, and each
+	opcode is tried in several states, on both the 68000 and the 68020
+	(which differ in alignment checking), including states whose address
+	registers are odd, so that address and bus errors are compared too.
+*/
+
+using namespace v68k;
+
+enum family
+{
+	family_MOVE,
+	family_TST,
+	family_CMP,
+	family_ADDQ,
+	family_LEA,
+	family_Bcc,
+	family_DBcc,
+	family_other,
+	
+	n_families
+};
+
+static const char* family_names[ n_families ] =
+{
+	"MOVE",
+	"TST",
+	"CMP",
+	"ADDQ",
+	"LEA",
+	"Bcc",
+	"DBcc",
+	"other",
+};
+
+static unsigned n_checked[ n_families ];
+static unsigned n_failed [ n_families ];
+
+const uint32_t mem_size = 64 * 1024;
+
+const uint32_t code_address = 0x1000;
+
+const int n_states = 4;
+
+static uint8_t mem[ mem_size ];
+
+static uint32_t initial_regs[ n_registers ];
+
+static decode_cache the_decode_cache;
+
+
+static uint32_t random_number()
+{
+	static uint32_t x = 1;
+	
+	x = x * 1103515245 + 12345;
+	
+	return x;
+}
+
+static void randomize_state( int i )
+{
+	for ( uint32_t j = 0;  j < mem_size;  ++j )
+	{
+		mem[ j ] = random_number() >> 16;
+	}
+	
+	memset( initial_regs, '\0', sizeof initial_regs );
+	
+	for ( int j = 0;  j < 8;  ++j )
+	{
+		initial_regs[ D0 + j ] = random_number();
+		
+		// Somewhere in the middle of memory, and odd in the last state
+		
+		const uint32_t addr = 0x4000 + (random_number() >> 16) % 0x8000;
+		
+		initial_regs[ A0 + j ] = i == n_states - 1 ? addr | 1 : addr & ~1;
+	}
+}
+
+static family family_of( const fetcher* fetch )
+{
+	return fetch == fetches_MOVE          ? family_MOVE
+	     : fetch == fetches_TST           ? family_TST
+	     : fetch == fetches_CMP           ? family_CMP
+	     : fetch == fetches_ADDQ          ? family_ADDQ
+	     : fetch == fetches_LEA           ? family_LEA
+	     : fetch == fetches_branch_short  ? family_Bcc
+	     : fetch == fetches_branch        ? family_Bcc
+	     : fetch == fetches_DBcc          ? family_DBcc
+	     :                                  family_other;
+}
+
+static void start( processor_state& s, op_params& pb, const instruction& decoded, uint16_t opcode )
+{
+	memcpy( s.regs, initial_regs, sizeof s.regs );
+	
+	s.set_SR( 0x2700 );
+	
+	s.condition = normal;
+	s.opcode    = opcode;
+	
+	s.pc() = code_address + 2;  // past the opcode, as in step()
+	
+	pb.size    = decoded.size;
+	pb.target  = uint32_t( -1 );
+	pb.address = s.pc();
+	pb.first   = 0xDEADBEEF;
+	pb.second  = 0xDEADBEEF;
+	pb.result  = 0xDEADBEEF;
+}
+
+static bool same( const processor_state& a, const op_params& pa,
+                  const processor_state& b, const op_params& pb )
+{
+	if ( a.condition != b.condition  ||  memcmp( a.regs, b.regs, sizeof a.regs ) != 0 )
+	{
+		return false;
+	}
+	
+	if ( a.condition != normal )
+	{
+		return true;  // step() discards the op_params of a faulting fetch.
+	}
+	
+	return pa.size    == pb.size     &&
+	       pa.target  == pb.target   &&
+	       pa.address == pb.address  &&
+	       pa.first   == pb.first    &&
+	       pa.second  == pb.second   &&
+	       pa.result  == pb.result;
+}
+
+static void compare( processor_model model, uint16_t opcode )
+{
+	const decode_cache_entry& cached = the_decode_cache.lookup( code_address, opcode );
+	
+	const fetcher specialized = cached.fetch;
+	
+	if ( specialized == 0 )  // NULL
+	{
+		return;
+	}
+	
+	const instruction& decoded = cached.decoded;
+	
+	const family f = family_of( decoded.fetch );
+	
+	const memory_region memory( mem, mem_size );
+	
+	processor_state s1( model, memory, 0 );  // NULL
+	processor_state s2( model, memory, 0 );  // NULL
+	
+	op_params pb1;
+	op_params pb2;
+	
+	start( s1, pb1, decoded, opcode );
+	start( s2, pb2, decoded, opcode );
+	
+	for ( const fetcher* fetch = decoded.fetch;  *fetch != 0;  ++fetch )
+	{
+		(*fetch)( s1, pb1 );
+		
+		if ( s1.condition != normal )
+		{
+			break;
+		}
+	}
+	
+	specialized( s2, pb2 );
+	
+	++n_checked[ f ];
+	
+	if ( !same( s1, pb1, s2, pb2 ) )
+	{
+		if ( n_failed[ f ]++ < 4 )
+		{
+			printf( "# %s: opcode 0x%.4x differs on the 680%.2x\n",
+			        family_names[ f ],
+			        opcode,
+			        model );
+		}
+	}
+}
+
+static void compare_all()
+{
+	const processor_model models[] = { mc68000, mc68020 };
+	
+	for ( int i = 0;  i < n_states;  ++i )
+	{
+		randomize_state( i );
+		
+		for ( int m = 0;  m < 2;  ++m )
+		{
+			for ( uint32_t opcode = 0;  opcode < 0x10000;  ++opcode )
+			{
+				compare( models[ m ], opcode );
+			}
+		}
+	}
+	
+	for ( int f = 0;  f < family_other;  ++f )
+	{
+		EXPECT( n_checked[ f ] != 0  &&  n_failed[ f ] == 0 );
+	}
+	
+	// Every specialized opcode belongs to one of the families above.
+	
+	EXPECT( n_checked[ family_other ] == 0 );
+}
+
+int main( int argc, char** argv )
+{
+	tap::start( "v68k-fetches", n_tests );
+	
+	compare_all();
+	
+	return 0;
+}
@@ -0,0 +1,249 @@
+/*
+	v68k-heap.cc
+	------------
+*/
+
+// Standard C
+#include <string.h>
+
+// v68k
+#include "v68k/emulator.hh"
+
+// v68k-alloc
+#include "v68k-alloc/memory.hh"
+
+// tap-out
+#include "tap/test.hh"
+
+
+#pragma exceptions off
+
+
+static const unsigned n_tests = 6 + 6 + 4 + 5 + 13 + 6 + 3;
+
+
+using v68k::alloc::page_size;
+
+const uint32_t base = 0x00100000;
+
+const uint32_t n_pages = 8;
+
+const uint32_t limit = base + n_pages * page_size;
+
+
+static uint8_t* writable( const v68k::alloc::memory& mem, uint32_t addr )
+{
+	return mem.translate( addr, 1, v68k::user_data_space, v68k::mem_write );
+}
+
+static uint8_t* readable( const v68k::alloc::memory& mem, uint32_t addr )
+{
+	return mem.translate( addr, 1, v68k::user_data_space, v68k::mem_read );
+}
+
+static void allocation()
+{
+	v68k::alloc::memory mem( base, limit );
+	
+	const uint32_t a = mem.allocate( 1 );
+	const uint32_t b = mem.allocate( page_size + 1 );
+	
+	EXPECT( a == base );
+	EXPECT( b == base + page_size );
+	
+	// Pages are zeroed, and contiguous within a block
+	
+	const uint8_t* p = mem.translate( b, 2 * page_size, v68k::user_data_space, v68k::mem_read );
+	
+	EXPECT( p != NULL  &&  p[ 0 ] == 0  &&  p[ 2 * page_size - 1 ] == 0 );
+	
+	EXPECT( readable( mem, b + 2 * page_size ) == NULL );
+	
+	EXPECT( mem.allocate( 6 * page_size ) == 0 );
+	EXPECT( mem.allocate( 5 * page_size ) == base + 3 * page_size );
+}
+
+static void reuse()
+{
+	v68k::alloc::memory mem( base, limit );
+	
+	const uint32_t a = mem.allocate( 2 * page_size );
+	const uint32_t b = mem.allocate( 1 * page_size );
+	
+	*writable( mem, a ) = 0x42;
+	
+	mem.deallocate( a );
+	
+	EXPECT( readable( mem, a ) == NULL );
+	
+	// The hole at a is too small, so the next block goes after b.
+	
+	EXPECT( mem.allocate( 3 * page_size ) == b + page_size );
+	
+	EXPECT( mem.allocate( 2 * page_size ) == a );
+	
+	EXPECT( *readable( mem, a ) == 0 );
+	
+	// Freeing two adjacent blocks frees one extent.
+	
+	mem.deallocate( a );
+	mem.deallocate( b );
+	
+	EXPECT( mem.allocate( 3 * page_size ) == a );
+	
+	EXPECT( mem.allocate( 3 * page_size ) == 0 );  // only two pages left
+}
+
+static void extents()
+{
+	v68k::alloc::memory mem( base, limit );
+	
+	uint32_t n;
+	
+	EXPECT( mem.find_extent( 0, &n ) == 0 );
+	
+	EXPECT( mem.allocate_n_pages_at( base + 4 * page_size, 3 ) );
+	
+	EXPECT( !mem.allocate_n_pages_at( base + 6 * page_size, 1 ) );
+	
+	EXPECT( mem.find_extent( 0, &n ) == base + 4 * page_size  &&  n == 3 );
+}
+
+static void host_mappings()
+{
+	v68k::alloc::memory mem( base, limit );
+	
+	const uint32_t a = mem.allocate( page_size );
+	const uint32_t b = mem.allocate_host_mapping( 2 );
+	
+	EXPECT( b == base + page_size );
+	
+	EXPECT( !mem.is_host_mapping( a ) );
+	EXPECT(  mem.is_host_mapping( b ) );
+	
+	mem.deallocate( b );
+	
+	EXPECT( !mem.is_host_mapping( b ) );
+	
+	EXPECT( mem.allocate( 2 * page_size ) == b );
+}
+
+static void forking()
+{
+	v68k::alloc::memory parent( base, limit );
+	v68k::alloc::memory child ( base, limit );
+	v68k::alloc::memory other ( base, limit );
+	
+	const uint32_t a = parent.allocate( 2 * page_size );
+	
+	*writable( parent, a ) = 'P';
+	
+	EXPECT( parent.fork( child ) );
+	
+	EXPECT( !parent.fork( child ) );  // child isn't empty
+	
+	EXPECT( *readable( child, a ) == 'P' );
+	
+	// Reading a shared page isn't cacheable, but writing takes a copy.
+	
+	EXPECT( child.translate_page( a, v68k::user_data_space, v68k::mem_read ) == NULL );
+	
+	*writable( child, a ) = 'C';
+	
+	EXPECT( child.translate_page( a, v68k::user_data_space, v68k::mem_read ) != NULL );
+	
+	EXPECT( *readable( parent, a ) == 'P' );
+	EXPECT( *readable( child,  a ) == 'C' );
+	
+	*writable( parent, a ) = 'p';
+	
+	EXPECT( *readable( child, a ) == 'C' );
+	
+	// A range spanning private and shared pages isn't contiguous.
+	
+	EXPECT( child.translate( a, 2 * page_size, v68k::user_data_space, v68k::mem_read ) == NULL );
+	
+	// Forking again captures the parent's current state.
+	
+	EXPECT( parent.fork( other ) );
+	
+	EXPECT( *readable( other, a ) == 'p' );
+	
+	child.deallocate( a );
+	
+	EXPECT( readable( parent, a ) != NULL );
+	
+	EXPECT( child.allocate( page_size ) == a  &&  *readable( child, a ) == 0 );
+}
+
+static void forking_with_emulator()
+{
+	v68k::alloc::memory parent( base, limit );
+	v68k::alloc::memory child ( base, limit );
+	
+	const uint32_t a = parent.allocate( page_size );
+	
+	v68k::emulator emu( v68k::mc68000, parent );
+	
+	const v68k::function_code_t fc = v68k::user_data_space;
+	
+	// Cache a write translation of the page in the TLB.
+	
+	EXPECT( emu.put_long( a, 0x12345678, fc ) );
+	
+	EXPECT( parent.fork( child ) );
+	
+	// The cached pointer is into the frozen image now.
+	
+	emu.tlb.flush();
+	
+	EXPECT( emu.put_long( a, 0x87654321, fc ) );
+	
+	uint32_t x;
+	
+	EXPECT( emu.get_long( a, x, fc )  &&  x == 0x87654321 );
+	
+	EXPECT( readable( child, a )[ 0 ] == 0x12 );
+	
+	// Writing through the TLB again uses the new cached translation.
+	
+	EXPECT( emu.put_long( a + 4, 0xABCDEF00, fc )  &&  readable( parent, a + 4 )[ 0 ] == 0xAB );
+}
+
+static void copying_shared_pages()
+{
+	v68k::alloc::memory parent( base, limit );
+	v68k::alloc::memory child ( base, limit );
+	
+	const uint32_t a = parent.allocate( page_size );
+	
+	memcpy( writable( parent, a ), "shared", 6 );
+	
+	EXPECT( parent.fork( child ) );
+	
+	*writable( parent, a ) = 'S';
+	
+	/*
+		The child now holds the only reference to the image, and copying
+		within the page makes it private, releasing the image.
+	*/
+	
+	EXPECT( child.copy( a + 8, a, 6, v68k::user_data_space ) );
+	
+	EXPECT( memcmp( readable( child, a + 8 ), "shared", 6 ) == 0 );
+}
+
+int main( int argc, char** argv )
+{
+	tap::start( "v68k-heap", n_tests );
+	
+	allocation();
+	reuse();
+	extents();
+	host_mappings();
+	forking();
+	forking_with_emulator();
+	copying_shared_pages();
+	
+	return 0;
+}
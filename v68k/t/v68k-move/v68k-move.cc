@@ -17,7 +17,7 @@
 #pragma exceptions off
 
 
-static const unsigned n_tests = 6 + 13;
+static const unsigned n_tests = 6 + 13 + 5 + 4 + 2;
 
 
 using v68k::big_word;
@@ -155,6 +155,169 @@ static void move()
 	EXPECT( emu.sr.nzvc == 0x4 );
 }
 
+/*
+	Guest memory in two host blocks, split at an address that isn't on a
+	page boundary, so bulk transfers across it have to be split too.
+*/
+
+class split_memory : public v68k::memory
+{
+	private:
+		uint8_t*  its_low;
+		uint8_t*  its_high;
+		uint32_t  its_split;
+		uint32_t  its_size;
+	
+	public:
+		split_memory( uint8_t* low, uint8_t* high, uint32_t split, uint32_t size )
+		:
+			its_low( low ),
+			its_high( high ),
+			its_split( split ),
+			its_size( size )
+		{
+		}
+		
+		uint8_t* translate( uint32_t               addr,
+		                    uint32_t               length,
+		                    v68k::function_code_t  fc,
+		                    v68k::memory_access_t  access ) const
+		{
+			if ( addr < its_split )
+			{
+				return length <= its_split - addr ? its_low + addr : 0;
+			}
+			
+			if ( addr < its_size  &&  length <= its_size - addr )
+			{
+				return its_high + (addr - its_split);
+			}
+			
+			return 0;  // NULL
+		}
+};
+
+static void movem()
+{
+	using namespace v68k;
+	
+	const uint32_t split = 2050;
+	
+	uint8_t low [ split ];
+	uint8_t high[ 4096 - split ];
+	
+	memset( low,  0xFF, sizeof low  );  // spike memory with bad addresses
+	memset( high, 0xFF, sizeof high );
+	
+	uint32_t* vectors = (uint32_t*) low;
+	
+	vectors[0] = big_longword( 4096 );  // isp
+	vectors[1] = big_longword( 1024 );  // pc
+	
+	uint16_t* code = (uint16_t*) (low + 1024);
+	
+	code[ 0 ] = big_word( 0x48E7 );  // MOVEM.L  D0-D2/A0,-(A7)
+	code[ 1 ] = big_word( 0xE080 );
+	code[ 2 ] = big_word( 0x4CDF );  // MOVEM.L  (A7)+,D3-D5/A1
+	code[ 3 ] = big_word( 0x0238 );
+	
+	const split_memory memory( low, high, split, 4096 );
+	
+	emulator emu( mc68000, memory );
+	
+	emu.reset();
+	
+	emu.d(0) = 0x00000000;
+	emu.d(1) = 0x11111111;
+	emu.d(2) = 0x22222222;
+	emu.a(0) = 0x88888888;
+	
+	emu.a(7) = split + 8;  // the registers straddle the split
+	
+	
+	emu.step();
+	
+	EXPECT( emu.a(7) == split - 8 );
+	
+	uint32_t x = 0;
+	uint32_t y = 0;
+	
+	EXPECT( emu.mem.get_long( split - 4, x, emu.data_space() )  &&  x == 0x11111111 );
+	EXPECT( emu.mem.get_long( split + 4, y, emu.data_space() )  &&  y == 0x88888888 );
+	
+	
+	emu.step();
+	
+	EXPECT( emu.d(3) == 0x00000000  &&  emu.d(4) == 0x11111111  &&
+	        emu.d(5) == 0x22222222  &&  emu.a(1) == 0x88888888 );
+	
+	EXPECT( emu.a(7) == split + 8 );
+	
+	
+	const uint8_t data[] = "0123456789ABCDEF";
+	
+	uint8_t result[ 16 ];
+	
+	EXPECT( memory.put_bytes( split - 10, data, 16, user_data_space ) );
+	
+	// Overlapping, with the destination after the source
+	
+	EXPECT( memory.copy( split - 6, split - 10, 16, user_data_space ) );
+	
+	EXPECT( memory.get_bytes( split - 10, result, 16, user_data_space )  &&
+	        memcmp( result, "01230123456789AB", 16 ) == 0 );
+	
+	EXPECT( !memory.get_bytes( 4096 - 8, result, 16, user_data_space ) );
+}
+
+static void memory_indirect()
+{
+	using namespace v68k;
+	
+	uint8_t mem[ 4096 ];
+	
+	memset( mem, 0xFF, sizeof mem );  // spike memory with bad addresses
+	
+	uint32_t* vectors = (uint32_t*) mem;
+	
+	vectors[0] = big_longword( 4096 );  // isp
+	vectors[1] = big_longword( 1024 );  // pc
+	
+	uint16_t* code = (uint16_t*) (mem + 1024);
+	
+	code[ 0 ] = big_word( 0x45F0 );  // LEA  ([4,A0],D1.L*4,8),A2
+	code[ 1 ] = big_word( 0x1D26 );
+	code[ 2 ] = big_word( 0x0004 );
+	code[ 3 ] = big_word( 0x0008 );
+	code[ 4 ] = big_word( 0x47F0 );  // LEA  ([2052],D1.L*4,8),A3  ; base suppressed
+	code[ 5 ] = big_word( 0x1DA6 );
+	code[ 6 ] = big_word( 0x0804 );
+	code[ 7 ] = big_word( 0x0008 );
+	
+	uint32_t* pointers = (uint32_t*) (mem + 2048);
+	
+	pointers[ 1 ] = big_longword( 0x0300 );
+	
+	const memory_region memory( mem, sizeof mem );
+	
+	emulator emu( mc68020, memory );
+	
+	emu.reset();
+	
+	emu.a(0) = 2048;
+	emu.d(1) = 2;
+	
+	
+	emu.step();
+	
+	EXPECT( emu.a(2) == 0x0300 + 2 * 4 + 8 );
+	
+	
+	emu.step();
+	
+	EXPECT( emu.a(3) == 0x0300 + 2 * 4 + 8 );
+}
+
 int main( int argc, char** argv )
 {
 	tap::start( "v68k-move", n_tests );
@@ -163,5 +326,9 @@ int main( int argc, char** argv )
 	
 	move();
 	
+	movem();
+	
+	memory_indirect();
+	
 	return 0;
 }
@@ -17,7 +17,7 @@
 #pragma exceptions off
 
 
-static const unsigned n_tests = 6 + 6;
+static const unsigned n_tests = 6 + 6 + 5;
 
 
 using v68k::big_word;
@@ -132,6 +132,56 @@ static void muls()
 	EXPECT( emu.sr.nzvc == 0x0 );
 }
 
+static void mull()
+{
+	using namespace v68k;
+	
+	uint8_t mem[ 4096 ];
+	
+	memset( mem, 0xFF, sizeof mem );  // spike memory with bad addresses
+	
+	uint32_t* vectors = (uint32_t*) mem;
+	
+	vectors[0] = big_longword( 4096 );  // isp
+	vectors[1] = big_longword( 1024 );  // pc
+	
+	uint16_t* code = (uint16_t*) (mem + 1024);
+	
+	code[ 0 ] = big_word( 0x4C00 );  // MULU.L  D0,D1
+	code[ 1 ] = big_word( 0x1000 );
+	code[ 2 ] = big_word( 0x4C00 );  // MULS.L  D0,D2:D1
+	code[ 3 ] = big_word( 0x1C02 );
+	
+	const memory_region memory( mem, sizeof mem );
+	
+	emulator emu( mc68020, memory );
+	
+	emu.reset();
+	
+	emu.sr.nzvc = 0;
+	
+	emu.d(0) = 0x00010000;
+	emu.d(1) = 0x00010000;
+	
+	
+	emu.step();
+	
+	EXPECT( emu.d(1) == 0x00000000 );
+	
+	EXPECT( emu.sr.nzvc == 0x6 );  // overflow
+	
+	emu.d(0) = 0xFFFFFFFE;
+	emu.d(1) = 0x00000003;
+	
+	
+	emu.step();
+	
+	EXPECT( emu.d(1) == 0xFFFFFFFA );
+	EXPECT( emu.d(2) == 0xFFFFFFFF );
+	
+	EXPECT( emu.sr.nzvc == 0x8 );
+}
+
 int main( int argc, char** argv )
 {
 	tap::start( "v68k-mul", n_tests );
@@ -140,5 +190,7 @@ int main( int argc, char** argv )
 	
 	muls();
 	
+	mull();
+	
 	return 0;
 }
@@ -0,0 +1,271 @@
+/*
+	v68k-run.cc
+	-----------
+*/
+
+// Standard C
+#include <string.h>
+
+// v68k
+#include "v68k/emulator.hh"
+#include "v68k/endian.hh"
+
+// tap-out
+#include "tap/test.hh"
+
+
+#pragma exceptions off
+
+
+static const unsigned n_tests = 5 + 5 + 2 + 7 + 11;
+
+
+using v68k::big_word;
+using v68k::big_longword;
+
+
+static void add_move()
+{
+	using namespace v68k;
+	
+	uint8_t mem[ 4096 ];
+	
+	memset( mem, 0xFF, sizeof mem );  // spike memory with bad addresses
+	
+	uint32_t* vectors = (uint32_t*) mem;
+	
+	vectors[0] = big_longword( 4096 );  // isp
+	vectors[1] = big_longword( 1024 );  // pc
+	
+	uint16_t* code = (uint16_t*) (mem + 1024);
+	
+	code[ 0 ] = big_word( 0xD081 );  // ADD.L   D1,D0
+	code[ 1 ] = big_word( 0x2400 );  // MOVE.L  D0,D2
+	code[ 2 ] = big_word( 0x4E71 );  // NOP
+	
+	const memory_region memory( mem, sizeof mem );
+	
+	emulator emu( mc68000, memory );
+	
+	emu.reset();
+	
+	emu.d(0) = 0xFFFFFFFF;
+	emu.d(1) = 0x00000001;
+	
+	EXPECT( emu.run( 2 ) );
+	
+	EXPECT( emu.instruction_count() == 2 );
+	
+	EXPECT( emu.d(2) == 0 );
+	
+	// MOVE clears V and C, but leaves the X set by ADD
+	
+	EXPECT( emu.sr.   x == 0x1 );
+	EXPECT( emu.sr.nzvc == 0x4 );
+}
+
+static void loop()
+{
+	using namespace v68k;
+	
+	uint8_t mem[ 4096 ];
+	
+	memset( mem, 0xFF, sizeof mem );  // spike memory with bad addresses
+	
+	uint32_t* vectors = (uint32_t*) mem;
+	
+	vectors[0] = big_longword( 4096 );  // isp
+	vectors[1] = big_longword( 1024 );  // pc
+	
+	uint16_t* code = (uint16_t*) (mem + 1024);
+	
+	code[ 0 ] = big_word( 0x700A );  // MOVEQ   #10,D0
+	code[ 1 ] = big_word( 0x5281 );  // ADDQ.L  #1,D1
+	code[ 2 ] = big_word( 0x5380 );  // SUBQ.L  #1,D0
+	code[ 3 ] = big_word( 0x66FA );  // BNE.S   *-4
+	code[ 4 ] = big_word( 0x4E71 );  // NOP
+	
+	const memory_region memory( mem, sizeof mem );
+	
+	emulator emu( mc68000, memory );
+	
+	emu.reset();
+	
+	emu.d(1) = 0;
+	
+	EXPECT( emu.run( 1 + 3 * 10 ) );
+	
+	EXPECT( emu.d(0) ==  0 );
+	EXPECT( emu.d(1) == 10 );
+	
+	EXPECT( emu.pc() == 1024 + 8 );
+	
+	EXPECT( emu.sr.nzvc == 0x4 );
+}
+
+static void sub_addx()
+{
+	using namespace v68k;
+	
+	uint8_t mem[ 4096 ];
+	
+	memset( mem, 0xFF, sizeof mem );  // spike memory with bad addresses
+	
+	uint32_t* vectors = (uint32_t*) mem;
+	
+	vectors[0] = big_longword( 4096 );  // isp
+	vectors[1] = big_longword( 1024 );  // pc
+	
+	uint16_t* code = (uint16_t*) (mem + 1024);
+	
+	code[ 0 ] = big_word( 0x9081 );  // SUB.L   D1,D0
+	code[ 1 ] = big_word( 0xD583 );  // ADDX.L  D3,D2
+	
+	const memory_region memory( mem, sizeof mem );
+	
+	emulator emu( mc68000, memory );
+	
+	emu.reset();
+	
+	emu.d(0) = 5;
+	emu.d(1) = 5;
+	emu.d(2) = 0;
+	emu.d(3) = 0;
+	
+	EXPECT( emu.run( 2 ) );
+	
+	// ADDX leaves Z as set by SUB when its result is zero
+	
+	EXPECT( emu.sr.nzvc == 0x4 );
+}
+
+static void trace()
+{
+	using namespace v68k;
+	
+	uint8_t mem[ 4096 ];
+	
+	memset( mem, 0xFF, sizeof mem );  // spike memory with bad addresses
+	
+	uint32_t* vectors = (uint32_t*) mem;
+	
+	vectors[0] = big_longword( 4096 );  // isp
+	vectors[1] = big_longword( 1024 );  // pc
+	
+	uint16_t* code = (uint16_t*) (mem + 1024);
+	
+	code[ 0 ] = big_word( 0x7007 );  // MOVEQ   #7,D0
+	code[ 1 ] = big_word( 0x2F00 );  // MOVE.L  D0,-(A7)
+	code[ 2 ] = big_word( 0x4E71 );  // NOP
+	
+	const memory_region memory( mem, sizeof mem );
+	
+	emulator emu( mc68000, memory );
+	
+	emu.reset();
+	
+	EXPECT( emu.run( 3 ) );
+	
+	const trace_buffer& trace = emu.trace();
+	
+	EXPECT( trace.size() == 3 );
+	
+	EXPECT( trace[ 0 ].pc == 1024  &&  trace[ 0 ].opcode == 0x7007 );
+	
+	EXPECT( trace[ 0 ].target == 0  &&  trace[ 0 ].value == 7 );
+	
+	EXPECT( trace[ 1 ].target == trace_memory  &&  trace[ 1 ].value == 4092 );
+	
+	EXPECT( trace[ 2 ].target == trace_none );
+	
+	emu.reset();
+	
+	EXPECT( trace.size() == 0 );
+}
+
+static void interrupts()
+{
+	using namespace v68k;
+	
+	uint8_t mem[ 4096 ];
+	
+	memset( mem, 0xFF, sizeof mem );  // spike memory with bad addresses
+	
+	uint32_t* vectors = (uint32_t*) mem;
+	
+	vectors[ 0] = big_longword( 4096 );  // isp
+	vectors[ 1] = big_longword( 1024 );  // pc
+	vectors[25] = big_longword( 2048 );  // level 1 autovector
+	
+	uint16_t* code = (uint16_t*) (mem + 1024);
+	
+	code[ 0 ] = big_word( 0x4E71 );  // NOP
+	code[ 1 ] = big_word( 0x46FC );  // MOVE    #$2000,SR
+	code[ 2 ] = big_word( 0x2000 );
+	code[ 3 ] = big_word( 0x4E71 );  // NOP
+	code[ 4 ] = big_word( 0x4E72 );  // STOP    #$2000
+	code[ 5 ] = big_word( 0x2000 );
+	code[ 6 ] = big_word( 0x4E71 );  // NOP
+	
+	uint16_t* handler = (uint16_t*) (mem + 2048);
+	
+	handler[ 0 ] = big_word( 0x5281 );  // ADDQ.L  #1,D1
+	handler[ 1 ] = big_word( 0x4E73 );  // RTE
+	
+	const memory_region memory( mem, sizeof mem );
+	
+	emulator emu( mc68000, memory );
+	
+	emu.reset();
+	
+	emu.d(1) = 0;
+	
+	emu.post_autovector_interrupt( 1 );
+	
+	// Masked by the reset SR's interrupt mask of 7
+	
+	EXPECT( !emu.interrupt_pending() );
+	
+	EXPECT( emu.run( 2 )  &&  emu.d(1) == 0 );
+	
+	// Taken after MOVE to SR lowers the mask
+	
+	EXPECT( emu.interrupt_pending() );
+	
+	EXPECT( emu.run( 1 )  &&  emu.d(1) == 1 );
+	
+	EXPECT( emu.sr.iii == 1  &&  emu.pc() == 2048 + 2 );
+	
+	EXPECT( emu.run( 1 )  &&  emu.pc() == 1024 + 6 );
+	
+	EXPECT( emu.sr.iii == 0  &&  !emu.interrupt_pending() );
+	
+	// STOP waits for the next one
+	
+	EXPECT( !emu.run( 3 )  &&  emu.condition == stopped );
+	
+	EXPECT( emu.pc() == 1024 + 12 );
+	
+	emu.post_autovector_interrupt( 1 );
+	
+	EXPECT( emu.run( 2 )  &&  emu.d(1) == 2 );
+	
+	EXPECT( emu.pc() == 1024 + 12  &&  emu.sr.iii == 0 );
+}
+
+int main( int argc, char** argv )
+{
+	tap::start( "v68k-run", n_tests );
+	
+	add_move();
+	
+	loop();
+	
+	sub_addx();
+	
+	trace();
+	
+	interrupts();
+	
+	return 0;
+}
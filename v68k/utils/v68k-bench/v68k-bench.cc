@@ -0,0 +1,394 @@
+/*
+	v68k-bench.cc
+	-------------
+*/
+
+// Standard C
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// v68k
+#include "v68k/decode.hh"
+#include "v68k/emulator.hh"
+#include "v68k/endian.hh"
+#include "v68k/instruction.hh"
+
+
+#pragma exceptions off
+
+
+/*
+	Measures decode() throughput over all 65536 opcodes, and step()
+	throughput on canned workloads:
+	
+		memcpy:  MOVE.L (A0)+,(A1)+ / DBRA, copying 4K at a time
+		divs:    a loop of DIVS.W
+		traps:   a loop of A-line traps, each taking the exception
+	
+	plus any .p68k programs (e.g. v68k/demos/*.p68k) named on the command
+	line.  Programs run in supervisor mode with a TRAP #0 handler that
+	returns 0 from every system call, and are restarted until they've run
+	the instruction budget.
+	
+	Usage:  v68k-bench [program.p68k ...]
+	
+	The report is CSV, one record per line.  Lines starting with '#' are
+	comments.
+	
+		decode,<opcodes>,<valid>,<usecs>,<per second>
+		step,<workload>,<instructions>,<usecs>,<per second>,<allocations>,<per step>
+	
+	Allocations are counted through operator new.
+*/
+
+
+static unsigned long the_allocation_count;
+
+void* operator new( size_t size )
+{
+	++the_allocation_count;
+	
+	return malloc( size ? size : 1 );
+}
+
+void* operator new[]( size_t size )
+{
+	++the_allocation_count;
+	
+	return malloc( size ? size : 1 );
+}
+
+void operator delete( void* p )
+{
+	free( p );
+}
+
+void operator delete[]( void* p )
+{
+	free( p );
+}
+
+
+using v68k::big_word;
+using v68k::big_longword;
+
+
+const unsigned long instruction_budget = 20 * 1000 * 1000;
+
+const int n_decode_rounds = 64;
+
+const uint32_t mem_size = 64 * 1024;
+
+const uint32_t fault_address   = 0x0400;
+const uint32_t syscall_address = 0x0404;
+const uint32_t line_A_address  = 0x040C;
+const uint32_t exit_address    = 0x0414;
+const uint32_t args_address    = 0x0800;
+const uint32_t code_address    = 0x1000;
+const uint32_t code_max_size   = 0x3000;
+
+const uint32_t initial_sp = mem_size - 12;
+
+static uint8_t mem[ mem_size ];
+
+
+static double microseconds( clock_t t )
+{
+	return t * 1000000.0 / CLOCKS_PER_SEC;
+}
+
+static void put_words( uint32_t addr, const uint16_t* words, int n )
+{
+	uint16_t* p = (uint16_t*) &mem[ addr ];
+	
+	while ( n-- > 0 )
+	{
+		*p++ = big_word( *words++ );
+	}
+}
+
+static void put_long( uint32_t addr, uint32_t x )
+{
+	*(uint32_t*) &mem[ addr ] = big_longword( x );
+}
+
+static void load_system()
+{
+	memset( mem, '\0', sizeof mem );
+	
+	uint32_t* vectors = (uint32_t*) mem;
+	
+	for ( int i = 2;  i < 256;  ++i )
+	{
+		vectors[ i ] = big_longword( fault_address );
+	}
+	
+	vectors[  0 ] = big_longword( initial_sp   );  // isp
+	vectors[  1 ] = big_longword( code_address );  // pc
+	vectors[ 10 ] = big_longword( line_A_address  );
+	vectors[ 32 ] = big_longword( syscall_address );
+	
+	static const uint16_t fault[] = { 0x4E72, 0x2700 };  // STOP #0x2700
+	static const uint16_t exit [] = { 0x4E72, 0xFFFF };  // STOP #0xFFFF
+	
+	/*
+		As in xv68k, TRAP #0 returns from the system call stub that
+		executed it.
+	*/
+	
+	static const uint16_t syscall[] =
+	{
+		0x7000,          // MOVEQ    #0,D0
+		0x504F,          // ADDQ.W   #8,A7      ; pop the exception frame
+		0x4E75           // RTS
+	};
+	
+	static const uint16_t line_A[] =
+	{
+		0x54AF, 0x0002,  // ADDQ.L   #2,(2,A7)  ; skip the trap word
+		0x4E73           // RTE
+	};
+	
+	put_words( fault_address,   fault,   2 );
+	put_words( syscall_address, syscall, 3 );
+	put_words( line_A_address,  line_A,  3 );
+	put_words( exit_address,    exit,    2 );
+	
+	// main( 1, { "v68k-bench", NULL } ) returns to exit
+	
+	put_long( initial_sp + 0, exit_address     );
+	put_long( initial_sp + 4, 1                );
+	put_long( initial_sp + 8, args_address     );
+	
+	put_long( args_address + 0, args_address + 8 );
+	put_long( args_address + 4, 0                );
+	
+	strcpy( (char*) &mem[ args_address + 8 ], "v68k-bench" );
+}
+
+
+static const uint16_t memcpy_loop[] =
+{
+	0x41F9, 0x0000, 0x4000,  // LEA      0x4000,A0
+	0x43F9, 0x0000, 0x6000,  // LEA      0x6000,A1
+	0x323C, 0x03FF,          // MOVE.W   #1023,D1
+	0x22D8,                  // MOVE.L   (A0)+,(A1)+
+	0x51C9, 0xFFFC,          // DBRA     D1,*-2
+	0x60E8                   // BRA.S    *-22
+};
+
+static const uint16_t divs_loop[] =
+{
+	0x7207,                  // MOVEQ    #7,D1
+	0x203C, 0x0001, 0x86A0,  // MOVE.L   #100000,D0
+	0x81C1,                  // DIVS.W   D1,D0
+	0x48C0,                  // EXT.L    D0
+	0x81C1,                  // DIVS.W   D1,D0
+	0x60F2                   // BRA.S    *-12
+};
+
+static const uint16_t trap_loop[] =
+{
+	0xA000,                  // unimplemented A-line trap
+	0x60FC                   // BRA.S    *-2
+};
+
+
+static void report_step( const char*    name,
+                         unsigned long  n_instructions,
+                         clock_t        elapsed,
+                         unsigned long  n_allocations )
+{
+	const double usecs = microseconds( elapsed );
+	
+	printf( "step,%s,%lu,%.0f,%.0f,%lu,%g\n",
+	        name,
+	        n_instructions,
+	        usecs,
+	        usecs > 0 ? n_instructions / usecs * 1000000 : 0.0,
+	        n_allocations,
+	        n_instructions ? double( n_allocations ) / n_instructions : 0.0 );
+}
+
+static bool bench_program( const char* name, const uint16_t* code, int n_words )
+{
+	load_system();
+	
+	put_words( code_address, code, n_words );
+	
+	const v68k::memory_region memory( mem, mem_size );
+	
+	v68k::emulator emu( v68k::mc68000, memory );
+	
+	unsigned long n_instructions = 0;
+	
+	const unsigned long allocations = the_allocation_count;
+	
+	const clock_t start = clock();
+	
+	emu.reset();
+	
+	while ( n_instructions < instruction_budget )
+	{
+		const unsigned long before = emu.instruction_count();
+		
+		emu.run( instruction_budget - n_instructions );
+		
+		const unsigned long n = emu.instruction_count() - before;
+		
+		n_instructions += n;
+		
+		if ( emu.condition == v68k::stopped  ||  emu.condition == v68k::halted )
+		{
+			fprintf( stderr, "v68k-bench: %s: fault at 0x%.8x\n", name, emu.pc() );
+			
+			return false;
+		}
+		
+		if ( n == 0 )
+		{
+			break;
+		}
+		
+		/*
+			Start over without reset(), which would flush the decode cache
+			and make short programs a benchmark of reset() instead.
+		*/
+		
+		emu.condition = v68k::normal;
+		
+		emu.a(7) = initial_sp;
+		emu.pc() = code_address;
+		
+		emu.prefetch_instruction_word();
+	}
+	
+	const clock_t end = clock();
+	
+	report_step( name, n_instructions, end - start, the_allocation_count - allocations );
+	
+	return true;
+}
+
+static void bench_decode()
+{
+	int n_valid = 0;
+	
+	const clock_t start = clock();
+	
+	for ( int round = 0;  round < n_decode_rounds;  ++round )
+	{
+		for ( int i = 0;  i < 65536;  ++i )
+		{
+			v68k::instruction storage = { 0 };
+			
+			n_valid += v68k::decode( i, storage ) != 0;  // NULL
+		}
+	}
+	
+	const clock_t end = clock();
+	
+	const double usecs = microseconds( end - start );
+	
+	const unsigned long n = 65536UL * n_decode_rounds;
+	
+	printf( "decode,%lu,%d,%.0f,%.0f\n",
+	        n,
+	        n_valid / n_decode_rounds,
+	        usecs,
+	        usecs > 0 ? n / usecs * 1000000 : 0.0 );
+}
+
+static int hex_digit( int c )
+{
+	return c <= '9' ? c - '0' : (c | ' ') - 'a' + 10;
+}
+
+static int load_p68k( const char* path, uint16_t* code, int max_words )
+{
+	/*
+		The .p68k format is what utils/pack.pl reads:  hexadecimal, with
+		'#' comments and any whitespace ignored.
+	*/
+	
+	FILE* f = fopen( path, "r" );
+	
+	if ( f == NULL )
+	{
+		return -1;
+	}
+	
+	int n_nibbles = 0;
+	
+	int c;
+	
+	while ( (c = getc( f )) != EOF )
+	{
+		if ( c == '#' )
+		{
+			while ( (c = getc( f )) != EOF  &&  c != '\n' )
+			{
+				continue;
+			}
+		}
+		else if ( isxdigit( c ) )
+		{
+			if ( n_nibbles == max_words * 4 )
+			{
+				break;
+			}
+			
+			uint16_t& word = code[ n_nibbles / 4 ];
+			
+			word = word << 4 | hex_digit( c );
+			
+			++n_nibbles;
+		}
+	}
+	
+	fclose( f );
+	
+	return n_nibbles % 4 == 0 ? n_nibbles / 4 : -1;
+}
+
+int main( int argc, char** argv )
+{
+	printf( "# v68k-bench\n" );
+	
+	bench_decode();
+	
+	const int n = sizeof (uint16_t);
+	
+	bool ok = bench_program( "memcpy", memcpy_loop, sizeof memcpy_loop / n )
+	        & bench_program( "divs",   divs_loop,   sizeof divs_loop   / n )
+	        & bench_program( "traps",  trap_loop,   sizeof trap_loop   / n );
+	
+	static uint16_t code[ code_max_size / 2 ];
+	
+	for ( int i = 1;  i < argc;  ++i )
+	{
+		const char* path = argv[ i ];
+		
+		memset( code, '\0', sizeof code );
+		
+		const int n_words = load_p68k( path, code, code_max_size / 2 );
+		
+		if ( n_words < 0 )
+		{
+			fprintf( stderr, "v68k-bench: %s: can't load\n", path );
+			
+			ok = false;
+			
+			continue;
+		}
+		
+		const char* name = strrchr( path, '/' );
+		
+		ok &= bench_program( name ? name + 1 : path, code, n_words );
+	}
+	
+	return ! ok;
+}
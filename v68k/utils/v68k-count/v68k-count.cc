@@ -20,6 +20,12 @@ static void count()
 	int n_privileged = 0;
 	int not_68000    = 0;
 	
+	// Opcodes first valid on each model, indexed by not_before_680x0 >> 4
+	
+	const int n_models = 5;
+	
+	int n_new_on_model[ n_models ] = { 0 };
+	
 	for ( int i = 0;  i < 65536;  ++i )
 	{
 		v68k::instruction storage = { 0 };
@@ -39,10 +45,21 @@ static void count()
 			{
 				++not_68000;
 			}
+			
+			++n_new_on_model[ (decoded->flags & v68k::not_before_mask) >> 4 ];
 		}
 	}
 	
 	printf( "%d valid opcodes, %d privileged, %d not on 68000\n", n_valid, n_privileged, not_68000 );
+	
+	int n_on_model = 0;
+	
+	for ( int i = 0;  i < n_models;  ++i )
+	{
+		n_on_model += n_new_on_model[ i ];
+		
+		printf( "680%d0: %5d valid opcodes (%d new)\n", i, n_on_model, n_new_on_model[ i ] );
+	}
 }
 
 int main( int argc, char** argv )